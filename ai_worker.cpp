@@ -0,0 +1,149 @@
+#include "ai_worker.h"
+#include "engine.h"
+#include "task_lock.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/task.h>
+#endif
+
+AiWorker::AiWorker()
+    : requestSide(Color::WHITE), hasRequest(false), requestId(0), resultId(0), hasResult(false),
+      searching(false), searchMillis(0), job(nullptr), jobArg(nullptr), lock(nullptr), searchTask(nullptr) {}
+
+bool AiWorker::begin(uint32_t seed) {
+  context.seedRandom(seed);
+#if defined(ARDUINO_ARCH_ESP32)
+  if (searchTask != nullptr) {
+    return true;
+  }
+  lock = createLock();
+  TaskHandle_t handle = nullptr;
+  // 优先级0与 core 0 的空闲任务轮流运行，长时间搜索不会触发空闲任务看门狗；
+  // SD写入任务优先级更高，照常写出
+  if (lock == nullptr || xTaskCreatePinnedToCore(searchLoop, "aiSearch", 16384, this, 0, &handle, 0) != pdPASS) {
+    serialPrintln("[AI] Failed to start search task, moves are searched synchronously");
+    return false;
+  }
+  searchTask = handle;
+#endif
+  return true;
+}
+
+void AiWorker::searchLoop(void* arg) {
+#if defined(ARDUINO_ARCH_ESP32)
+  AiWorker* worker = (AiWorker*)arg;
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    worker->drain();
+  }
+#else
+  (void)arg;
+#endif
+}
+
+void AiWorker::drain() {
+  while (true) {
+    takeLock(lock);
+    if (job != nullptr) {
+      void (*fn)(void*) = job;
+      void* arg = jobArg;
+      searching = true;
+      giveLock(lock);
+      fn(arg);
+      takeLock(lock);
+      job = nullptr;
+      giveLock(lock);
+      continue;
+    }
+    if (!hasRequest) {
+      searching = false;
+      giveLock(lock);
+      return;
+    }
+    ChessBoard board = request;
+    Color side = requestSide;
+    uint32_t id = requestId;
+    hasRequest = false;
+    searching = true;
+    giveLock(lock);
+
+    unsigned long start = millis();
+    Move move = chooseAIMove(side, board, context);
+    unsigned long elapsed = millis() - start;
+
+    takeLock(lock);
+    searchMillis = (uint32_t)elapsed;
+    if (id == requestId) {
+      result = move;
+      resultId = id;
+      hasResult = true;
+    }
+    giveLock(lock);
+    serialPrintf("[AI] Searched in %lu ms%s\n", elapsed, id == requestId ? "" : " (discarded)");
+  }
+}
+
+void AiWorker::start(const ChessBoard& board, Color side) {
+  takeLock(lock);
+  request = board;
+  requestSide = side;
+  hasRequest = true;
+  requestId++;
+  hasResult = false;
+  giveLock(lock);
+#if defined(ARDUINO_ARCH_ESP32)
+  if (searchTask != nullptr) {
+    xTaskNotifyGive((TaskHandle_t)searchTask);
+    return;
+  }
+#endif
+  drain();
+}
+
+void AiWorker::cancel() {
+  takeLock(lock);
+  hasRequest = false;
+  requestId++;
+  hasResult = false;
+  giveLock(lock);
+}
+
+bool AiWorker::isBusy() {
+  takeLock(lock);
+  bool busy = hasRequest || searching || job != nullptr;
+  giveLock(lock);
+  return busy;
+}
+
+bool AiWorker::poll(Move& move) {
+  takeLock(lock);
+  bool ready = hasResult && resultId == requestId;
+  if (ready) {
+    move = result;
+    hasResult = false;
+  }
+  giveLock(lock);
+  return ready;
+}
+
+void AiWorker::wait() {
+  while (isBusy()) {
+    delay(10);
+  }
+}
+
+void AiWorker::run(void (*fn)(void*), void* arg) {
+#if defined(ARDUINO_ARCH_ESP32)
+  if (searchTask != nullptr) {
+    wait();
+    takeLock(lock);
+    job = fn;
+    jobArg = arg;
+    giveLock(lock);
+    xTaskNotifyGive((TaskHandle_t)searchTask);
+    wait();
+    return;
+  }
+#endif
+  fn(arg);
+}
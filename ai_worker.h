@@ -0,0 +1,57 @@
+#pragma once
+#include "common.h"
+#include "engine.h"
+
+// 后台AI：start() 把局面复制给搜索任务就返回，界面继续处理按键、播放走子动画，
+// 搜索完成后由 loop() 通过 poll() 取回走法
+//   同一时间只搜索一个局面；搜索中再 start() 时，新局面排队，旧结果作废
+//   cancel() 作废尚未取回的结果（悔棋、重置、进入回放时），正在进行的搜索跑完后丢弃
+// 设备端（ESP32）由 FreeRTOS 任务在 core 0 搜索；主机端没有后台任务，start() 内同步搜索
+class AiWorker {
+private:
+  ChessBoard request;   // 排队等待搜索的局面
+  Color requestSide;
+  bool hasRequest;
+  uint32_t requestId;   // 每次 start()/cancel() 加一，结果的编号不同时作废
+  Move result;
+  uint32_t resultId;
+  bool hasResult;
+  bool searching;
+  uint32_t searchMillis;  // 最近一次搜索的耗时
+  SearchContext context;  // 只在搜索任务里使用（节点计数、随机数），不需要加锁
+  void (*job)(void*);     // run() 交给搜索任务执行的函数
+  void* jobArg;
+  void* lock;             // 保护以上状态（设备端为 FreeRTOS 互斥量）
+  void* searchTask;
+
+  // 取出排队的局面搜索，直到没有新的请求
+  void drain();
+  static void searchLoop(void* arg);
+
+public:
+  AiWorker();
+
+  // 设置随机选择的种子，设备端再创建后台搜索任务，只需调用一次；失败时退回同步搜索
+  bool begin(uint32_t seed);
+
+  // 开始为 side 方在 board 局面上找一步棋
+  void start(const ChessBoard& board, Color side);
+
+  // 作废尚未取回的结果
+  void cancel();
+
+  // 有排队或正在进行的搜索
+  bool isBusy();
+
+  // 最近一次 start() 的结果已就绪时取出并返回true
+  bool poll(Move& move);
+
+  // 等待正在进行的搜索结束（串口 bench/uci 计时时不与AI搜索抢CPU）
+  void wait();
+
+  // 在搜索任务上执行 job(arg) 并等它结束：串口 bench/uci 的深层搜索每层都要复制棋盘，
+  // loop 任务 8KB 的栈放不下，交给搜索任务的 16KB 栈；没有后台任务时直接调用
+  void run(void (*job)(void*), void* arg);
+
+  uint32_t getSearchMillis() const { return searchMillis; }
+};
@@ -0,0 +1,61 @@
+#include "animation.h"
+
+FrameScheduler::FrameScheduler(int fps)
+    : interval(1000 / fps), nextFrame(0), running(false), frames(0), dropped(0) {}
+
+void FrameScheduler::start(uint32_t now) {
+  nextFrame = now;
+  running = true;
+}
+
+bool FrameScheduler::due(uint32_t now) {
+  // 用差值比较，millis() 回绕时也成立
+  if (!running || (int32_t)(now - nextFrame) < 0) {
+    return false;
+  }
+  uint32_t late = now - nextFrame;
+  dropped += late / interval;
+  nextFrame += (late / interval + 1) * interval;
+  frames++;
+  return true;
+}
+
+void MoveAnimation::begin(const Piece& movingPiece, int startX, int startY, int endX, int endY, uint32_t now,
+                          uint32_t durationMs) {
+  piece = movingPiece;
+  fromX = startX;
+  fromY = startY;
+  toX = endX;
+  toY = endY;
+  lastX = startX;
+  lastY = startY;
+  startTime = now;
+  duration = durationMs > 0 ? durationMs : 1;
+  active = true;
+}
+
+bool MoveAnimation::step(uint32_t now, int size, int& x, int& y, DirtyRect& rect) {
+  uint32_t elapsed = now - startTime;
+  bool finished = elapsed >= duration;
+  if (finished) {
+    x = toX;
+    y = toY;
+  } else {
+    // 先快后慢（二次缓出）：t' = 1 - (1 - t)^2，用千分比整数计算
+    int32_t t = (int32_t)(elapsed * 1000 / duration);
+    int32_t eased = 1000 - (1000 - t) * (1000 - t) / 1000;
+    x = fromX + (toX - fromX) * eased / 1000;
+    y = fromY + (toY - fromY) * eased / 1000;
+  }
+  int left = x < lastX ? x : lastX;
+  int top = y < lastY ? y : lastY;
+  int right = (x > lastX ? x : lastX) + size;
+  int bottom = (y > lastY ? y : lastY) + size;
+  rect.x = left;
+  rect.y = top;
+  rect.w = right - left;
+  rect.h = bottom - top;
+  lastX = x;
+  lastY = y;
+  return finished;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "common.h"
+#include "dirty_rect.h"
+
+// 走子动画：棋子从起点格滑到终点格，由 loop() 按固定帧率推进，不阻塞按键处理和后台AI
+//   FrameScheduler 决定这一轮 loop() 是否该画新的一帧；画得慢时跳过错过的帧，不追帧
+//   MoveAnimation 给出每一帧棋子的屏幕位置，以及这一帧要重画的矩形（上一帧与这一帧位置的并集）
+const int ANIMATION_FPS = 50;
+const uint32_t MOVE_ANIMATION_MS = 180;
+
+class FrameScheduler {
+private:
+  uint32_t interval;   // 帧间隔（毫秒）
+  uint32_t nextFrame;  // 下一帧的时刻
+  bool running;
+  uint32_t frames;
+  uint32_t dropped;    // 来不及画而跳过的帧
+
+public:
+  explicit FrameScheduler(int fps);
+
+  // 开始计时，第一帧立即到期
+  void start(uint32_t now);
+  void stop() { running = false; }
+  bool isRunning() const { return running; }
+
+  // 已到下一帧的时刻时返回true并预约下一帧
+  bool due(uint32_t now);
+
+  uint32_t getFrames() const { return frames; }
+  uint32_t getDropped() const { return dropped; }
+};
+
+class MoveAnimation {
+private:
+  Piece piece;
+  int16_t fromX, fromY;  // 起点格的屏幕坐标（格子左上角）
+  int16_t toX, toY;
+  int16_t lastX, lastY;  // 上一帧画的位置
+  uint32_t startTime;
+  uint32_t duration;
+  bool active;
+
+public:
+  MoveAnimation() : fromX(0), fromY(0), toX(0), toY(0), lastX(0), lastY(0),
+                    startTime(0), duration(0), active(false) {}
+
+  // 开始把 piece 从 (fromX, fromY) 滑到 (toX, toY)，都是格子左上角的屏幕坐标
+  void begin(const Piece& movingPiece, int startX, int startY, int endX, int endY, uint32_t now,
+             uint32_t durationMs = MOVE_ANIMATION_MS);
+  void stop() { active = false; }
+  bool isActive() const { return active; }
+
+  // 推进到 now：给出这一帧棋子的位置和要重画的矩形（size 为格子边长），
+  // 返回这一帧是否已停在终点（画完它动画就可以结束）
+  bool step(uint32_t now, int size, int& x, int& y, DirtyRect& rect);
+
+  const Piece& getPiece() const { return piece; }
+};
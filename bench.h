@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+// 标准基准测试：固定局面 + 固定深度 + 固定随机种子
+// 总节点数是引擎行为的签名：纯速度优化不应改变它，改变了说明搜索结果也变了
+const int BENCH_DEFAULT_DEPTH = 3;
+// 每层搜索在栈上复制一份棋盘，设备上搜索任务的栈按这个深度估算（与 UCI 最大深度一致）
+const int BENCH_MAX_DEPTH = 6;
+const uint32_t BENCH_SEED = 20240101u;
+
+struct BenchResult {
+  int positions;
+  unsigned long nodes;   // 签名
+  unsigned long timeMs;
+
+  BenchResult() : positions(0), nodes(0), timeMs(0) {}
+};
+
+// 运行基准测试；verbose 时每个局面输出一行，最后总是输出汇总（带 [BENCH] 前缀）
+void runBench(int depth, bool verbose, BenchResult* result);
@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+
+// 可随机访问的块文件接口：谜题包等二进制数据通过它读写，
+// 设备端由 SdBlockFile（sd_block_file.h）实现，主机端由 StdioBlockFile（host/stdio_block_file.h）实现
+class BlockFile {
+public:
+  virtual ~BlockFile() {}
+
+  // 定位到文件开头起第 offset 字节
+  virtual bool seek(uint32_t offset) = 0;
+
+  // 从当前位置读取至多 size 字节，返回实际读取的字节数
+  virtual size_t read(uint8_t* buffer, size_t size) = 0;
+
+  // 在当前位置写入，返回实际写入的字节数（只读打开时返回0）
+  virtual size_t write(const uint8_t* data, size_t size) = 0;
+
+  // 把缓冲的写入落盘
+  virtual void flush() = 0;
+
+  // 文件总长度
+  virtual uint32_t size() = 0;
+
+  // 定位后读取正好 size 字节
+  bool readAt(uint32_t offset, uint8_t* buffer, size_t size) {
+    return seek(offset) && read(buffer, size) == size;
+  }
+
+  // 定位后写入正好 size 字节，用于原地更新
+  bool writeAt(uint32_t offset, const uint8_t* data, size_t size) {
+    return seek(offset) && write(data, size) == size;
+  }
+};
+
+// 二进制文件中的小端整数
+inline uint16_t readLE16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLE32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void writeLE16(uint8_t* p, uint16_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+}
+
+inline void writeLE32(uint8_t* p, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    p[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+// CRC-8（多项式 0x07），seed 为上一段数据的CRC，可把多条记录串成链
+inline uint8_t crc8(const uint8_t* data, size_t size, uint8_t seed = 0) {
+  uint8_t crc = seed;
+  for (size_t i = 0; i < size; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
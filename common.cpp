@@ -1,23 +1,48 @@
 #include "common.h"
+#include "profiler.h"
+#include <string.h>
+#include <atomic>
 
 // 全局开关：控制是否启用串口输出
 #define ENABLE_SERIAL_OUTPUT true
 
+// 运行时开关（UCI模式、log 命令切换）；界面线程写、AI任务读
+static std::atomic<bool> serialLogEnabled(ENABLE_SERIAL_OUTPUT);
+
+// 临时静音的嵌套层数，按任务各计一份（SAN生成、重放、搜索时使用，不改动全局开关）
+static thread_local int serialLogMuteDepth = 0;
+
+void setSerialLogEnabled(bool enabled) {
+  serialLogEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isSerialLogEnabled() {
+  return serialLogMuteDepth == 0 && serialLogEnabled.load(std::memory_order_relaxed);
+}
+
+SerialLogMute::SerialLogMute() {
+  serialLogMuteDepth++;
+}
+
+SerialLogMute::~SerialLogMute() {
+  serialLogMuteDepth--;
+}
+
 // Serial输出包装函数，避免Serial Monitor未连接时阻塞
 void serialPrintln(const String& str) {
-  if (ENABLE_SERIAL_OUTPUT) {
+  if (isSerialLogEnabled()) {
     Serial.println(str);
   }
 }
 
 void serialPrintln(const char* str) {
-  if (ENABLE_SERIAL_OUTPUT) {
+  if (isSerialLogEnabled()) {
     Serial.println(str);
   }
 }
 
 void serialPrintf(const char* format, ...) {
-  if (ENABLE_SERIAL_OUTPUT) {
+  if (isSerialLogEnabled()) {
     char buffer[256];
     va_list args;
     va_start(args, format);
@@ -28,13 +53,13 @@ void serialPrintf(const char* format, ...) {
 }
 
 void serialPrint(const String& str) {
-  if (ENABLE_SERIAL_OUTPUT) {
+  if (isSerialLogEnabled()) {
     Serial.print(str);
   }
 }
 
 void serialPrint(const char* str) {
-  if (ENABLE_SERIAL_OUTPUT) {
+  if (isSerialLogEnabled()) {
     Serial.print(str);
   }
 }
@@ -101,6 +126,23 @@ void ChessBoard::initBoard() {
   lastMoveFrom = Position(-1, -1);
   lastMoveTo = Position(-1, -1);
   
+  // 初始化回合计数
+  halfmoveClock = 0;
+  fullmoveNumber = 1;
+  
+  // 初始化撤销状态（棋盘会被整体复制，未初始化的字段复制时也会被读取）
+  lastCapturedPiece = Piece();
+  wasWhiteKingInCheck = false;
+  wasBlackKingInCheck = false;
+  wasWhiteKingMoved = false;
+  wasBlackKingMoved = false;
+  wasWhiteRookMoved[0] = wasWhiteRookMoved[1] = false;
+  wasBlackRookMoved[0] = wasBlackRookMoved[1] = false;
+  wasEnPassantTarget = Position(-1, -1);
+  wasCurrentPlayer = WHITE;
+  wasHalfmoveClock = 0;
+  wasFullmoveNumber = 1;
+  
   // 初始化游戏状态
   currentState = NormalPlay;
   
@@ -108,6 +150,9 @@ void ChessBoard::initBoard() {
   promotionPawnPos = Position(-1, -1);
   promotionColor = WHITE;
   selectedPromotionPiece = QUEEN;
+  
+  memset(legalTargets, 0, sizeof(legalTargets));
+  legalTargetsValid = false;
 }
 
 void ChessBoard::resetBoard() {
@@ -133,6 +178,7 @@ const Piece& ChessBoard::getPiece(const Position& pos) const {
 void ChessBoard::setPiece(int x, int y, const Piece& piece) {
   if (isOnBoard(x, y)) {
     board[x][y] = piece;
+    invalidateLegalTargets();
   }
 }
 
@@ -181,6 +227,8 @@ bool ChessBoard::isPathClear(const Position& from, const Position& to) const {
 }
 
 bool ChessBoard::isMoveValid(const Position& from, const Position& to) const {
+  PROFILE_ZONE(PROF_IS_MOVE_VALID);
+  
   if (!from.isValid() || !to.isValid()) {
     return false;
   }
@@ -201,41 +249,21 @@ bool ChessBoard::isMoveValid(const Position& from, const Position& to) const {
     int dx = abs(to.x - from.x);
     int dy = abs(to.y - from.y);
     
-    // 王车易位（横向移动2格）
+    // 王车易位（从e列横向移动2格到空格）
     if (dx == 2 && dy == 0) {
-      if (fromPiece.color == WHITE) {
-        // 白王易位
-        if (from.y != 0 || to.y != 0) return false;
-        
-        // 短易位（e1→g1）
-        if (to.x == 6) {
-          return !whiteKingMoved && !whiteRookMoved[1] && 
-                 isPathClear(from, to) && !isKingInCheck(WHITE) &&
-                 !simulateMoveAndCheckCheck(from, Position(5, 0), WHITE);
-        }
-        // 长易位（e1→c1）
-        else if (to.x == 2) {
-          return !whiteKingMoved && !whiteRookMoved[0] && 
-                 isPathClear(from, to) && !isKingInCheck(WHITE) &&
-                 !simulateMoveAndCheckCheck(from, Position(3, 0), WHITE);
-        }
-      } else {
-        // 黑王易位
-        if (from.y != 7 || to.y != 7) return false;
-        
-        // 短易位（e8→g8）
-        if (to.x == 6) {
-          return !blackKingMoved && !blackRookMoved[1] && 
-                 isPathClear(from, to) && !isKingInCheck(BLACK) &&
-                 !simulateMoveAndCheckCheck(from, Position(5, 7), BLACK);
-        }
-        // 长易位（e8→c8）
-        else if (to.x == 2) {
-          return !blackKingMoved && !blackRookMoved[0] && 
-                 isPathClear(from, to) && !isKingInCheck(BLACK) &&
-                 !simulateMoveAndCheckCheck(from, Position(3, 7), BLACK);
-        }
-      }
+      int row = (fromPiece.color == WHITE) ? 0 : 7;
+      if (from.x != 4 || from.y != row || !toPiece.isEmpty()) return false;
+      bool kingMoved = (fromPiece.color == WHITE) ? whiteKingMoved : blackKingMoved;
+      const bool* rookMoved = (fromPiece.color == WHITE) ? whiteRookMoved : blackRookMoved;
+      
+      // 短易位（e→g，车在h列）/ 长易位（e→c，车在a列，b列也必须为空）
+      int side = (to.x == 6) ? 1 : 0;
+      int rookX = side ? 7 : 0;
+      int passX = side ? 5 : 3;
+      return !kingMoved && !rookMoved[side] &&
+             board[rookX][row].is(ROOK, fromPiece.color) &&
+             isPathClear(from, Position(rookX, row)) && !isKingInCheck(fromPiece.color) &&
+             !simulateMoveAndCheckCheck(from, Position(passX, row), fromPiece.color);
     }
   }
   
@@ -251,10 +279,10 @@ bool ChessBoard::isMoveValid(const Position& from, const Position& to) const {
         return true;
       }
       
-      // 前进两格（初始位置）
+      // 前进两格（初始位置，中间格必须为空）
       if (dx == 0 && dy == 2 && toPiece.isEmpty() && 
           ((fromPiece.color == WHITE && from.y == 1) || (fromPiece.color == BLACK && from.y == 6)) &&
-          (to.y - from.y) == 2 * direction) {
+          (to.y - from.y) == 2 * direction && getPiece(from.x, from.y + direction).isEmpty()) {
         return true;
       }
       
@@ -292,56 +320,8 @@ bool ChessBoard::isMoveValid(const Position& from, const Position& to) const {
     }
     
     case KING: {
-      // 普通移动
-      if (dx <= 1 && dy <= 1) {
-        return true;
-      }
-      // 王车易位
-      if (dx == 2 && dy == 0) {
-        Color kingColor = getPiece(from).color;
-        if (kingColor == WHITE) {
-          // 白王易位
-          if (whiteKingMoved) return false;
-          if (to.x == 6) { // 短易位
-            if (whiteRookMoved[1]) return false;
-            // 检查路径是否被阻挡
-            if (!getPiece(6, 0).isEmpty() || !getPiece(5, 0).isEmpty()) return false;
-            // 检查王是否经过被攻击的格子
-            if (isKingInCheck(WHITE)) return false;
-            if (wouldPutKingInCheck(from, Position(5, 0))) return false;
-            return true;
-          } else if (to.x == 2) { // 长易位
-            if (whiteRookMoved[0]) return false;
-            // 检查路径是否被阻挡
-            if (!getPiece(1, 0).isEmpty() || !getPiece(2, 0).isEmpty() || !getPiece(3, 0).isEmpty()) return false;
-            // 检查王是否经过被攻击的格子
-            if (isKingInCheck(WHITE)) return false;
-            if (wouldPutKingInCheck(from, Position(3, 0))) return false;
-            return true;
-          }
-        } else {
-          // 黑王易位
-          if (blackKingMoved) return false;
-          if (to.x == 6) { // 短易位
-            if (blackRookMoved[1]) return false;
-            // 检查路径是否被阻挡
-            if (!getPiece(6, 7).isEmpty() || !getPiece(5, 7).isEmpty()) return false;
-            // 检查王是否经过被攻击的格子
-            if (isKingInCheck(BLACK)) return false;
-            if (wouldPutKingInCheck(from, Position(5, 7))) return false;
-            return true;
-          } else if (to.x == 2) { // 长易位
-            if (blackRookMoved[0]) return false;
-            // 检查路径是否被阻挡
-            if (!getPiece(1, 7).isEmpty() || !getPiece(2, 7).isEmpty() || !getPiece(3, 7).isEmpty()) return false;
-            // 检查王是否经过被攻击的格子
-            if (isKingInCheck(BLACK)) return false;
-            if (wouldPutKingInCheck(from, Position(3, 7))) return false;
-            return true;
-          }
-        }
-      }
-      return false;
+      // 普通移动（易位已在上面处理）
+      return dx <= 1 && dy <= 1;
     }
     
     default:
@@ -359,21 +339,42 @@ bool ChessBoard::simulateMoveAndCheckCheck(const Position& from, const Position&
   Piece originalFromPiece = getPiece(from);
   Piece originalToPiece = getPiece(to);
   
-  // 模拟移动
-  const_cast<ChessBoard*>(this)->setPiece(to, originalFromPiece);
-  const_cast<ChessBoard*>(this)->setPiece(from, Piece(NONE, WHITE));
+  // 吃过路兵时被吃的兵不在目标格上，也要一起拿掉
+  Position epCapturePos(-1, -1);
+  Piece epCapturedPiece;
+  if (originalFromPiece.type == PAWN && from.x != to.x && originalToPiece.isEmpty()) {
+    epCapturePos = Position(to.x, from.y);
+    epCapturedPiece = getPiece(epCapturePos);
+  }
+  
+  if (!isOnBoard(from.x, from.y) || !isOnBoard(to.x, to.y)) {
+    return isKingInCheck(kingColor);
+  }
+  
+  // 模拟移动：直接改格子、不经过 setPiece，模拟完原样恢复，合法走法缓存保持有效
+  Piece (&cells)[8][8] = const_cast<ChessBoard*>(this)->board;
+  cells[to.x][to.y] = originalFromPiece;
+  cells[from.x][from.y] = Piece(NONE, WHITE);
+  if (epCapturePos.isValid()) {
+    cells[epCapturePos.x][epCapturePos.y] = Piece(NONE, WHITE);
+  }
   
   // 检查是否被将军
   bool inCheck = isKingInCheck(kingColor);
   
   // 恢复原始状态
-  const_cast<ChessBoard*>(this)->setPiece(from, originalFromPiece);
-  const_cast<ChessBoard*>(this)->setPiece(to, originalToPiece);
+  cells[from.x][from.y] = originalFromPiece;
+  cells[to.x][to.y] = originalToPiece;
+  if (epCapturePos.isValid()) {
+    cells[epCapturePos.x][epCapturePos.y] = epCapturedPiece;
+  }
   
   return inCheck;
 }
 
 bool ChessBoard::isKingInCheck(Color color) const {
+  PROFILE_ZONE(PROF_IS_KING_IN_CHECK);
+  
   // 找到王的位置
   Position kingPos(-1, -1);
   for (int y = 0; y < 8; y++) {
@@ -445,25 +446,47 @@ bool ChessBoard::canCaptureKing(Color attackerColor) const {
   return false;
 }
 
-void ChessBoard::generateValidMoves(const Position& pos) {
-  validMoves.clear();
-  
-  if (!pos.isValid()) {
+void ChessBoard::buildLegalTargets() const {
+  if (legalTargetsValid) {
     return;
   }
-  
-  const Piece& piece = getPiece(pos);
-  if (piece.isEmpty() || piece.color != currentPlayer) {
-    return;
-  }
-  
-  // 遍历所有可能的位置
   for (int y = 0; y < 8; y++) {
     for (int x = 0; x < 8; x++) {
-      Position to(x, y);
-      if (isMoveValid(pos, to) && !wouldPutKingInCheck(pos, to)) {
-        validMoves.push_back(to);
+      Position from(x, y);
+      uint64_t targets = 0;
+      const Piece& piece = board[x][y];
+      if (!piece.isEmpty() && piece.color == currentPlayer) {
+        for (int ty = 0; ty < 8; ty++) {
+          for (int tx = 0; tx < 8; tx++) {
+            Position to(tx, ty);
+            if (isMoveValid(from, to) && !wouldPutKingInCheck(from, to)) {
+              targets |= 1ULL << (ty * 8 + tx);
+            }
+          }
+        }
       }
+      legalTargets[y * 8 + x] = targets;
+    }
+  }
+  legalTargetsValid = true;
+}
+
+uint64_t ChessBoard::getLegalTargets(const Position& from) const {
+  if (!from.isValid()) {
+    return 0;
+  }
+  buildLegalTargets();
+  return legalTargets[from.y * 8 + from.x];
+}
+
+void ChessBoard::generateValidMoves(const Position& pos) {
+  validMoves.clear();
+  
+  // 按 y、x 顺序给出目标格
+  uint64_t targets = getLegalTargets(pos);
+  for (int square = 0; targets != 0; square++, targets >>= 1) {
+    if (targets & 1) {
+      validMoves.push_back(Position(square % 8, square / 8));
     }
   }
 }
@@ -494,6 +517,8 @@ void ChessBoard::deselectPiece() {
 }
 
 bool ChessBoard::movePiece(const Position& from, const Position& to) {
+  PROFILE_ZONE(PROF_MOVE_PIECE);
+  
   if (!from.isValid() || !to.isValid()) {
     return false;
   }
@@ -505,14 +530,23 @@ bool ChessBoard::movePiece(const Position& from, const Position& to) {
     return false;
   }
   
-  if (!isMoveValid(from, to)) {
+  // 缓存已生成时直接查表，否则单独检查这一步
+  if (legalTargetsValid) {
+    if ((legalTargets[from.y * 8 + from.x] & (1ULL << (to.y * 8 + to.x))) == 0) {
+      return false;
+    }
+  } else if (!isMoveValid(from, to) || wouldPutKingInCheck(from, to)) {
     return false;
   }
   
-  if (wouldPutKingInCheck(from, to)) {
-    return false;
+  // 日志用的SAN需要在走子前生成（日志关闭时跳过）
+  char san[SAN_BUFFER_SIZE] = "";
+  if (isSerialLogEnabled()) {
+    formatSAN(Move(from, to), san, sizeof(san));
   }
   
+  invalidateLegalTargets();
+  
   // 保存上一手棋信息
   lastMoveFrom = from;
   lastMoveTo = to;
@@ -535,45 +569,61 @@ bool ChessBoard::movePiece(const Position& from, const Position& to) {
   wasBlackRookMoved[1] = blackRookMoved[1];
   wasEnPassantTarget = enPassantTarget;
   wasCurrentPlayer = currentPlayer;
+  wasHalfmoveClock = halfmoveClock;
+  wasFullmoveNumber = fullmoveNumber;
   
   // 执行移动
         setPiece(to, fromPiece);
         setPiece(from, Piece(NONE, fromPiece.color));
   
+  // 回合计数：兵走或吃子时半回合清零，黑方走完全回合加一
+  halfmoveClock = (fromPiece.type == PAWN || !targetPiece.isEmpty()) ? 0 : halfmoveClock + 1;
+  if (fromPiece.color == BLACK) {
+    fullmoveNumber++;
+  }
+  
+  // 车在原位被吃掉，对应一侧失去易位权
+  if (targetPiece.type == ROOK) {
+    if (to == Position(0, 0)) whiteRookMoved[0] = true;
+    if (to == Position(7, 0)) whiteRookMoved[1] = true;
+    if (to == Position(0, 7)) blackRookMoved[0] = true;
+    if (to == Position(7, 7)) blackRookMoved[1] = true;
+  }
+  
   // 初始化吃过路兵目标格
   enPassantTarget = Position(-1, -1);
   
   // 处理王车易位
   if (fromPiece.type == KING) {
     int dx = abs(to.x - from.x);
-    Serial.printf("King move detected: from (%d,%d) to (%d,%d), dx=%d\n", from.x, from.y, to.x, to.y, dx);
+    serialPrintf("King move detected: from (%d,%d) to (%d,%d), dx=%d\n", from.x, from.y, to.x, to.y, dx);
     if (dx == 2 && fromPiece.color == WHITE) {
       // 白王易位
       if (to.x == 6) { // 短易位：王从e1到g1，车从h1到f1
         setPiece(Position(5, 0), getPiece(Position(7, 0)));
         setPiece(Position(7, 0), Piece(NONE, fromPiece.color));
         whiteRookMoved[1] = true;
-        Serial.println("White castled short");
+        serialPrintln("White castled short");
       } else if (to.x == 2) { // 长易位：王从e1到c1，车从a1到d1
         setPiece(Position(3, 0), getPiece(Position(0, 0)));
         setPiece(Position(0, 0), Piece(NONE, fromPiece.color));
         whiteRookMoved[0] = true;
-        Serial.println("White castled long");
+        serialPrintln("White castled long");
       }
       whiteKingMoved = true;
     } else if (dx == 2 && fromPiece.color == BLACK) {
-      Serial.println("Black castling detected");
+      serialPrintln("Black castling detected");
       // 黑王易位
       if (to.x == 6) { // 短易位：王从e8到g8，车从h8到f8
               setPiece(Position(5, 7), getPiece(Position(7, 7)));
               setPiece(Position(7, 7), Piece(NONE, BLACK));
               blackRookMoved[1] = true;
-              Serial.println("Black castled short");
+              serialPrintln("Black castled short");
             } else if (to.x == 2) { // 长易位：王从e8到c8，车从a8到d8
               setPiece(Position(3, 7), getPiece(Position(0, 7)));
               setPiece(Position(0, 7), Piece(NONE, BLACK));
               blackRookMoved[0] = true;
-              Serial.println("Black castled long");
+              serialPrintln("Black castled long");
             }
       blackKingMoved = true;
     }
@@ -644,12 +694,27 @@ bool ChessBoard::movePiece(const Position& from, const Position& to) {
   // 取消选择
   deselectPiece();
   
-  // 输出FEN到终端
-  Serial.println("FEN: " + toFEN());
+  // 输出FEN和PGN记谱法到终端（日志关闭时不生成字符串）
+  if (isSerialLogEnabled()) {
+    char fen[FEN_BUFFER_SIZE];
+    writeFEN(fen, sizeof(fen));
+    serialPrintf("FEN: %s\n", fen);
+    serialPrintf("SAN: %s\n", san);
+  }
   
-  // 输出PGN记谱法
-  Serial.println("PGN: " + toPGN(from, to, fromPiece, targetPiece));
+  return true;
+}
+
+bool ChessBoard::makeMove(const Move& move) {
+  if (!movePiece(move.from, move.to)) {
+    return false;
+  }
   
+  // 升变：直接使用走法中指定的棋子（未指定时默认升后）
+  if (currentState == PromotionSelecting) {
+    selectedPromotionPiece = (move.promotion != NONE) ? move.promotion : QUEEN;
+    confirmPromotion();
+  }
   return true;
 }
 
@@ -667,11 +732,21 @@ const std::vector<Position>& ChessBoard::getValidMoves() const {
 
 bool ChessBoard::hasValidMoves() const {
   // 检查当前玩家是否有任何合法移动
+  buildLegalTargets();
+  for (int square = 0; square < 64; square++) {
+    if (legalTargets[square] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ChessBoard::scanForLegalMove(Color color) const {
   for (int y = 0; y < 8; y++) {
     for (int x = 0; x < 8; x++) {
       Position from(x, y);
       const Piece& piece = getPiece(from);
-      if (piece.type != NONE && piece.color == currentPlayer) {
+      if (piece.type != NONE && piece.color == color) {
         for (int ty = 0; ty < 8; ty++) {
           for (int tx = 0; tx < 8; tx++) {
             Position to(tx, ty);
@@ -692,24 +767,11 @@ bool ChessBoard::isCheckmate(Color color) const {
   }
   
   // 检查是否有任何合法移动可以解除将军
-  for (int y = 0; y < 8; y++) {
-    for (int x = 0; x < 8; x++) {
-      Position from(x, y);
-      const Piece& piece = getPiece(from);
-      if (piece.type != NONE && piece.color == color) {
-        for (int ty = 0; ty < 8; ty++) {
-          for (int tx = 0; tx < 8; tx++) {
-            Position to(tx, ty);
-            if (isMoveValid(from, to) && !wouldPutKingInCheck(from, to)) {
-              return false;
-            }
-          }
-        }
-      }
-    }
-  }
-  
-  return true;
+  return !(color == currentPlayer ? hasValidMoves() : scanForLegalMove(color));
+}
+
+bool ChessBoard::isStalemate(Color color) const {
+  return color == currentPlayer && !isKingInCheck(color) && !hasValidMoves();
 }
 
 bool ChessBoard::isInCheck(Color color) const {
@@ -718,258 +780,368 @@ bool ChessBoard::isInCheck(Color color) const {
 
 void ChessBoard::switchPlayer() {
   currentPlayer = (currentPlayer == WHITE) ? BLACK : WHITE;
+  invalidateLegalTargets();
 }
 
-String ChessBoard::toFEN() const {
-  String fen;
+// FEN棋子字符（下标为PieceType，黑方小写）
+static const char FEN_PIECE_CHARS[] = " pnbrqk";
+
+size_t ChessBoard::writeFEN(char* out, size_t size) const {
+  char buf[FEN_BUFFER_SIZE];
+  size_t n = 0;
   
-  // 棋盘布局
+  // 1. 棋盘布局（从第8行到第1行）
   for (int y = 7; y >= 0; y--) {
     int emptyCount = 0;
     for (int x = 0; x < 8; x++) {
-      const Piece& piece = getPiece(x, y);
+      const Piece& piece = board[x][y];
       if (piece.isEmpty()) {
         emptyCount++;
-      } else {
-        if (emptyCount > 0) {
-          fen += String(emptyCount);
-          emptyCount = 0;
-        }
-        char c;
-        switch (piece.type) {
-          case PAWN: c = 'p'; break;
-          case KNIGHT: c = 'n'; break;
-          case BISHOP: c = 'b'; break;
-          case ROOK: c = 'r'; break;
-          case QUEEN: c = 'q'; break;
-          case KING: c = 'k'; break;
-          default: c = ' ';
-        }
-        if (piece.color == WHITE) {
-          c = toupper(c);
-        }
-        fen += c;
+        continue;
       }
+      if (emptyCount > 0) {
+        buf[n++] = '0' + emptyCount;
+        emptyCount = 0;
+      }
+      char c = FEN_PIECE_CHARS[piece.type];
+      buf[n++] = piece.color == WHITE ? toupper(c) : c;
     }
     if (emptyCount > 0) {
-      fen += String(emptyCount);
+      buf[n++] = '0' + emptyCount;
     }
     if (y > 0) {
-      fen += '/';
+      buf[n++] = '/';
     }
   }
   
-  // 当前玩家
-  fen += ' ';
-  fen += (currentPlayer == WHITE) ? 'w' : 'b';
-  
-  // 易位权（暂不实现）
-  fen += ' ';
-  fen += '-';
-  
-  // 吃过路兵（暂不实现）
-  fen += ' ';
-  fen += '-';
+  // 2. 当前玩家
+  buf[n++] = ' ';
+  buf[n++] = (currentPlayer == WHITE) ? 'w' : 'b';
+  
+  // 3. 易位权
+  buf[n++] = ' ';
+  uint8_t rights = getCastlingRights();
+  if (rights & CASTLE_WHITE_KING) buf[n++] = 'K';
+  if (rights & CASTLE_WHITE_QUEEN) buf[n++] = 'Q';
+  if (rights & CASTLE_BLACK_KING) buf[n++] = 'k';
+  if (rights & CASTLE_BLACK_QUEEN) buf[n++] = 'q';
+  if (rights == 0) {
+    buf[n++] = '-';
+  }
   
-  // 半回合（暂不实现）
-  fen += ' ';
-  fen += '0';
+  // 4. 吃过路兵目标格
+  buf[n++] = ' ';
+  if (enPassantTarget.isValid()) {
+    buf[n++] = 'a' + enPassantTarget.x;
+    buf[n++] = '1' + enPassantTarget.y;
+  } else {
+    buf[n++] = '-';
+  }
   
-  // 全回合（暂不实现）
-  fen += ' ';
-  fen += '1';
+  // 5/6. 半回合计数和全回合数
+  int len = snprintf(buf + n, sizeof(buf) - n, " %u %u", halfmoveClock, fullmoveNumber);
+  n += len;
   
-  return fen;
+  if (n + 1 > size) {
+    return 0;
+  }
+  memcpy(out, buf, n);
+  out[n] = '\0';
+  return n;
 }
 
-String ChessBoard::toPGN(const Position& from, const Position& to, const Piece& piece, const Piece& targetPiece) const {
-  String pgn;
-  
-  // 处理王车易位
-  Serial.printf("toPGN: from (%d,%d) to (%d,%d), piece type=%d, dx=%d\n", from.x, from.y, to.x, to.y, piece.type, abs(to.x - from.x));
-  if (piece.type == KING && abs(to.x - from.x) == 2) {
-    if (to.x > from.x) {
-      return "O-O"; // 短易位
-    } else {
-      return "O-O-O"; // 长易位
-    }
+uint8_t ChessBoard::getCastlingRights() const {
+  // 王和对应的车都没动过，且仍在原位
+  uint8_t rights = 0;
+  if (!whiteKingMoved && board[4][0].is(KING, WHITE)) {
+    if (!whiteRookMoved[1] && board[7][0].is(ROOK, WHITE)) rights |= CASTLE_WHITE_KING;
+    if (!whiteRookMoved[0] && board[0][0].is(ROOK, WHITE)) rights |= CASTLE_WHITE_QUEEN;
   }
-  
-  // 处理兵升变
-  if (piece.type == PAWN && ((piece.color == WHITE && to.y == 7) || (piece.color == BLACK && to.y == 0))) {
-    // 默认升变为后
-    return positionToPGN(to) + "=Q";
+  if (!blackKingMoved && board[4][7].is(KING, BLACK)) {
+    if (!blackRookMoved[1] && board[7][7].is(ROOK, BLACK)) rights |= CASTLE_BLACK_KING;
+    if (!blackRookMoved[0] && board[0][7].is(ROOK, BLACK)) rights |= CASTLE_BLACK_QUEEN;
   }
-  
-  // 处理棋子类型
-  switch (piece.type) {
-    case KNIGHT: pgn += "N"; break;
-    case BISHOP: pgn += "B"; break;
-    case ROOK: pgn += "R"; break;
-    case QUEEN: pgn += "Q"; break;
-    case KING: pgn += "K"; break;
-    case PAWN: pgn += "P"; break; // 兵显示类型
-    default: break;
+  return rights;
+}
+
+String ChessBoard::toFEN() const {
+  char fen[FEN_BUFFER_SIZE];
+  writeFEN(fen, sizeof(fen));
+  return String(fen);
+}
+
+// ==========================================
+// 合法走法生成
+// ==========================================
+
+static const int KNIGHT_OFFSETS[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+static const int KING_OFFSETS[8][2] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+// 前4个为直线方向（车），后4个为斜线方向（象）
+static const int SLIDE_DIRECTIONS[8][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}, {1, 1}, {1, -1}, {-1, -1}, {-1, 1}};
+
+void ChessBoard::addLegalMove(MoveList& list, const Position& from, const Position& to, const Position& onlyTo) const {
+  if ((onlyTo.isValid() && to != onlyTo) || wouldPutKingInCheck(from, to)) {
+    return;
   }
-  
-  // 处理吃子
-  bool isEnPassant = false;
-  if (piece.type == PAWN && abs(to.x - from.x) == 1 && abs(to.y - from.y) == 1 && targetPiece.isEmpty()) {
-    // 吃过路兵
-    isEnPassant = true;
-    pgn += char('a' + from.x);
-    pgn += "x";
-  } else if (targetPiece.type != NONE && targetPiece.color != piece.color) {
-    // 普通吃子
-    if (piece.type == PAWN) {
-      // 兵吃子显示来源列
-      pgn += char('a' + from.x);
-    }
-    pgn += "x";
+  const Piece& piece = board[from.x][from.y];
+  if (piece.type == PAWN && (to.y == 7 || to.y == 0)) {
+    list.add(Move(from, to, QUEEN));
+    list.add(Move(from, to, ROOK));
+    list.add(Move(from, to, BISHOP));
+    list.add(Move(from, to, KNIGHT));
+  } else {
+    list.add(Move(from, to));
   }
+}
+
+void ChessBoard::generateLegalMoves(MoveList& list, const Position& onlyTo) const {
+  list.count = 0;
+  Color side = currentPlayer;
   
-  // 处理目标位置
-  pgn += positionToPGN(to);
-  
-  // 处理吃过路兵标记
-  if (isEnPassant) {
-    pgn += " e.p.";
+  for (int x = 0; x < 8; x++) {
+    for (int y = 0; y < 8; y++) {
+      const Piece& piece = board[x][y];
+      if (piece.isEmpty() || piece.color != side) {
+        continue;
+      }
+      Position from(x, y);
+      
+      switch (piece.type) {
+        case PAWN: {
+          int direction = (side == WHITE) ? 1 : -1;
+          int startRank = (side == WHITE) ? 1 : 6;
+          int ty = y + direction;
+          if (!isOnBoard(x, ty)) break;
+          
+          // 前进一格/两格
+          if (board[x][ty].isEmpty()) {
+            addLegalMove(list, from, Position(x, ty), onlyTo);
+            if (y == startRank && board[x][ty + direction].isEmpty()) {
+              addLegalMove(list, from, Position(x, ty + direction), onlyTo);
+            }
+          }
+          // 斜吃（含吃过路兵）
+          for (int dx = -1; dx <= 1; dx += 2) {
+            int tx = x + dx;
+            if (!isOnBoard(tx, ty)) continue;
+            const Piece& target = board[tx][ty];
+            if (!target.isEmpty() ? target.color != side
+                                  : (enPassantTarget == Position(tx, ty) && board[tx][y].type == PAWN && board[tx][y].color != side)) {
+              addLegalMove(list, from, Position(tx, ty), onlyTo);
+            }
+          }
+          break;
+        }
+        
+        case KNIGHT:
+        case KING: {
+          const int (*offsets)[2] = (piece.type == KNIGHT) ? KNIGHT_OFFSETS : KING_OFFSETS;
+          for (int i = 0; i < 8; i++) {
+            int tx = x + offsets[i][0];
+            int ty = y + offsets[i][1];
+            if (isOnBoard(tx, ty) && (board[tx][ty].isEmpty() || board[tx][ty].color != side)) {
+              addLegalMove(list, from, Position(tx, ty), onlyTo);
+            }
+          }
+          // 王车易位（条件检查在 isMoveValid 中）
+          if (piece.type == KING && x == 4) {
+            for (int tx = 2; tx <= 6; tx += 4) {
+              Position to(tx, y);
+              if ((!onlyTo.isValid() || onlyTo == to) && isMoveValid(from, to)) {
+                addLegalMove(list, from, to, onlyTo);
+              }
+            }
+          }
+          break;
+        }
+        
+        case BISHOP:
+        case ROOK:
+        case QUEEN: {
+          int first = (piece.type == BISHOP) ? 4 : 0;
+          int last = (piece.type == ROOK) ? 4 : 8;
+          for (int d = first; d < last; d++) {
+            int tx = x + SLIDE_DIRECTIONS[d][0];
+            int ty = y + SLIDE_DIRECTIONS[d][1];
+            while (isOnBoard(tx, ty)) {
+              const Piece& target = board[tx][ty];
+              if (!target.isEmpty() && target.color == side) break;
+              addLegalMove(list, from, Position(tx, ty), onlyTo);
+              if (!target.isEmpty()) break;
+              tx += SLIDE_DIRECTIONS[d][0];
+              ty += SLIDE_DIRECTIONS[d][1];
+            }
+          }
+          break;
+        }
+        
+        default:
+          break;
+      }
+    }
   }
-  
-  return pgn;
 }
 
-String ChessBoard::positionToPGN(const Position& pos) const {
-  String pgn;
-  pgn += char('a' + pos.x); // 列：a-h
-  pgn += char('1' + pos.y); // 行：1-8
-  return pgn;
+// ==========================================
+// SAN 解析与生成
+// ==========================================
+
+static const char SAN_PIECE_CHARS[] = " PNBRQK";
+
+static PieceType sanPieceType(char c) {
+  const char* found = (c != '\0' && c != ' ') ? strchr(SAN_PIECE_CHARS, c) : nullptr;
+  return found ? (PieceType)(found - SAN_PIECE_CHARS) : NONE;
 }
 
-Move ChessBoard::parsePGN(const String& pgn) const {
-  String cleanPGN = pgn;
-  // 移除可能的注释和空格
-  cleanPGN.trim();
-  
-  // 处理王车易位
-  if (cleanPGN.equals("O-O")) {
-    // 短易位
-    if (currentPlayer == WHITE) {
-      // 白方短易位
-      return Move(Position(4, 0), Position(6, 0));
-    } else {
-      // 黑方短易位
-      return Move(Position(4, 7), Position(6, 7));
-    }
-  } else if (cleanPGN.equals("O-O-O")) {
-    // 长易位
-    if (currentPlayer == WHITE) {
-      // 白方长易位
-      return Move(Position(4, 0), Position(2, 0));
-    } else {
-      // 黑方长易位
-      return Move(Position(4, 7), Position(2, 7));
+bool ChessBoard::parseSAN(const char* san, Move& move) const {
+  // 复制一个记号，去掉结尾的 +、#、!、? 和 "e.p."
+  char token[SAN_BUFFER_SIZE + 4];
+  while (*san == ' ') san++;
+  int len = 0;
+  while (san[len] != '\0' && san[len] != ' ' && san[len] != '\t' && san[len] != '\r' && san[len] != '\n') {
+    if (len >= (int)sizeof(token) - 1) return false;
+    token[len] = san[len];
+    len++;
+  }
+  token[len] = '\0';
+  if (len >= 4 && strcmp(token + len - 4, "e.p.") == 0) len -= 4;
+  while (len > 0 && strchr("+#!?", token[len - 1]) != nullptr) len--;
+  token[len] = '\0';
+  if (len < 2) return false;
+  
+  MoveList list;
+  
+  // 王车易位（也接受数字0的写法）
+  if (token[0] == 'O' || token[0] == '0') {
+    int toX;
+    if (strcmp(token, "O-O") == 0 || strcmp(token, "0-0") == 0) toX = 6;
+    else if (strcmp(token, "O-O-O") == 0 || strcmp(token, "0-0-0") == 0) toX = 2;
+    else return false;
+    generateLegalMoves(list, Position(toX, currentPlayer == WHITE ? 0 : 7));
+    for (int i = 0; i < list.count; i++) {
+      const Move& m = list[i];
+      if (board[m.from.x][m.from.y].type == KING && m.from.x == 4 && m.to.x == toX) {
+        move = m;
+        return true;
+      }
     }
+    return false;
   }
   
-  // 处理升变
-  int equalsIndex = cleanPGN.indexOf('=');
-  bool isPromotion = equalsIndex != -1;
-  String promotionPGN;
-  if (isPromotion) {
-    promotionPGN = cleanPGN.substring(0, equalsIndex);
-  } else {
-    promotionPGN = cleanPGN;
-  }
-  
-  // 解析目标位置（最后两个字符）
-  int targetCol = promotionPGN[promotionPGN.length() - 2] - 'a';
-  int targetRow = promotionPGN[promotionPGN.length() - 1] - '1';
-  Position target(targetCol, targetRow);
-  
-  // 解析棋子类型
-  PieceType pieceType = PAWN;
-  if (promotionPGN.length() > 2 && (promotionPGN[0] >= 'A' && promotionPGN[0] <= 'Z')) {
-    switch (promotionPGN[0]) {
-      case 'N': pieceType = KNIGHT; break;
-      case 'B': pieceType = BISHOP; break;
-      case 'R': pieceType = ROOK; break;
-      case 'Q': pieceType = QUEEN; break;
-      case 'K': pieceType = KING; break;
-      default: pieceType = PAWN; break;
-    }
+  // 升变：结尾的 "=Q" 或 "Q"
+  PieceType promotion = NONE;
+  if (len >= 3 && sanPieceType(token[len - 1]) >= KNIGHT && sanPieceType(token[len - 1]) <= QUEEN &&
+      (token[len - 2] == '=' || isdigit((unsigned char)token[len - 2]))) {
+    promotion = sanPieceType(token[len - 1]);
+    len -= (token[len - 2] == '=') ? 2 : 1;
   }
   
-  // 解析吃子和来源信息
-  bool isCapture = promotionPGN.indexOf('x') != -1;
-  int captureIndex = promotionPGN.indexOf('x');
+  // 目标格
+  if (len < 2 || token[len - 2] < 'a' || token[len - 2] > 'h' || token[len - 1] < '1' || token[len - 1] > '8') {
+    return false;
+  }
+  Position to(token[len - 2] - 'a', token[len - 1] - '1');
+  len -= 2;
+  
+  // 棋子类型（省略为兵，也接受 "P"）
+  int i = 0;
+  PieceType type = PAWN;
+  if (len > 0 && sanPieceType(token[0]) != NONE) {
+    type = sanPieceType(token[0]);
+    i = 1;
+  }
   
-  // 解析来源信息
-  int sourceCol = -1;
-  int sourceRow = -1;
+  // 消歧义的来源列/行，以及吃子标记
+  int fromX = -1;
+  int fromY = -1;
+  for (; i < len; i++) {
+    char c = token[i];
+    if (c >= 'a' && c <= 'h') fromX = c - 'a';
+    else if (c >= '1' && c <= '8') fromY = c - '1';
+    else if (c != 'x' && c != ':' && c != '-') return false;
+  }
   
-  // 检查是否有来源列或行
-  if (promotionPGN.length() > 2) {
-    int pieceIndex = (pieceType != PAWN) ? 1 : 0;
-    int infoStart = pieceIndex;
-    int infoEnd = isCapture ? captureIndex : promotionPGN.length() - 2;
-    
-    if (infoEnd > infoStart) {
-      String info = promotionPGN.substring(infoStart, infoEnd);
-      
-      // 解析来源列
-      if (info.length() > 0 && info[0] >= 'a' && info[0] <= 'h') {
-        sourceCol = info[0] - 'a';
-      }
-      
-      // 解析来源行
-      if (info.length() > 0 && info[info.length() - 1] >= '1' && info[info.length() - 1] <= '8') {
-        sourceRow = info[info.length() - 1] - '1';
-      }
+  // 在走到目标格的合法走法中查找唯一匹配（升变未指定棋子时按升后处理）
+  generateLegalMoves(list, to);
+  int matches = 0;
+  for (int k = 0; k < list.count; k++) {
+    const Move& m = list[k];
+    if (m.to != to || board[m.from.x][m.from.y].type != type) continue;
+    if ((fromX >= 0 && m.from.x != fromX) || (fromY >= 0 && m.from.y != fromY)) continue;
+    if (m.promotion != NONE && m.promotion != (promotion != NONE ? promotion : QUEEN)) continue;
+    if (m.promotion == NONE && promotion != NONE) continue;
+    move = m;
+    matches++;
+  }
+  return matches == 1;
+}
+
+size_t ChessBoard::formatSAN(const Move& move, char* out, size_t size) const {
+  // 只需要走到同一格的走法：用于确认合法性和消歧义
+  MoveList list;
+  generateLegalMoves(list, move.to);
+  
+  // 确认是合法走法（升变未指定时按升后）
+  PieceType promotion = NONE;
+  bool legal = false;
+  for (int i = 0; i < list.count && !legal; i++) {
+    if (list[i] == move && (list[i].promotion == NONE || list[i].promotion == (move.promotion != NONE ? move.promotion : QUEEN))) {
+      promotion = list[i].promotion;
+      legal = true;
     }
   }
+  if (!legal) return 0;
   
-  // 查找匹配的棋子
-  Position source(-1, -1);
-  // 对于黑方，从高行号开始查找，确保选择正确的棋子
-  if (currentPlayer == BLACK) {
-    for (int y = 7; y >= 0; y--) {
-      for (int x = 0; x < 8; x++) {
-        const Piece& piece = board[x][y];
-        if (piece.type == pieceType && piece.color == currentPlayer) {
-          // 检查是否匹配来源信息
-          if ((sourceCol == -1 || x == sourceCol) && (sourceRow == -1 || y == sourceRow)) {
-            // 检查是否可以移动到目标位置
-            if (isMoveValid(Position(x, y), target) && !wouldPutKingInCheck(Position(x, y), target)) {
-              source = Position(x, y);
-              break;
-            }
-          }
-        }
-      }
-      if (source.isValid()) break;
-    }
+  const Piece& piece = board[move.from.x][move.from.y];
+  char buf[SAN_BUFFER_SIZE];
+  size_t n = 0;
+  
+  if (piece.type == KING && abs(move.to.x - move.from.x) == 2) {
+    const char* castle = (move.to.x == 6) ? "O-O" : "O-O-O";
+    n = strlen(castle);
+    memcpy(buf, castle, n);
   } else {
-    // 白方保持正常顺序
-    for (int y = 0; y < 8; y++) {
-      for (int x = 0; x < 8; x++) {
-        const Piece& piece = board[x][y];
-        if (piece.type == pieceType && piece.color == currentPlayer) {
-          // 检查是否匹配来源信息
-          if ((sourceCol == -1 || x == sourceCol) && (sourceRow == -1 || y == sourceRow)) {
-            // 检查是否可以移动到目标位置
-            if (isMoveValid(Position(x, y), target) && !wouldPutKingInCheck(Position(x, y), target)) {
-              source = Position(x, y);
-              break;
-            }
-          }
+    bool capture = !board[move.to.x][move.to.y].isEmpty() || (piece.type == PAWN && move.from.x != move.to.x);
+    if (piece.type == PAWN) {
+      if (capture) buf[n++] = 'a' + move.from.x;
+    } else {
+      buf[n++] = SAN_PIECE_CHARS[piece.type];
+      // 同类棋子能走到同一格时，优先用列区分，其次用行，都不行就两者都写
+      bool ambiguous = false, sameFile = false, sameRank = false;
+      for (int i = 0; i < list.count; i++) {
+        const Move& m = list[i];
+        if (m.from != move.from && board[m.from.x][m.from.y].type == piece.type) {
+          ambiguous = true;
+          if (m.from.x == move.from.x) sameFile = true;
+          if (m.from.y == move.from.y) sameRank = true;
         }
       }
-      if (source.isValid()) break;
+      if (ambiguous && (!sameFile || sameRank)) buf[n++] = 'a' + move.from.x;
+      if (ambiguous && sameFile) buf[n++] = '1' + move.from.y;
     }
+    if (capture) buf[n++] = 'x';
+    buf[n++] = 'a' + move.to.x;
+    buf[n++] = '1' + move.to.y;
+    if (promotion != NONE) {
+      buf[n++] = '=';
+      buf[n++] = SAN_PIECE_CHARS[promotion];
+    }
+  }
+  
+  // 将军/将死标记：在副本上走一步（临时关闭本任务的走子日志，避免递归输出）
+  ChessBoard after = *this;
+  {
+    SerialLogMute mute;
+    after.makeMove(Move(move.from, move.to, promotion));
+  }
+  if (after.isKingInCheck(after.currentPlayer)) {
+    buf[n++] = after.hasValidMoves() ? '+' : '#';
   }
   
-  return Move(source, target);
+  if (n + 1 > size) return 0;
+  memcpy(out, buf, n);
+  out[n] = '\0';
+  return n;
 }
 
 GameState ChessBoard::getCurrentState() const {
@@ -1038,58 +1210,134 @@ PieceType ChessBoard::getSelectedPromotionPiece() const {
   return selectedPromotionPiece;
 }
 
-bool ChessBoard::fromFEN(const String& fen) {
-  // 简单实现，仅解析棋盘布局和当前玩家
-  int index = 0;
+// 读取一个不超过65535的十进制数，失败返回false
+static bool readFENNumber(const char*& p, uint16_t& value) {
+  if (!isdigit((unsigned char)*p)) return false;
+  unsigned long v = 0;
+  while (isdigit((unsigned char)*p)) {
+    v = v * 10 + (*p - '0');
+    if (v > 0xFFFF) return false;
+    p++;
+  }
+  value = (uint16_t)v;
+  return true;
+}
+
+bool ChessBoard::readFEN(const char* fen) {
+  const char* p = fen;
+  while (*p == ' ') p++;
+  
+  // 1. 棋盘布局：先解析到临时数组，整串合法才写入棋盘
+  Piece squares[8][8];
   int x = 0;
   int y = 7;
-  
-  while (index < fen.length() && fen[index] != ' ') {
-    char c = fen[index];
+  for (; *p != '\0' && *p != ' '; p++) {
+    char c = *p;
     if (c == '/') {
+      if (x != 8 || y == 0) return false;
       x = 0;
       y--;
-      index++;
-    } else if (isdigit(c)) {
+    } else if (c >= '1' && c <= '8') {
       int count = c - '0';
+      if (x + count > 8) return false;
       for (int i = 0; i < count; i++) {
-        setPiece(x, y, Piece(NONE, WHITE));
-        x++;
+        squares[x++][y] = Piece(NONE, WHITE);
       }
-      index++;
     } else {
-      PieceType type;
-      Color color = isupper(c) ? WHITE : BLACK;
-      c = tolower(c);
-      
-      switch (c) {
-        case 'p': type = PAWN; break;
-        case 'n': type = KNIGHT; break;
-        case 'b': type = BISHOP; break;
-        case 'r': type = ROOK; break;
-        case 'q': type = QUEEN; break;
-        case 'k': type = KING; break;
-        default: return false;
-      }
-      
-      setPiece(x, y, Piece(type, color));
-      x++;
-      index++;
+      const char* found = strchr(FEN_PIECE_CHARS + 1, tolower(c));
+      if (c == '\0' || found == nullptr || x >= 8) return false;
+      squares[x++][y] = Piece((PieceType)(found - FEN_PIECE_CHARS), isupper(c) ? WHITE : BLACK);
     }
   }
+  if (x != 8 || y != 0) return false;
+  
+  // 2. 当前玩家（缺省为白方）
+  Color player = WHITE;
+  while (*p == ' ') p++;
+  if (*p == 'w' || *p == 'b') {
+    player = (*p == 'b') ? BLACK : WHITE;
+    p++;
+  } else if (*p != '\0') {
+    return false;
+  }
   
-  // 解析当前玩家
-  while (index < fen.length() && fen[index] == ' ') {
-    index++;
+  // 3. 易位权（缺省为无），KQkq 依次对应 CASTLE_* 的各位
+  uint8_t rights = 0;
+  while (*p == ' ') p++;
+  if (*p == '-') {
+    p++;
+  } else {
+    for (; *p != '\0' && *p != ' '; p++) {
+      const char* found = strchr("KQkq", *p);
+      if (found == nullptr) return false;
+      rights |= 1 << (found - "KQkq");
+    }
   }
-  if (index < fen.length()) {
-    currentPlayer = (fen[index] == 'w') ? WHITE : BLACK;
+  
+  // 4. 吃过路兵目标格
+  Position epTarget(-1, -1);
+  while (*p == ' ') p++;
+  if (*p == '-') {
+    p++;
+  } else if (*p >= 'a' && *p <= 'h' && (p[1] == '3' || p[1] == '6')) {
+    epTarget = Position(p[0] - 'a', p[1] - '1');
+    p += 2;
+  } else if (*p != '\0') {
+    return false;
   }
   
-  deselectPiece();
+  // 5/6. 半回合计数和全回合数（缺省 0 1）
+  uint16_t halfmove = 0;
+  uint16_t fullmove = 1;
+  while (*p == ' ') p++;
+  if (*p != '\0' && !readFENNumber(p, halfmove)) return false;
+  while (*p == ' ') p++;
+  if (*p != '\0' && !readFENNumber(p, fullmove)) return false;
+  
+  // 全部解析成功，写入棋盘状态
+  setPosition(squares, player, rights, epTarget, halfmove, fullmove);
   return true;
 }
 
+void ChessBoard::setPosition(const Piece squares[8][8], Color sideToMove, uint8_t castlingRights,
+                             const Position& enPassant, uint16_t halfmove, uint16_t fullmove) {
+  for (int x = 0; x < 8; x++) {
+    for (int y = 0; y < 8; y++) {
+      board[x][y] = squares[x][y];
+    }
+  }
+  currentPlayer = sideToMove;
+  applyCastlingRights(castlingRights);
+  invalidateLegalTargets();
+  enPassantTarget = enPassant;
+  halfmoveClock = halfmove;
+  fullmoveNumber = fullmove > 0 ? fullmove : 1;
+  
+  lastMoveFrom = Position(-1, -1);
+  lastMoveTo = Position(-1, -1);
+  currentState = NormalPlay;
+  promotionPawnPos = Position(-1, -1);
+  whiteKingInCheck = false;
+  blackKingInCheck = false;
+  
+  deselectPiece();
+}
+
+void ChessBoard::applyCastlingRights(uint8_t castlingRights) {
+  bool whiteKingHome = board[4][0].is(KING, WHITE);
+  bool blackKingHome = board[4][7].is(KING, BLACK);
+  whiteRookMoved[1] = !((castlingRights & CASTLE_WHITE_KING) && whiteKingHome && board[7][0].is(ROOK, WHITE));
+  whiteRookMoved[0] = !((castlingRights & CASTLE_WHITE_QUEEN) && whiteKingHome && board[0][0].is(ROOK, WHITE));
+  blackRookMoved[1] = !((castlingRights & CASTLE_BLACK_KING) && blackKingHome && board[7][7].is(ROOK, BLACK));
+  blackRookMoved[0] = !((castlingRights & CASTLE_BLACK_QUEEN) && blackKingHome && board[0][7].is(ROOK, BLACK));
+  whiteKingMoved = whiteRookMoved[0] && whiteRookMoved[1];
+  blackKingMoved = blackRookMoved[0] && blackRookMoved[1];
+}
+
+bool ChessBoard::fromFEN(const String& fen) {
+  return readFEN(fen.c_str());
+}
+
 // 验证移动是否合法（公共方法，用于测试）
 bool ChessBoard::validateMove(const Position& from, const Position& to) const {
   return isMoveValid(from, to) && !wouldPutKingInCheck(from, to);
@@ -1120,6 +1368,8 @@ void ChessBoard::undoMove() {
   blackRookMoved[1] = wasBlackRookMoved[1];
   enPassantTarget = wasEnPassantTarget;
   currentPlayer = wasCurrentPlayer;
+  halfmoveClock = wasHalfmoveClock;
+  fullmoveNumber = wasFullmoveNumber;
   
   // 特殊处理王车易位的撤销
   if (movedPiece.type == KING) {
@@ -1162,3 +1412,60 @@ void ChessBoard::undoMove() {
   // 取消选择
   deselectPiece();
 }
+
+UndoInfo ChessBoard::getLastUndoInfo() const {
+  UndoInfo undo;
+  undo.captured = lastCapturedPiece;
+  undo.castlingRights = 0;
+  if (!wasWhiteKingMoved) {
+    if (!wasWhiteRookMoved[1]) undo.castlingRights |= CASTLE_WHITE_KING;
+    if (!wasWhiteRookMoved[0]) undo.castlingRights |= CASTLE_WHITE_QUEEN;
+  }
+  if (!wasBlackKingMoved) {
+    if (!wasBlackRookMoved[1]) undo.castlingRights |= CASTLE_BLACK_KING;
+    if (!wasBlackRookMoved[0]) undo.castlingRights |= CASTLE_BLACK_QUEEN;
+  }
+  undo.enPassant = wasEnPassantTarget;
+  undo.halfmoveClock = wasHalfmoveClock;
+  return undo;
+}
+
+void ChessBoard::unmakeMove(const Move& move, const UndoInfo& undo) {
+  Piece moved = getPiece(move.to);
+  if (move.promotion != NONE) {
+    moved.type = PAWN;
+  }
+  setPiece(move.from, moved);
+  setPiece(move.to, undo.captured);
+  
+  // 吃过路兵：被吃的兵在起点同一横线上
+  if (moved.type == PAWN && move.from.x != move.to.x && undo.captured.isEmpty()) {
+    setPiece(Position(move.to.x, move.from.y), Piece(PAWN, moved.color == WHITE ? BLACK : WHITE));
+  }
+  
+  // 易位：车回到角上
+  if (moved.type == KING && abs(move.to.x - move.from.x) == 2) {
+    int y = move.from.y;
+    int rookFrom = move.to.x == 6 ? 7 : 0;
+    int rookTo = move.to.x == 6 ? 5 : 3;
+    setPiece(Position(rookFrom, y), getPiece(Position(rookTo, y)));
+    setPiece(Position(rookTo, y), Piece(NONE, moved.color));
+  }
+  
+  currentPlayer = moved.color;
+  applyCastlingRights(undo.castlingRights);
+  enPassantTarget = undo.enPassant;
+  halfmoveClock = undo.halfmoveClock;
+  if (moved.color == BLACK && fullmoveNumber > 1) {
+    fullmoveNumber--;
+  }
+  whiteKingInCheck = isKingInCheck(WHITE);
+  blackKingInCheck = isKingInCheck(BLACK);
+  
+  // 单步撤销的记录已经失效
+  lastMoveFrom = Position(-1, -1);
+  lastMoveTo = Position(-1, -1);
+  currentState = NormalPlay;
+  promotionPawnPos = Position(-1, -1);
+  deselectPiece();
+}
@@ -19,6 +19,15 @@ enum Color {
   BLACK
 };
 
+// 易位权位掩码（FEN中的 K Q k q）
+const uint8_t CASTLE_WHITE_KING = 1;
+const uint8_t CASTLE_WHITE_QUEEN = 2;
+const uint8_t CASTLE_BLACK_KING = 4;
+const uint8_t CASTLE_BLACK_QUEEN = 8;
+
+// FEN缓冲区大小（最长合法FEN约90个字符）
+const size_t FEN_BUFFER_SIZE = 96;
+
 // 游戏状态枚举
 enum GameState {
   NormalPlay,
@@ -27,8 +36,8 @@ enum GameState {
 
 // 位置结构体
 struct Position {
-  int x; // 0-7 (a-h)
-  int y; // 0-7 (1-8)
+  int8_t x; // 0-7 (a-h)
+  int8_t y; // 0-7 (1-8)
   
   Position() : x(-1), y(-1) {}
   Position(int x, int y) : x(x), y(y) {}
@@ -47,23 +56,54 @@ struct Piece {
   Piece(PieceType type, Color color) : type(type), color(color) {}
   
   bool isEmpty() const { return type == NONE; }
+  bool is(PieceType t, Color c) const { return type == t && color == c; }
 };
 
 // 走法结构体
 struct Move {
   Position from;
   Position to;
+  PieceType promotion; // 升变棋子（非升变走法为NONE）
   
-  Move() : from(Position(-1, -1)), to(Position(-1, -1)) {}
-  Move(Position from, Position to) : from(from), to(to) {}
+  Move() : from(Position(-1, -1)), to(Position(-1, -1)), promotion(NONE) {}
+  Move(Position from, Position to) : from(from), to(to), promotion(NONE) {}
+  Move(Position from, Position to, PieceType promotion) : from(from), to(to), promotion(promotion) {}
   
   bool isValid() const { return from.isValid() && to.isValid(); }
+  // 只比较起止格（玩家走子时升变棋子尚未选择）
   bool operator==(const Move& other) const { return from == other.from && to == other.to; }
   bool operator!=(const Move& other) const { return !(*this == other); }
 };
 
-// 前向声明
+// 固定容量的走法列表（在栈上使用，不分配堆内存）
+// 国际象棋单个局面的合法走法最多218个
+const int MAX_MOVES = 256;
+
+struct MoveList {
+  Move moves[MAX_MOVES];
+  int count;
+  
+  MoveList() : count(0) {}
+  
+  void add(const Move& move) {
+    if (count < MAX_MOVES) {
+      moves[count++] = move;
+    }
+  }
+  const Move& operator[](int index) const { return moves[index]; }
+};
+
+// SAN缓冲区大小（最长如 "Qa1xb2+" / "exd8=Q#"）
+const size_t SAN_BUFFER_SIZE = 12;
+
 
+// 撤销一步所需的走子前状态（多级悔棋用）
+struct UndoInfo {
+  Piece captured;          // 被吃的棋子，吃过路兵时为空（由走法推出）
+  uint8_t castlingRights;  // 走子前的易位权（CASTLE_* 位掩码）
+  Position enPassant;      // 走子前的吃过路兵目标格
+  uint16_t halfmoveClock;  // 走子前的半回合计数
+};
 
 // 棋盘类
 class ChessBoard {
@@ -86,6 +126,10 @@ private:
   Position lastMoveFrom;
   Position lastMoveTo;
   
+  // FEN回合计数
+  uint16_t halfmoveClock;   // 距上次吃子或兵走的半回合数
+  uint16_t fullmoveNumber;  // 全回合数，从1开始，黑方走完加一
+  
   // 用于撤销移动的状态
   Piece lastCapturedPiece;
   bool wasWhiteKingInCheck;
@@ -96,10 +140,17 @@ private:
   bool wasBlackRookMoved[2];
   Position wasEnPassantTarget;
   Color wasCurrentPlayer;
+  uint16_t wasHalfmoveClock;
+  uint16_t wasFullmoveNumber;
   
   // 游戏状态
   GameState currentState;
   
+  // 合法走法缓存：当前局面下走子方每个起点格（下标 y*8+x）能走到的目标格位图（位 y*8+x）
+  // 第一次查询时一次生成，局面改变时作废；选子高亮、有无合法走法、将死/逼和判断都从这里读
+  mutable uint64_t legalTargets[64];
+  mutable bool legalTargetsValid;
+  
   // 升变相关状态
   Position promotionPawnPos;
   Color promotionColor;
@@ -117,15 +168,28 @@ private:
   // 检查是否会导致自己的王被将军
   bool wouldPutKingInCheck(const Position& from, const Position& to) const;
   
-  // 生成所有合法移动
+  // 从合法走法缓存取出选中棋子的目标格
   void generateValidMoves(const Position& pos);
   
+  // 需要时生成合法走法缓存
+  void buildLegalTargets() const;
+  void invalidateLegalTargets() { legalTargetsValid = false; }
+  
+  // 逐格检查color方是否有合法走法（不是走子方时用，不经过缓存）
+  bool scanForLegalMove(Color color) const;
+  
   // 检查王是否被将军
   bool isKingInCheck(Color color) const;
   
   // 检查是否可以吃掉对方的王（用于将军判断）
   bool canCaptureKing(Color attackerColor) const;
   
+  // 走法合法（不会让己方王被将军）时加入列表，到底线的兵走法展开为4种升变
+  void addLegalMove(MoveList& list, const Position& from, const Position& to, const Position& onlyTo) const;
+  
+  // 按易位权设置王车移动标记，王或车不在原位时忽略对应易位权
+  void applyCastlingRights(uint8_t castlingRights);
+  
   // 模拟移动并检查是否会被将军
   bool simulateMoveAndCheckCheck(const Position& from, const Position& to, Color kingColor) const;
   
@@ -151,6 +215,9 @@ public:
   // 移动棋子
   bool movePiece(const Position& from, const Position& to);
   
+  // 执行一步完整走法（升变时自动确认move.promotion，默认升后）
+  bool makeMove(const Move& move);
+  
   // 选择棋子
   bool selectPiece(const Position& pos);
   
@@ -166,32 +233,58 @@ public:
   // 获取合法移动列表
   const std::vector<Position>& getValidMoves() const;
   
+  // 走子方从 from 出发的全部合法目标格（位 y*8+x），不是走子方的棋子为0
+  uint64_t getLegalTargets(const Position& from) const;
+  
+  // 合法走法缓存是否有效（只读查询不应让它作废）
+  bool isLegalTargetCacheValid() const { return legalTargetsValid; }
+  
   // 检查是否有合法移动
   bool hasValidMoves() const;
   
   // 检查是否被将死
   bool isCheckmate(Color color) const;
   
+  // 检查是否被逼和（color方走棋、没被将军且没有合法走法）
+  bool isStalemate(Color color) const;
+  
   // 检查是否被将军
   bool isInCheck(Color color) const;
   
   // 切换玩家
   void switchPlayer();
   
-  // 生成FEN字符串
-  String toFEN() const;
+  // 生成FEN到调用方缓冲区（六个字段，不分配内存），返回长度；缓冲区不足返回0
+  size_t writeFEN(char* out, size_t size) const;
+  
+  // 从FEN加载棋盘（缺省字段按 "w - - 0 1" 处理），格式错误时棋盘保持不变
+  bool readFEN(const char* fen);
+  
+  // 直接设置局面（readFEN 和打包的谜题数据共用），王或车不在原位时忽略对应易位权
+  void setPosition(const Piece squares[8][8], Color sideToMove, uint8_t castlingRights,
+                   const Position& enPassant, uint16_t halfmove = 0, uint16_t fullmove = 1);
   
-  // 从FEN加载棋盘
+  // 当前易位权（CASTLE_* 位掩码）与吃过路兵目标格
+  uint8_t getCastlingRights() const;
+  Position getEnPassantTarget() const { return enPassantTarget; }
+  
+  // FEN回合计数
+  uint16_t getHalfmoveClock() const { return halfmoveClock; }
+  uint16_t getFullmoveNumber() const { return fullmoveNumber; }
+  
+  // String 版本，内部调用 writeFEN / readFEN
+  String toFEN() const;
   bool fromFEN(const String& fen);
   
-  // 生成PGN记谱法
-  String toPGN(const Position& from, const Position& to, const Piece& piece, const Piece& targetPiece) const;
+  // 生成当前玩家的全部合法走法（升变按后、车、象、马展开为4步）
+  // 给出 onlyTo 时只保留走到该格的走法，省掉其余走法的将军检测（SAN解析用）
+  void generateLegalMoves(MoveList& list, const Position& onlyTo = Position(-1, -1)) const;
   
-  // 位置转PGN字符串
-  String positionToPGN(const Position& pos) const;
+  // 解析SAN（如 "Nbd7"、"exd8=Q#"、"O-O"、"Qb1+!?"），在合法走法中唯一匹配才成功
+  bool parseSAN(const char* san, Move& move) const;
   
-  // 从PGN字符串解析移动
-  Move parsePGN(const String& pgn) const;
+  // 生成move的SAN（含消歧义和 +/# 标记）到调用方缓冲区，返回长度；非法走法或缓冲区不足返回0
+  size_t formatSAN(const Move& move, char* out, size_t size) const;
   
   // 获取当前游戏状态
   GameState getCurrentState() const;
@@ -215,6 +308,12 @@ public:
   
   // 撤销上一步移动
   void undoMove();
+  
+  // 最近一次 movePiece 之前的状态，与 unmakeMove 配合可以撤销任意多步
+  UndoInfo getLastUndoInfo() const;
+  
+  // 撤销 move（必须是走到当前局面的最后一步，升变走法需带 promotion）
+  void unmakeMove(const Move& move, const UndoInfo& undo);
 };
 
 // 全局棋盘实例
@@ -226,3 +325,19 @@ void serialPrintln(const char* str);
 void serialPrintf(const char* format, ...);
 void serialPrint(const String& str);
 void serialPrint(const char* str);
+
+// 运行时串口日志开关（UCI模式时关闭调试输出）
+void setSerialLogEnabled(bool enabled);
+bool isSerialLogEnabled();
+
+// 作用域内临时关闭当前任务的串口日志，只影响所在线程，可嵌套
+// （AI任务搜索时静音不会吞掉界面线程的日志，也不会把界面的开关改回去）
+class SerialLogMute {
+public:
+  SerialLogMute();
+  ~SerialLogMute();
+
+private:
+  SerialLogMute(const SerialLogMute&);
+  SerialLogMute& operator=(const SerialLogMute&);
+};
@@ -0,0 +1,85 @@
+#include "dirty_rect.h"
+
+static DirtyRect unionRect(const DirtyRect& a, const DirtyRect& b) {
+  int left = a.x < b.x ? a.x : b.x;
+  int top = a.y < b.y ? a.y : b.y;
+  int right = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  int bottom = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  DirtyRect result = {(int16_t)left, (int16_t)top, (int16_t)(right - left), (int16_t)(bottom - top)};
+  return result;
+}
+
+// 相交或边挨边（合并后不会多推无关的像素列/行）
+static bool touches(const DirtyRect& a, const DirtyRect& b) {
+  return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+static int32_t area(const DirtyRect& rect) {
+  return (int32_t)rect.w * rect.h;
+}
+
+DirtyTracker::DirtyTracker(int16_t screenWidth, int16_t screenHeight)
+    : count(0), width(screenWidth), height(screenHeight), valid(false), fullFrame(true) {
+  for (int i = 0; i < DIRTY_REGION_MAX; i++) {
+    signatures[i] = 0;
+  }
+}
+
+void DirtyTracker::beginFrame() {
+  count = 0;
+  fullFrame = !valid;
+}
+
+void DirtyTracker::update(int region, uint32_t signature, int x, int y, int w, int h) {
+  if (region < 0 || region >= DIRTY_REGION_MAX) {
+    return;
+  }
+  bool changed = signatures[region] != signature;
+  signatures[region] = signature;
+  if (fullFrame || !changed) {
+    return;
+  }
+  // 裁到屏幕范围内
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width) { w = width - x; }
+  if (y + h > height) { h = height - y; }
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  DirtyRect rect = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+  addRect(rect);
+}
+
+void DirtyTracker::addRect(DirtyRect rect) {
+  // 与已有矩形相交就合并，合并后的矩形可能又碰到别的，重新检查
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (int i = 0; i < count; i++) {
+      if (touches(rects[i], rect)) {
+        rect = unionRect(rects[i], rect);
+        rects[i] = rects[--count];
+        merged = true;
+        break;
+      }
+    }
+  }
+  if (count < DIRTY_RECT_MAX) {
+    rects[count++] = rect;
+    return;
+  }
+  // 已满：并入面积增长最小的矩形
+  int best = 0;
+  int32_t bestGrowth = 0;
+  for (int i = 0; i < count; i++) {
+    int32_t growth = area(unionRect(rects[i], rect)) - area(rects[i]);
+    if (i == 0 || growth < bestGrowth) {
+      best = i;
+      bestGrowth = growth;
+    }
+  }
+  DirtyRect grown = unionRect(rects[best], rect);
+  rects[best] = rects[--count];
+  addRect(grown);
+}
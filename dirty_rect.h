@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+
+// 脏矩形记录：每帧按区域给出内容签名，与上一帧比较，只把变化的区域推送到屏幕
+//   区域可以互相重叠（光标边框会压到相邻格子上），重绘时在裁剪区域内重画整个场景，
+//   所以只要求区域矩形盖住该区域可能改动的像素
+//   变化的矩形最多 DIRTY_RECT_MAX 个：相交或相邻的合并，超出时并入面积增长最小的那个
+const int DIRTY_RECT_MAX = 8;
+const int DIRTY_REGION_MAX = 80;
+
+struct DirtyRect {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+class DirtyTracker {
+private:
+  uint32_t signatures[DIRTY_REGION_MAX];
+  DirtyRect rects[DIRTY_RECT_MAX];
+  int count;
+  int16_t width;
+  int16_t height;
+  bool valid;      // 上一帧的签名是否还对应屏幕内容
+  bool fullFrame;  // 本帧需要整屏重画
+
+  void addRect(DirtyRect rect);
+
+public:
+  DirtyTracker(int16_t screenWidth, int16_t screenHeight);
+
+  // 屏幕被其他界面整个改写后调用，下一帧整屏重画
+  void invalidate() { valid = false; }
+
+  // 开始新的一帧，清空上一帧的脏矩形
+  void beginFrame();
+
+  // 给出区域本帧的签名和屏幕矩形，签名与上一帧不同时记为脏
+  void update(int region, uint32_t signature, int x, int y, int w, int h);
+
+  // 本帧已推送到屏幕，签名生效
+  void endFrame() { valid = true; }
+
+  bool isFullFrame() const { return fullFrame; }
+  int getCount() const { return count; }
+  const DirtyRect& getRect(int index) const { return rects[index]; }
+};
@@ -0,0 +1,68 @@
+#include "display_pipeline.h"
+#include <string.h>
+
+DisplayPipeline::DisplayPipeline()
+    : link(nullptr), palette(nullptr), active(0), transfers(0), pixels(0), stalls(0) {
+  inFlight[0] = false;
+  inFlight[1] = false;
+}
+
+void DisplayPipeline::begin(DisplayLink* displayLink) {
+  fence();
+  link = displayLink;
+}
+
+void DisplayPipeline::fence() {
+  if (link != nullptr) {
+    link->waitIdle();
+  }
+  inFlight[0] = false;
+  inFlight[1] = false;
+}
+
+bool DisplayPipeline::present(const void* canvasPixels, int canvasWidth, const DirtyRect& rect) {
+  if (link == nullptr || canvasPixels == nullptr || rect.w <= 0 || rect.h <= 0) {
+    return false;
+  }
+  int rowsPerChunk = DISPLAY_STAGING_PIXELS / rect.w;
+  for (int y = rect.y; y < rect.y + rect.h; y += rowsPerChunk) {
+    int rows = rect.y + rect.h - y;
+    if (rows > rowsPerChunk) {
+      rows = rowsPerChunk;
+    }
+    // 这块缓冲区交出的传输还没确认完成时，先等通道空闲
+    if (inFlight[active]) {
+      fence();
+    }
+    uint16_t* out = staging[active];
+    for (int row = 0; row < rows; row++) {
+      int offset = (y + row) * canvasWidth + rect.x;
+      if (palette != nullptr) {
+        const uint8_t* in = (const uint8_t*)canvasPixels + offset;
+        for (int x = 0; x < rect.w; x++) {
+          out[x] = palette[in[x]];
+        }
+      } else {
+        memcpy(out, (const uint16_t*)canvasPixels + offset, rect.w * sizeof(uint16_t));
+      }
+      out += rect.w;
+    }
+    if (link->isBusy()) {
+      stalls++;
+    }
+    link->startTransfer(rect.x, y, rect.w, rows, staging[active]);
+    // 通道开始这次传输前已等上一次完成，另一块缓冲区空出来了
+    inFlight[active] = true;
+    inFlight[active ^ 1] = false;
+    active ^= 1;
+    transfers++;
+    pixels += rect.w * rows;
+  }
+  return true;
+}
+
+void DisplayPipeline::poll() {
+  if (link != nullptr && !link->isBusy()) {
+    fence();
+  }
+}
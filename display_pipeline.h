@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "dirty_rect.h"
+
+// 异步推屏：画布上的矩形先按行复制（8位画布时查表转换）到传输缓冲区，
+// 再交给传输通道（设备端是 SPI DMA）发送，present() 在最后一段传输开始后立即返回，
+// CPU 接着处理按键、画下一帧，不再等整个 SPI 传输结束
+//   两块传输缓冲区轮流使用：一块在传输时往另一块填下一段，
+//   通道同一时间只有一次传输，开始新传输前先等上一次完成（完成围栏）
+//   画布本身不被通道读取，present() 返回后就可以改写
+//   缓冲区中的像素已是屏幕的字节序：16位画布原样复制，8位画布的调色板由 setPalette() 给出
+const int DISPLAY_STAGING_PIXELS = 240 * 16;  // 每块传输缓冲区的像素数（整屏宽的16行）
+
+// 把一块像素送到屏幕的传输通道
+// 设备端由 LcdDisplayLink（lcd_display_link.h）用 DMA 实现，主机端由 SimDisplayLink（host/sim_display_link.h）模拟
+class DisplayLink {
+public:
+  virtual ~DisplayLink() {}
+
+  // 开始把 w*h 个按行连续的像素发到屏幕矩形，返回时传输可能还在进行；
+  // 上一次传输没完成时先等它完成
+  virtual void startTransfer(int x, int y, int w, int h, const uint16_t* pixels) = 0;
+
+  // 还有传输在进行
+  virtual bool isBusy() = 0;
+
+  // 等待所有传输完成，之后传输缓冲区可以改写
+  virtual void waitIdle() = 0;
+};
+
+class DisplayPipeline {
+private:
+  DisplayLink* link;
+  const uint16_t* palette;  // 8位画布的调色板（屏幕字节序），nullptr 表示画布是16位
+  uint16_t staging[2][DISPLAY_STAGING_PIXELS];
+  uint8_t active;           // 下一段要填的缓冲区
+  bool inFlight[2];         // 缓冲区已交给通道，还没确认传输完成
+  uint32_t transfers;
+  uint32_t pixels;
+  uint32_t stalls;          // 开始传输时上一次还没完成、只能等待的次数
+
+  // 围栏：等待通道空闲，所有缓冲区都可以改写
+  void fence();
+
+public:
+  DisplayPipeline();
+
+  void begin(DisplayLink* displayLink);
+  bool isReady() const { return link != nullptr; }
+
+  // 8位画布的调色板（256项，屏幕字节序），传 nullptr 表示画布是16位
+  void setPalette(const uint16_t* colors) { palette = colors; }
+
+  // 把画布（宽 canvasWidth 像素，按行连续）上的 rect 异步推到屏幕，
+  // 没有 begin() 或画布没有缓冲区时返回false
+  bool present(const void* canvasPixels, int canvasWidth, const DirtyRect& rect);
+
+  // 等待已开始的传输全部完成（直接写屏或进入睡眠之前调用）
+  void finish() { fence(); }
+
+  // 传输已结束时让通道释放总线，主循环每轮调用
+  void poll();
+
+  bool isBusy() { return link != nullptr && link->isBusy(); }
+
+  uint32_t getTransfers() const { return transfers; }
+  uint32_t getPixels() const { return pixels; }
+  uint32_t getStalls() const { return stalls; }
+};
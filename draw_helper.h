@@ -1,7 +1,12 @@
 #pragma once
 #include <M5Cardputer.h>
 #include "common.h"
+#include "dirty_rect.h"
+#include "display_pipeline.h"
 #include "icon_bmp.h"
+#include "palette.h"
+#include "profiler.h"
+#include "tile_cache.h"
 
 // 外部变量声明
 extern int cursorX;
@@ -9,6 +14,10 @@ extern int cursorY;
 extern ChessBoard chessBoard;
 extern bool isPuzzleMode;
 extern bool isWhitePlayer;
+extern DirtyTracker gameScreenDamage;
+extern DisplayPipeline displayPipeline;
+extern TileCache pieceTiles;
+extern CanvasPalette canvasPalette;
 
 // 棋盘绘制相关常量
 const int BOARD_PADDING = 2;
@@ -23,14 +32,42 @@ const int BOARD_HEIGHT = BOARD_SIZE * SQUARE_SIZE;
 const int BOARD_X = (SCREEN_WIDTH - BOARD_WIDTH) / 2;
 const int BOARD_Y = (SCREEN_HEIGHT - BOARD_HEIGHT) / 2;
 
-// 颜色定义
-const unsigned short COLOR_BLACK = 0x0000;
-const unsigned short COLOR_WHITE = 0xFFFF;
+// RGB565 颜色值（图标透明色、调色板和图块合成用）
+const uint16_t RGB565_BLACK = 0x0000;
+const uint16_t RGB565_WHITE = 0xFFFF;
+
+// 颜色定义：画布上作画用的颜色
+#if defined(CARDCHESS_PALETTE_CANVAS)
+// 8位调色板画布：颜色常量是调色板下标，与 CANVAS_UI_COLORS 的顺序一致
+const unsigned short COLOR_BLACK = 0;
+const unsigned short COLOR_WHITE = 1;
+const unsigned short COLOR_LIGHT_SQUARE = 2;
+const unsigned short COLOR_DARK_SQUARE = 3;
+const unsigned short COLOR_SELECTED = 4;
+const unsigned short COLOR_VALID_MOVE = 5;
+const unsigned short COLOR_BORDER = COLOR_BLACK;  // BORDER_COLOR 就是黑色
+const int CANVAS_COLOR_BITS = 8;
+#else
+const unsigned short COLOR_BLACK = RGB565_BLACK;
+const unsigned short COLOR_WHITE = RGB565_WHITE;
 const unsigned short COLOR_LIGHT_SQUARE = LIGHT_SQUARE_COLOR;
 const unsigned short COLOR_DARK_SQUARE = DARK_SQUARE_COLOR;
 const unsigned short COLOR_SELECTED = SELECTED_SQUARE_COLOR;
 const unsigned short COLOR_VALID_MOVE = VALID_MOVE_COLOR;
 const unsigned short COLOR_BORDER = BORDER_COLOR;
+const int CANVAS_COLOR_BITS = 16;
+#endif
+
+// 界面颜色的 RGB565 值，调色板的前几个下标
+const uint16_t CANVAS_UI_COLORS[] = {
+  RGB565_BLACK, RGB565_WHITE, LIGHT_SQUARE_COLOR, DARK_SQUARE_COLOR, SELECTED_SQUARE_COLOR, VALID_MOVE_COLOR
+};
+
+// 压缩的棋子图标，顺序同 pieceIconIndex()（兵马象车后王，先白后黑）
+const IconBitmap* const PIECE_BITMAPS[TILE_PIECES] = {
+  &WHITE_PAWN_ICON, &WHITE_KNIGHT_ICON, &WHITE_BISHOP_ICON, &WHITE_ROOK_ICON, &WHITE_QUEEN_ICON, &WHITE_KING_ICON,
+  &BLACK_PAWN_ICON, &BLACK_KNIGHT_ICON, &BLACK_BISHOP_ICON, &BLACK_ROOK_ICON, &BLACK_QUEEN_ICON, &BLACK_KING_ICON,
+};
 
 // 绘制棋盘
 void drawBoard(M5Canvas *canvas, const ChessBoard& board, bool isWhiteBottom);
@@ -38,6 +75,24 @@ void drawBoard(M5Canvas *canvas, const ChessBoard& board, bool isWhiteBottom);
 // 绘制棋子
 void drawPiece(M5Canvas *canvas, const Piece& piece, int x, int y);
 
+// 绘制一个图标（PIECE_WIDTH×PIECE_HEIGHT），透明色处不画
+void drawIcon(M5Canvas *canvas, const uint16_t* pixels, uint16_t transparent, int x, int y);
+
+// 解码棋子图标并画在 (x, y)，不做居中
+void drawPieceIcon(M5Canvas *canvas, const Piece& piece, int x, int y);
+
+// 解码全部棋子图标到 pixels，icons 指向其中各图标（启动时建调色板和图块用，用完即可释放）
+void decodePieceIcons(std::vector<uint16_t>& pixels, TileIcon icons[TILE_PIECES]);
+
+// 建立画布调色板（8位调色板画布在创建画布后调用一次）
+void buildCanvasPalette(M5Canvas *canvas, const TileIcon icons[TILE_PIECES]);
+
+// 合成棋子图块（启动时调用一次）
+void buildPieceTiles(const TileIcon icons[TILE_PIECES]);
+
+// 绘制一个格子：底色加上面的棋子（可以为空）
+void drawSquare(M5Canvas *canvas, const Piece& piece, int x, int y, TileBackground background);
+
 // 绘制选中的棋子
 void drawSelectedPiece(M5Canvas *canvas, const Position& pos, bool isWhiteBottom);
 
@@ -51,7 +106,13 @@ void drawTurnInfo(M5Canvas *canvas, Color currentPlayer);
 void drawPieceInfo(M5Canvas *canvas);
 
 // 绘制将军信息
-void drawCheckInfo(M5Canvas *canvas, bool isInCheck, Color color);
+void drawCheckInfo(M5Canvas *canvas, bool isInCheck, Color color, bool noMoves);
+
+// 将画布推送到屏幕（经 displayPipeline 异步发送，返回时传输可能还在进行）
+void pushCanvas(M5Canvas *canvas);
+
+// 只把画布上的一个矩形推送到屏幕
+void pushCanvasRect(M5Canvas *canvas, const DirtyRect& rect);
 
 // 坐标转换函数
 Position screenToBoard(int screenX, int screenY, bool isWhiteBottom);
@@ -61,11 +122,13 @@ void boardToScreen(const Position& pos, int& screenX, int& screenY, bool isWhite
 
 // 实现函数
 void drawBoard(M5Canvas *canvas, const ChessBoard& board, bool isWhiteBottom) {
+  PROFILE_ZONE(PROF_DRAW_BOARD);
+  
   // 绘制棋盘边框
   canvas->drawRect(BOARD_X - BOARD_PADDING, BOARD_Y - BOARD_PADDING, 
                    BOARD_WIDTH + 2 * BOARD_PADDING, BOARD_HEIGHT + 2 * BOARD_PADDING, COLOR_BORDER);
   
-  // 绘制棋盘格子
+  // 绘制棋盘格子和棋子，有子的格子是一次整块复制
   for (int y = 0; y < BOARD_SIZE; y++) {
     for (int x = 0; x < BOARD_SIZE; x++) {
       int screenX, screenY;
@@ -76,24 +139,99 @@ void drawBoard(M5Canvas *canvas, const ChessBoard& board, bool isWhiteBottom) {
       // a1 (x=0,y=0) 是黑色，h1 (x=7,y=0) 是白色（右下角）
       // 颜色计算不受屏幕旋转影响，保持固定的棋盘颜色分布
       bool isLightSquare = ((x + y) % 2 != 0);
-      unsigned short color = isLightSquare ? COLOR_LIGHT_SQUARE : COLOR_DARK_SQUARE;
-      
-      canvas->fillRect(screenX, screenY, SQUARE_SIZE, SQUARE_SIZE, color);
+      drawSquare(canvas, board.getPiece(x, y), screenX, screenY, isLightSquare ? TILE_LIGHT : TILE_DARK);
     }
   }
-  
-  // 绘制棋子
-  for (int y = 0; y < BOARD_SIZE; y++) {
-    for (int x = 0; x < BOARD_SIZE; x++) {
-      const Piece& piece = board.getPiece(x, y);
-      if (!piece.isEmpty()) {
-        int screenX, screenY;
-        // 使用正确的棋盘坐标绘制棋子
-        boardToScreen(Position(x, y), screenX, screenY, isWhiteBottom);
-        drawPiece(canvas, piece, screenX, screenY);
+}
+
+// 各底色对应的 RGB565 颜色和画布颜色，顺序同 TileBackground
+const uint16_t TILE_BACKGROUND_COLORS[TILE_BACKGROUND_COUNT] = {
+  LIGHT_SQUARE_COLOR, DARK_SQUARE_COLOR, SELECTED_SQUARE_COLOR, VALID_MOVE_COLOR
+};
+const unsigned short TILE_BACKGROUND_FILLS[TILE_BACKGROUND_COUNT] = {
+  COLOR_LIGHT_SQUARE, COLOR_DARK_SQUARE, COLOR_SELECTED, COLOR_VALID_MOVE
+};
+
+void decodePieceIcons(std::vector<uint16_t>& pixels, TileIcon icons[TILE_PIECES]) {
+  const int size = PIECE_WIDTH * PIECE_HEIGHT;
+  pixels.assign(TILE_PIECES * size, 0);
+  unsigned long start = micros();
+  for (int i = 0; i < TILE_PIECES; i++) {
+    if (!decodeIcon(*PIECE_BITMAPS[i], &pixels[i * size])) {
+      serialPrintf("[DRAW] Icon %d is corrupt\n", i);
+    }
+    icons[i].pixels = &pixels[i * size];
+    icons[i].transparent = PIECE_BITMAPS[i]->transparent;
+  }
+  unsigned long elapsed = micros() - start;
+  serialPrintf("[DRAW] Decoded %d icons in %lu us (%lu us each)\n", TILE_PIECES, elapsed, elapsed / TILE_PIECES);
+}
+
+void buildCanvasPalette(M5Canvas *canvas, const TileIcon icons[TILE_PIECES]) {
+  for (size_t i = 0; i < sizeof(CANVAS_UI_COLORS) / sizeof(CANVAS_UI_COLORS[0]); i++) {
+    canvasPalette.add(CANVAS_UI_COLORS[i]);
+  }
+  for (int i = 0; i < TILE_PIECES; i++) {
+    canvasPalette.addImage(icons[i].pixels, PIECE_WIDTH * PIECE_HEIGHT, icons[i].transparent);
+  }
+#if defined(CARDCHESS_PALETTE_CANVAS)
+  canvas->createPalette();
+  for (int i = 0; i < canvasPalette.getCount(); i++) {
+    uint8_t r, g, b;
+    CanvasPalette::toRGB888(canvasPalette.getColor(i), r, g, b);
+    canvas->setPaletteColor(i, r, g, b);
+  }
+  // 推屏时按下标查表得到屏幕字节序（高字节在前）的 RGB565
+  static uint16_t displayColors[256];
+  for (int i = 0; i < canvasPalette.getCount(); i++) {
+    uint16_t color = canvasPalette.getColor(i);
+    displayColors[i] = (uint16_t)((color >> 8) | (color << 8));
+  }
+  displayPipeline.setPalette(displayColors);
+#endif
+  serialPrintf("[DRAW] Canvas palette: %d colors\n", canvasPalette.getCount());
+}
+
+void buildPieceTiles(const TileIcon icons[TILE_PIECES]) {
+  static_assert(TILE_SIZE == SQUARE_SIZE, "tile size must match square size");
+#if defined(CARDCHESS_PALETTE_CANVAS)
+  pieceTiles.build(icons, PIECE_WIDTH, PIECE_HEIGHT, TILE_BACKGROUND_COLORS, &canvasPalette);
+#else
+  pieceTiles.build(icons, PIECE_WIDTH, PIECE_HEIGHT, TILE_BACKGROUND_COLORS);
+#endif
+}
+
+void drawSquare(M5Canvas *canvas, const Piece& piece, int x, int y, TileBackground background) {
+  const TilePixel* tile = pieceTiles.get(piece, background);
+  if (tile != nullptr) {
+#if defined(CARDCHESS_PALETTE_CANVAS)
+    // 图块已是调色板下标，按行直接复制进画布缓冲区（裁到画布的裁剪区域内，脏矩形重画依赖它）
+    int32_t clipX, clipY, clipW, clipH;
+    canvas->getClipRect(&clipX, &clipY, &clipW, &clipH);
+    blitTileClipped((TilePixel*)canvas->getBuffer(), canvas->width(), tile, x, y, clipX, clipY, clipW, clipH);
+#else
+    canvas->pushImage(x, y, TILE_SIZE, TILE_SIZE, tile);
+#endif
+    return;
+  }
+  canvas->fillRect(x, y, SQUARE_SIZE, SQUARE_SIZE, TILE_BACKGROUND_FILLS[background]);
+  drawPiece(canvas, piece, x, y);
+}
+
+void drawIcon(M5Canvas *canvas, const uint16_t* pixels, uint16_t transparent, int x, int y) {
+#if defined(CARDCHESS_PALETTE_CANVAS)
+  // 调色板画布逐点按下标画，只用于开始界面和图块缓存建好之前
+  for (int row = 0; row < PIECE_HEIGHT; row++) {
+    for (int col = 0; col < PIECE_WIDTH; col++) {
+      uint16_t pixel = pixels[row * PIECE_WIDTH + col];
+      if (pixel != transparent) {
+        canvas->drawPixel(x + col, y + row, canvasPalette.indexOf(pixel));
       }
     }
   }
+#else
+  canvas->pushImage(x, y, PIECE_WIDTH, PIECE_HEIGHT, (uint16_t*)pixels, transparent);
+#endif
 }
 
 void drawPiece(M5Canvas *canvas, const Piece& piece, int x, int y) {
@@ -105,39 +243,18 @@ void drawPiece(M5Canvas *canvas, const Piece& piece, int x, int y) {
   int pieceX = x + (SQUARE_SIZE - PIECE_WIDTH) / 2;
   int pieceY = y + (SQUARE_SIZE - PIECE_HEIGHT) / 2;
   
-  const unsigned short* bmpData = nullptr;
-  
-  switch (piece.type) {
-    case PAWN:
-      bmpData = (piece.color == Color::WHITE) ? whitePawnData : blackPawnData;
-      break;
-    case KNIGHT:
-      bmpData = (piece.color == Color::WHITE) ? whiteKnightData : blackKnightData;
-      break;
-    case BISHOP:
-      bmpData = (piece.color == Color::WHITE) ? whiteBishopData : blackBishopData;
-      break;
-    case ROOK:
-      bmpData = (piece.color == Color::WHITE) ? whiteRookData : blackRookData;
-      break;
-    case QUEEN:
-      bmpData = (piece.color == Color::WHITE) ? whiteQueenData : blackQueenData;
-      break;
-    case KING:
-      bmpData = (piece.color == Color::WHITE) ? whiteKingData : blackKingData;
-      break;
-    default:
-      return;
+  drawPieceIcon(canvas, piece, pieceX, pieceY);
+}
+
+void drawPieceIcon(M5Canvas *canvas, const Piece& piece, int x, int y) {
+  if (piece.isEmpty()) {
+    return;
   }
-  
-  if (bmpData != nullptr) {
-    if (piece.color == Color::BLACK) {
-      // 黑棋：黑色填充棋子形状，背景透明
-      canvas->pushImage(pieceX, pieceY, PIECE_WIDTH, PIECE_HEIGHT, (uint16_t*)bmpData, COLOR_WHITE);
-    } else {
-      // 白棋：白色填充棋子形状，黑色边框，背景透明
-      canvas->pushImage(pieceX, pieceY, PIECE_WIDTH, PIECE_HEIGHT, (uint16_t*)bmpData, COLOR_BLACK);
-    }
+  // 黑棋：黑色填充棋子形状；白棋：白色填充棋子形状，黑色边框；背景透明
+  const IconBitmap& bitmap = *PIECE_BITMAPS[pieceIconIndex(piece)];
+  uint16_t pixels[PIECE_WIDTH * PIECE_HEIGHT];
+  if (decodeIcon(bitmap, pixels)) {
+    drawIcon(canvas, pixels, bitmap.transparent, x, y);
   }
 }
 
@@ -220,9 +337,15 @@ void drawPieceInfo(M5Canvas *canvas) {
   }
 }
 
-void drawCheckInfo(M5Canvas *canvas, bool isInCheck, Color color) {
-  if (isInCheck) {
-    const char* checkText = (color == Color::WHITE) ? "White is in check!" : "Black is in check!";
+// noMoves：color 方走棋且没有合法走法，被将军时是将死，否则是逼和
+void drawCheckInfo(M5Canvas *canvas, bool isInCheck, Color color, bool noMoves) {
+  if (isInCheck || noMoves) {
+    const char* checkText;
+    if (noMoves) {
+      checkText = !isInCheck ? "Stalemate, draw!" : (color == Color::WHITE) ? "Checkmate, Black wins!" : "Checkmate, White wins!";
+    } else {
+      checkText = (color == Color::WHITE) ? "White is in check!" : "Black is in check!";
+    }
     int textWidth = canvas->textWidth(checkText);
     int textX = canvas->width() - textWidth - 10;
     int textY = 1;
@@ -233,6 +356,27 @@ void drawCheckInfo(M5Canvas *canvas, bool isInCheck, Color color) {
   }
 }
 
+void pushCanvas(M5Canvas *canvas) {
+  PROFILE_ZONE(PROF_PUSH_SPRITE);
+  DirtyRect screen = {0, 0, (int16_t)canvas->width(), (int16_t)canvas->height()};
+  if (!displayPipeline.present(canvas->getBuffer(), canvas->width(), screen)) {
+    canvas->pushSprite(0, 0);
+  }
+  // 整屏推送的可能是别的界面，游戏界面下一帧要整屏重画
+  gameScreenDamage.invalidate();
+}
+
+void pushCanvasRect(M5Canvas *canvas, const DirtyRect& rect) {
+  PROFILE_ZONE(PROF_PUSH_SPRITE);
+  if (displayPipeline.present(canvas->getBuffer(), canvas->width(), rect)) {
+    return;
+  }
+  // 没有异步推屏时同步推送，屏幕的裁剪区域限制了 pushSprite 实际发送的像素
+  M5Cardputer.Display.setClipRect(rect.x, rect.y, rect.w, rect.h);
+  canvas->pushSprite(0, 0);
+  M5Cardputer.Display.clearClipRect();
+}
+
 Position screenToBoard(int screenX, int screenY, bool isWhiteBottom) {
   int boardX = screenX - BOARD_X;
   int boardY = screenY - BOARD_Y;
@@ -1,8 +1,9 @@
 #include "common.h"
+#include "engine.h"
+#include "profiler.h"
 #include <vector>
 #include <algorithm> // std::max, std::min
-#include <cstdlib>   // rand(), srand()
-#include <ctime>     // time()
+#include <stdint.h>
 
 // ==========================================
 // 1. 基础结构与配置
@@ -17,6 +18,24 @@ struct ScoredMove {
     ScoredMove(Move m, int s) : move(m), score(s) {}
 };
 
+SearchContext::SearchContext(uint32_t seed) : nodes(0), randomState(0) {
+    seedRandom(seed);
+}
+
+void SearchContext::seedRandom(uint32_t seed) {
+    randomState = seed != 0 ? seed : 0x9E3779B9u; // xorshift 状态不能为0
+}
+
+// xorshift32
+uint32_t SearchContext::nextRandom() {
+    uint32_t x = randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    randomState = x;
+    return x;
+}
+
 // ==========================================
 // 位置价值表 (Piece-Square Tables)
 // ==========================================
@@ -72,6 +91,7 @@ int getPositionBonus(const Piece& piece, int x, int y) {
 
 // 评估函数
 int evaluateBoard(const ChessBoard& board, Color side) {
+    PROFILE_ZONE(PROF_EVALUATE_BOARD);
     int score = 0;
     for (int y = 0; y < 8; y++) {
         for (int x = 0; x < 8; x++) {
@@ -94,11 +114,12 @@ std::vector<Move> getAllValidMoves(const ChessBoard& board, Color side) {
             Position from(x, y);
             const Piece& piece = board.getPiece(from);
             if (!piece.isEmpty() && piece.color == side) {
-                ChessBoard temp = board;
-                if (temp.selectPiece(from)) {
-                    const std::vector<Position>& valid = temp.getValidMoves();
-                    for (const Position& to : valid) {
-                        moves.push_back(Move(from, to));
+                // 读棋盘的合法走法缓存（每个局面只生成一次），不再为每个棋子复制棋盘；
+                // 目标格按 y、x 顺序给出，与逐格检查时的顺序相同
+                uint64_t targets = board.getLegalTargets(from);
+                for (int square = 0; targets != 0; square++, targets >>= 1) {
+                    if (targets & 1) {
+                        moves.push_back(Move(from, Position(square % 8, square / 8)));
                     }
                 }
             }
@@ -111,7 +132,10 @@ std::vector<Move> getAllValidMoves(const ChessBoard& board, Color side) {
 // 3. Minimax 核心算法
 // ==========================================
 
-int minimax(ChessBoard board, int depth, int alpha, int beta, bool isMaximizing, Color myColor) {
+// 局面按引用传入，每层只在栈上复制一份子局面（ChessBoard 带合法走法缓存，约1.1KB）
+
+int minimax(const ChessBoard& board, int depth, int alpha, int beta, bool isMaximizing, Color myColor, SearchContext& context) {
+    context.nodes++;
     if (depth == 0) return evaluateBoard(board, myColor);
 
     Color currentPlayer = isMaximizing ? myColor : (myColor == WHITE ? BLACK : WHITE);
@@ -126,8 +150,8 @@ int minimax(ChessBoard board, int depth, int alpha, int beta, bool isMaximizing,
         int maxEval = -1000000;
         for (const Move& move : allMoves) {
             ChessBoard tempBoard = board;
-            tempBoard.movePiece(move.from, move.to);
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, false, myColor);
+            tempBoard.makeMove(move);
+            int eval = minimax(tempBoard, depth - 1, alpha, beta, false, myColor, context);
             maxEval = std::max(maxEval, eval);
             alpha = std::max(alpha, eval);
             if (beta <= alpha) break;
@@ -137,8 +161,8 @@ int minimax(ChessBoard board, int depth, int alpha, int beta, bool isMaximizing,
         int minEval = 1000000;
         for (const Move& move : allMoves) {
             ChessBoard tempBoard = board;
-            tempBoard.movePiece(move.from, move.to);
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, true, myColor);
+            tempBoard.makeMove(move);
+            int eval = minimax(tempBoard, depth - 1, alpha, beta, true, myColor, context);
             minEval = std::min(minEval, eval);
             beta = std::min(beta, eval);
             if (beta <= alpha) break;
@@ -148,41 +172,89 @@ int minimax(ChessBoard board, int depth, int alpha, int beta, bool isMaximizing,
 }
 
 // ==========================================
-// 4. AI 入口函数 (已加入随机性逻辑)
+// 4. 根节点打分
 // ==========================================
 
-Move chooseAIMove(Color side, const ChessBoard& board) {
-    // 静态变量确保只初始化一次随机种子
-    static bool seeded = false;
-    if (!seeded) {
-        srand(time(NULL));
-        seeded = true;
-    }
-
+// 对side方的每个第一步走法打分，返回最高分
+static int scoreRootMoves(const ChessBoard& board, Color side, int depth, SearchContext& context,
+                          std::vector<ScoredMove>& moveScores) {
+    // 搜索中的走子不输出日志（只静音当前任务，不影响界面线程）
+    SerialLogMute mute;
     std::vector<Move> allMoves = getAllValidMoves(board, side);
-    if (allMoves.empty()) return Move(Position(-1, -1), Position(-1, -1));
-
-    // 搜索深度
-    // 搜索深度设为3层，评估速度更快，同时也能保持一定的棋力。4耗时有点久，5会重启
-    const int SEARCH_DEPTH = 3;
-    
-    // 存储所有走法及其评分
-    std::vector<ScoredMove> moveScores;
     int maxScore = -1000000;
 
-    // 1. 对每个第一步走法进行打分
     for (const Move& move : allMoves) {
         ChessBoard tempBoard = board;
-        tempBoard.movePiece(move.from, move.to);
+        tempBoard.makeMove(move);
         
         // 计算分值
-        int score = minimax(tempBoard, SEARCH_DEPTH - 1, -1000000, 1000000, false, side);
+        int score = minimax(tempBoard, depth - 1, -1000000, 1000000, false, side, context);
         
         moveScores.push_back(ScoredMove(move, score));
         if (score > maxScore) {
             maxScore = score;
         }
     }
+    return maxScore;
+}
+
+Move searchBestMove(const ChessBoard& board, Color side, int depth, SearchContext& context, SearchInfo* info) {
+    unsigned long startTime = millis();
+    context.nodes = 0;
+
+    std::vector<ScoredMove> moveScores;
+    int maxScore = scoreRootMoves(board, side, depth, context, moveScores);
+
+    // 取第一个最高分走法，保证结果可复现
+    Move best(Position(-1, -1), Position(-1, -1));
+    for (const auto& sm : moveScores) {
+        if (sm.score == maxScore) {
+            best = sm.move;
+            break;
+        }
+    }
+
+    if (info != nullptr) {
+        info->nodes = context.nodes;
+        info->timeMs = millis() - startTime;
+        info->score = moveScores.empty() ? 0 : maxScore;
+    }
+    return best;
+}
+
+unsigned long perft(const ChessBoard& board, int depth) {
+    if (depth == 0) return 1;
+    SerialLogMute mute;
+    MoveList list;
+    board.generateLegalMoves(list);
+    if (depth == 1) return list.count;
+
+    unsigned long nodes = 0;
+    for (int i = 0; i < list.count; i++) {
+        ChessBoard tempBoard = board;
+        tempBoard.makeMove(list[i]);
+        nodes += perft(tempBoard, depth - 1);
+    }
+    return nodes;
+}
+
+// ==========================================
+// 5. AI 入口函数 (已加入随机性逻辑)
+// ==========================================
+
+Move pickAIMove(const ChessBoard& board, Color side, int depth, SearchContext& context, SearchInfo* info) {
+    unsigned long startTime = millis();
+    context.nodes = 0;
+
+    // 1. 对每个第一步走法进行打分
+    std::vector<ScoredMove> moveScores;
+    int maxScore = scoreRootMoves(board, side, depth, context, moveScores);
+    if (info != nullptr) {
+        info->nodes = context.nodes;
+        info->timeMs = millis() - startTime;
+        info->score = moveScores.empty() ? 0 : maxScore;
+    }
+    if (moveScores.empty()) return Move(Position(-1, -1), Position(-1, -1));
 
     // 2. 筛选出“好棋” (Candidates)
     // 策略：如果一个走法的分数在 [最高分 - 容差] 范围内，就算作候选走法
@@ -199,10 +271,16 @@ Move chooseAIMove(Color side, const ChessBoard& board) {
 
     // 3. 从候选走法中随机选择一个
     if (!bestCandidates.empty()) {
-        int randomIndex = rand() % bestCandidates.size();
+        int randomIndex = context.nextRandom() % bestCandidates.size();
         return bestCandidates[randomIndex];
     }
 
     // 兜底（理论上不会执行到这里）
-    return allMoves[0];
-}
\ No newline at end of file
+    return moveScores[0].move;
+}
+
+Move chooseAIMove(Color side, const ChessBoard& board, SearchContext& context) {
+    // 搜索深度设为3层，评估速度更快，同时也能保持一定的棋力。4耗时有点久，5会重启
+    const int SEARCH_DEPTH = 3;
+    return pickAIMove(board, side, SEARCH_DEPTH, context, nullptr);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "common.h"
+#include <stdint.h>
+#include <vector>
+
+// 搜索统计信息
+struct SearchInfo {
+  unsigned long nodes;   // 访问的节点数（每次minimax调用计一个）
+  unsigned long timeMs;  // 搜索耗时
+  int score;             // 最佳走法的分数（走棋方视角）
+
+  SearchInfo() : nodes(0), timeMs(0), score(0) {}
+};
+
+// 一次搜索用到的可变状态：节点计数和AI随机选择用的随机数（xorshift32）
+// 每个任务各持一份（AI任务、bench、UCI），同时搜索时互不干扰；固定种子即可复现AI的选择
+struct SearchContext {
+  unsigned long nodes;   // 本次搜索访问的节点数（每次minimax调用加一）
+  uint32_t randomState;
+
+  explicit SearchContext(uint32_t seed = 0);
+
+  // 设置随机数种子（设备启动时用硬件随机数，bench 用固定种子）
+  void seedRandom(uint32_t seed);
+  uint32_t nextRandom();
+};
+
+// 局面评估（side方视角）
+int evaluateBoard(const ChessBoard& board, Color side);
+
+// 获取side方的所有合法走法
+std::vector<Move> getAllValidMoves(const ChessBoard& board, Color side);
+
+// 固定深度搜索，返回分数最高的走法（确定性，不含随机选择）
+Move searchBestMove(const ChessBoard& board, Color side, int depth, SearchContext& context, SearchInfo* info);
+
+// 走法生成校验：统计depth层的叶子节点数
+unsigned long perft(const ChessBoard& board, int depth);
+
+// 在接近最高分的候选走法中随机选择（depth层搜索）
+Move pickAIMove(const ChessBoard& board, Color side, int depth, SearchContext& context, SearchInfo* info);
+
+// 游戏AI入口：固定深度调用 pickAIMove
+Move chooseAIMove(Color side, const ChessBoard& board, SearchContext& context);
@@ -0,0 +1,179 @@
+#include "game_journal.h"
+
+namespace {
+
+// 顺序读取日志的小缓冲区，避免每条3字节记录都单独读一次SD卡
+struct JournalReader {
+  BlockFile* file;
+  uint32_t offset;   // 下一个未读字节在文件中的偏移
+  uint32_t fileSize;
+  uint8_t buffer[64];
+  uint8_t pos;
+  uint8_t len;
+
+  JournalReader(BlockFile* blockFile, uint32_t start)
+      : file(blockFile), offset(start), fileSize(blockFile->size()), pos(0), len(0) {
+    file->seek(start);
+  }
+
+  bool read(uint8_t* out, size_t size) {
+    if (offset + size > fileSize) {
+      return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+      if (pos == len) {
+        len = (uint8_t)file->read(buffer, sizeof(buffer));
+        pos = 0;
+        if (len == 0) {
+          return false;
+        }
+      }
+      out[i] = buffer[pos++];
+    }
+    offset += size;
+    return true;
+  }
+};
+
+// 读取一条记录（不含CRC字节的长度写入 bodySize），CRC不符或数据不完整时返回false
+bool readRecord(JournalReader& reader, uint8_t seed, uint8_t* record, size_t& bodySize) {
+  if (!reader.read(record, 2)) {
+    return false;
+  }
+  bodySize = readLE16(record) == JOURNAL_CHECKPOINT_TAG ? JOURNAL_CHECKPOINT_SIZE - 1 : JOURNAL_MOVE_SIZE - 1;
+  if (!reader.read(record + 2, bodySize - 1)) {
+    return false;
+  }
+  return crc8(record, bodySize, seed) == record[bodySize];
+}
+
+size_t encodeCheckpoint(const ChessBoard& board, uint8_t flags, uint8_t* out) {
+  writeLE16(out, JOURNAL_CHECKPOINT_TAG);
+  packPosition(board, out + 2);
+  uint8_t* p = out + 2 + PUZZLE_POSITION_BYTES;
+  writeLE16(p, board.getHalfmoveClock());
+  writeLE16(p + 2, board.getFullmoveNumber());
+  p[4] = flags;
+  return JOURNAL_CHECKPOINT_SIZE - 1;
+}
+
+}  // namespace
+
+bool GameJournal::start(BlockFile* blockFile, const ChessBoard& board, uint8_t flags) {
+  close();
+  uint8_t header[GAME_JOURNAL_HEADER_SIZE];
+  memset(header, 0, sizeof(header));
+  memcpy(header, GAME_JOURNAL_MAGIC, 4);
+  writeLE16(header + 4, GAME_JOURNAL_VERSION);
+  if (!blockFile->writeAt(0, header, sizeof(header))) {
+    return false;
+  }
+  file = blockFile;
+  end = GAME_JOURNAL_HEADER_SIZE;
+  lastCrc = 0;
+  tornTail = false;
+  if (!appendCheckpoint(board, flags)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool GameJournal::recover(BlockFile* blockFile, ChessBoard& board, uint8_t& flags) {
+  close();
+  uint8_t header[GAME_JOURNAL_HEADER_SIZE];
+  if (!blockFile->readAt(0, header, sizeof(header)) || memcmp(header, GAME_JOURNAL_MAGIC, 4) != 0 ||
+      readLE16(header + 4) != GAME_JOURNAL_VERSION) {
+    serialPrintln("[SD] Not a game journal or unsupported version");
+    return false;
+  }
+
+  // 第一遍只校验CRC链，记下最后一个检查点的位置和它之前那条记录的CRC
+  uint8_t record[JOURNAL_CHECKPOINT_SIZE];
+  size_t bodySize;
+  uint32_t checkpointOffset = 0;
+  uint8_t checkpointSeed = 0;
+  uint8_t crc = 0;
+  JournalReader scan(blockFile, GAME_JOURNAL_HEADER_SIZE);
+  while (true) {
+    uint32_t offset = scan.offset;
+    if (!readRecord(scan, crc, record, bodySize)) {
+      break;
+    }
+    if (bodySize == JOURNAL_CHECKPOINT_SIZE - 1) {
+      checkpointOffset = offset;
+      checkpointSeed = crc;
+    }
+    crc = record[bodySize];
+  }
+  if (checkpointOffset == 0) {
+    serialPrintln("[SD] Game journal has no valid checkpoint");
+    return false;
+  }
+
+  // 第二遍从检查点重放，非法走法视为日志到此为止；重放期间关闭走子日志
+  JournalReader replay(blockFile, checkpointOffset);
+  readRecord(replay, checkpointSeed, record, bodySize);
+  const uint8_t* p = record + 2 + PUZZLE_POSITION_BYTES;
+  bool ok = unpackPosition(record + 2, board, readLE16(p), readLE16(p + 2));
+  flags = p[4];
+  crc = record[bodySize];
+  uint32_t validEnd = replay.offset;
+  uint16_t moves = 0;
+  while (ok && readRecord(replay, crc, record, bodySize)) {
+    SerialLogMute mute;
+    if (!board.makeMove(unpackMove(readLE16(record)))) {
+      break;
+    }
+    crc = record[bodySize];
+    validEnd = replay.offset;
+    moves++;
+  }
+  if (!ok) {
+    serialPrintln("[SD] Game journal checkpoint is not a valid position");
+    return false;
+  }
+
+  file = blockFile;
+  end = validEnd;
+  lastCrc = crc;
+  sinceCheckpoint = moves;
+  tornTail = blockFile->size() > validEnd;
+  serialPrintf("[SD] Game journal recovered: %u moves after checkpoint%s\n",
+               (unsigned)moves, tornTail ? ", torn tail dropped" : "");
+  return true;
+}
+
+bool GameJournal::append(const uint8_t* record, size_t size) {
+  if (file == nullptr || !file->writeAt(end, record, size)) {
+    return false;
+  }
+  file->flush();
+  end += size;
+  lastCrc = record[size - 1];
+  return true;
+}
+
+bool GameJournal::appendMove(const Move& move, const ChessBoard& board, uint8_t flags) {
+  uint8_t record[JOURNAL_MOVE_SIZE];
+  writeLE16(record, packMove(move));
+  record[2] = crc8(record, 2, lastCrc);
+  if (!append(record, sizeof(record))) {
+    return false;
+  }
+  if (++sinceCheckpoint >= JOURNAL_CHECKPOINT_INTERVAL) {
+    return appendCheckpoint(board, flags);
+  }
+  return true;
+}
+
+bool GameJournal::appendCheckpoint(const ChessBoard& board, uint8_t flags) {
+  uint8_t record[JOURNAL_CHECKPOINT_SIZE];
+  size_t bodySize = encodeCheckpoint(board, flags, record);
+  record[bodySize] = crc8(record, bodySize, lastCrc);
+  if (!append(record, sizeof(record))) {
+    return false;
+  }
+  sinceCheckpoint = 0;
+  return true;
+}
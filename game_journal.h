@@ -0,0 +1,52 @@
+#pragma once
+#include "block_file.h"
+#include "puzzle.h"
+
+// 对局日志：只追加写入，每步棋只写3字节，断电时最多丢失正在写的那一条记录（整数均为小端）
+//   文件头（8字节）：魔数 "CCGJ"，uint16 版本，uint16 保留
+//   走法记录（3字节）：uint16 打包走法（见 packMove），CRC8
+//   检查点（42字节）：uint16 0xFFFF，打包局面，uint16 半回合计数，uint16 回合数，uint8 标志，CRC8
+// 每条记录的CRC8以前一条记录的CRC为初值（第一条为0），中间丢失或错位的记录无法通过校验；
+// 文件以检查点开始，之后每 JOURNAL_CHECKPOINT_INTERVAL 步再写一个，恢复时从最后一个有效检查点重放
+const uint8_t GAME_JOURNAL_MAGIC[4] = {'C', 'C', 'G', 'J'};
+const uint16_t GAME_JOURNAL_VERSION = 1;
+const int GAME_JOURNAL_HEADER_SIZE = 8;
+const uint16_t JOURNAL_CHECKPOINT_TAG = 0xFFFF;
+const int JOURNAL_MOVE_SIZE = 3;
+const int JOURNAL_CHECKPOINT_SIZE = 2 + PUZZLE_POSITION_BYTES + 2 + 2 + 1 + 1;
+const int JOURNAL_CHECKPOINT_INTERVAL = 32;
+
+// 检查点标志位
+const uint8_t JOURNAL_FLAG_WHITE_PLAYER = 0x01;
+
+class GameJournal {
+private:
+  BlockFile* file;
+  uint32_t end;         // 最后一条有效记录之后的偏移，新记录写在这里
+  uint8_t lastCrc;      // 最后一条有效记录的CRC，作为下一条的初值
+  uint16_t sinceCheckpoint;
+  bool tornTail;        // 恢复时有效记录之后还有残缺数据
+
+  bool append(const uint8_t* record, size_t size);
+
+public:
+  GameJournal() : file(nullptr), end(0), lastCrc(0), sinceCheckpoint(0), tornTail(false) {}
+
+  // 写入文件头和初始检查点，文件需为空（由调用者新建）
+  bool start(BlockFile* blockFile, const ChessBoard& board, uint8_t flags);
+
+  // 从已有日志恢复局面：扫描校验CRC链找到最后一个检查点，再重放其后的走法，
+  // 遇到校验失败或非法走法即停止；没有有效检查点时返回false
+  bool recover(BlockFile* blockFile, ChessBoard& board, uint8_t& flags);
+
+  // board 为走完这一步之后的局面，到间隔步数时顺带写一个检查点
+  bool appendMove(const Move& move, const ChessBoard& board, uint8_t flags);
+  bool appendCheckpoint(const ChessBoard& board, uint8_t flags);
+
+  void close() { file = nullptr; }
+  bool isOpen() const { return file != nullptr; }
+
+  // 有效数据长度，以及恢复时是否发现了残缺的尾部（此时应新建日志，避免旧数据残留在新记录之后）
+  uint32_t size() const { return end; }
+  bool hasTornTail() const { return tornTail; }
+};
@@ -0,0 +1,87 @@
+#include "game_record.h"
+
+void GameRecord::saveKeyframe(Keyframe& keyframe, const ChessBoard& board) {
+  packPosition(board, keyframe.position);
+  keyframe.halfmove = board.getHalfmoveClock();
+  keyframe.fullmove = board.getFullmoveNumber();
+}
+
+void GameRecord::reset(const ChessBoard& board) {
+  current = 0;
+  total = 0;
+  saveKeyframe(keyframes[0], board);
+}
+
+bool GameRecord::push(const Move& move, const ChessBoard& board) {
+  if (current >= GAME_RECORD_MAX_PLIES) {
+    serialPrintln("[GAME] History full, move not recorded");
+    return false;
+  }
+  UndoInfo info = board.getLastUndoInfo();
+  Ply& ply = plies[current];
+  ply.move = packMove(move);
+  ply.captured = info.captured.isEmpty() ? 0 : (uint8_t)(info.captured.type | (info.captured.color == BLACK ? 8 : 0));
+  ply.castling = info.castlingRights;
+  ply.enPassant = info.enPassant.isValid() ? (uint8_t)(info.enPassant.y * 8 + info.enPassant.x) : 0xFF;
+  ply.halfmove = info.halfmoveClock;
+  current++;
+  total = current;
+  if (current % GAME_RECORD_KEYFRAME_INTERVAL == 0) {
+    saveKeyframe(keyframes[current / GAME_RECORD_KEYFRAME_INTERVAL], board);
+  }
+  return true;
+}
+
+bool GameRecord::undoOne(ChessBoard& board) {
+  if (current == 0) {
+    return false;
+  }
+  const Ply& ply = plies[--current];
+  UndoInfo info;
+  info.captured = ply.captured == 0 ? Piece() : Piece((PieceType)(ply.captured & 7), (ply.captured & 8) ? BLACK : WHITE);
+  info.castlingRights = ply.castling;
+  info.enPassant = ply.enPassant < 64 ? Position(ply.enPassant % 8, ply.enPassant / 8) : Position(-1, -1);
+  info.halfmoveClock = ply.halfmove;
+  board.unmakeMove(unpackMove(ply.move), info);
+  return true;
+}
+
+bool GameRecord::redoOne(ChessBoard& board) {
+  if (current >= total) {
+    return false;
+  }
+  // 重放时关闭走子日志
+  bool ok;
+  {
+    SerialLogMute mute;
+    ok = board.makeMove(unpackMove(plies[current].move));
+  }
+  if (ok) {
+    current++;
+  }
+  return ok;
+}
+
+bool GameRecord::seek(ChessBoard& board, int ply) {
+  if (ply < 0 || ply > total) {
+    return false;
+  }
+  int distance = ply > current ? ply - current : current - ply;
+  int keyframe = ply / GAME_RECORD_KEYFRAME_INTERVAL;
+  if (distance > ply % GAME_RECORD_KEYFRAME_INTERVAL) {
+    const Keyframe& frame = keyframes[keyframe];
+    if (!unpackPosition(frame.position, board, frame.halfmove, frame.fullmove)) {
+      return false;
+    }
+    current = keyframe * GAME_RECORD_KEYFRAME_INTERVAL;
+  }
+  while (current > ply) {
+    undoOne(board);
+  }
+  while (current < ply) {
+    if (!redoOne(board)) {
+      return false;
+    }
+  }
+  return true;
+}
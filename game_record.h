@@ -0,0 +1,56 @@
+#pragma once
+#include "puzzle.h"
+
+// 对局记录：全部走法及每步的撤销状态，支持任意多步悔棋/重做和回放跳转
+//   每步：打包走法 + 走子前的被吃棋子、易位权、吃过路兵格、半回合计数（8字节）
+//   关键帧：每 GAME_RECORD_KEYFRAME_INTERVAL 步保存一次打包局面，
+//   跳到任意一步时从最近的关键帧出发，最多重放 GAME_RECORD_KEYFRAME_INTERVAL-1 步
+// 固定大小，不占用堆内存；超出 GAME_RECORD_MAX_PLIES 后不再记录新走法
+const int GAME_RECORD_MAX_PLIES = 512;
+const int GAME_RECORD_KEYFRAME_INTERVAL = 16;
+
+class GameRecord {
+private:
+  struct Ply {
+    uint16_t move;        // packMove 格式，升变走法带升变棋子
+    uint8_t captured;     // 被吃棋子的4位编码（同打包局面），0 为无
+    uint8_t castling;     // 走子前的易位权
+    uint8_t enPassant;    // 走子前的吃过路兵格序号，无则0xFF
+    uint16_t halfmove;    // 走子前的半回合计数
+  };
+  struct Keyframe {
+    uint8_t position[PUZZLE_POSITION_BYTES];
+    uint16_t halfmove;
+    uint16_t fullmove;
+  };
+
+  Ply plies[GAME_RECORD_MAX_PLIES];
+  Keyframe keyframes[GAME_RECORD_MAX_PLIES / GAME_RECORD_KEYFRAME_INTERVAL + 1];
+  int current;  // 棋盘当前处在第几步之后
+  int total;    // 已记录的步数，current < total 时可以重做
+
+  static void saveKeyframe(Keyframe& keyframe, const ChessBoard& board);
+  bool undoOne(ChessBoard& board);
+  bool redoOne(ChessBoard& board);
+
+public:
+  GameRecord() : current(0), total(0) {}
+
+  // 以 board 的当前局面作为第0步，清空记录
+  void reset(const ChessBoard& board);
+
+  // 记录刚在 board 上走完的一步（撤销状态取自 board.getLastUndoInfo()），会丢弃可重做的走法
+  bool push(const Move& move, const ChessBoard& board);
+
+  int getPly() const { return current; }
+  int getTotal() const { return total; }
+  Move getMove(int ply) const { return unpackMove(plies[ply].move); }
+
+  bool canUndo() const { return current > 0; }
+  bool canRedo() const { return current < total; }
+  bool undo(ChessBoard& board) { return undoOne(board); }
+  bool redo(ChessBoard& board) { return redoOne(board); }
+
+  // 跳到第 ply 步之后的局面：距离不超过一个关键帧间隔时逐步撤销/重做，否则从关键帧重放
+  bool seek(ChessBoard& board, int ply);
+};
@@ -0,0 +1,146 @@
+#pragma once
+// 主机（Linux）构建用的最小 Arduino 兼容层
+// 只实现 common.cpp / engine.cpp 等核心代码用到的 String、Serial、millis、random 等接口，
+// 设备固件仍使用 PlatformIO 提供的真实 Arduino 框架。
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+
+// ==========================================
+// String（基于 std::string 的子集实现）
+// ==========================================
+class String {
+public:
+  String() {}
+  String(const char* s) : str(s ? s : "") {}
+  String(const std::string& s) : str(s) {}
+  explicit String(char c) : str(1, c) {}
+  explicit String(int value) : str(std::to_string(value)) {}
+  explicit String(unsigned int value) : str(std::to_string(value)) {}
+  explicit String(long value) : str(std::to_string(value)) {}
+  explicit String(unsigned long value) : str(std::to_string(value)) {}
+
+  unsigned int length() const { return str.length(); }
+  bool isEmpty() const { return str.empty(); }
+  const char* c_str() const { return str.c_str(); }
+  void reserve(unsigned int size) { str.reserve(size); }
+
+  char operator[](unsigned int index) const { return index < str.length() ? str[index] : '\0'; }
+  char& operator[](unsigned int index) { return str[index]; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  String& operator+=(const String& other) { str += other.str; return *this; }
+  String& operator+=(const char* other) { str += other; return *this; }
+  String& operator+=(char c) { str += c; return *this; }
+  String& operator+=(int value) { str += std::to_string(value); return *this; }
+  String& operator+=(unsigned long value) { str += std::to_string(value); return *this; }
+  bool concat(const String& other) { str += other.str; return true; }
+
+  bool equals(const String& other) const { return str == other.str; }
+  bool equals(const char* other) const { return str == other; }
+  bool operator==(const String& other) const { return str == other.str; }
+  bool operator==(const char* other) const { return str == other; }
+  bool operator!=(const String& other) const { return str != other.str; }
+  bool operator!=(const char* other) const { return str != other; }
+  bool operator<(const String& other) const { return str < other.str; }
+
+  bool startsWith(const String& prefix) const { return str.compare(0, prefix.str.length(), prefix.str) == 0; }
+  bool endsWith(const String& suffix) const {
+    return str.length() >= suffix.str.length() &&
+           str.compare(str.length() - suffix.str.length(), suffix.str.length(), suffix.str) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { return toIndex(str.find(c, from)); }
+  int indexOf(const String& s, unsigned int from = 0) const { return toIndex(str.find(s.str, from)); }
+  int lastIndexOf(char c) const { return toIndex(str.rfind(c)); }
+
+  String substring(unsigned int begin) const { return begin < str.length() ? String(str.substr(begin)) : String(); }
+  String substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) { unsigned int t = begin; begin = end; end = t; }
+    if (begin >= str.length()) return String();
+    return String(str.substr(begin, end - begin));
+  }
+
+  void trim() {
+    size_t b = 0;
+    while (b < str.length() && isspace((unsigned char)str[b])) b++;
+    size_t e = str.length();
+    while (e > b && isspace((unsigned char)str[e - 1])) e--;
+    str = str.substr(b, e - b);
+  }
+  void toLowerCase() { for (size_t i = 0; i < str.length(); i++) str[i] = tolower((unsigned char)str[i]); }
+  void toUpperCase() { for (size_t i = 0; i < str.length(); i++) str[i] = toupper((unsigned char)str[i]); }
+  long toInt() const { return atol(str.c_str()); }
+
+private:
+  std::string str;
+  static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b) { String r(a); r += b; return r; }
+
+// ==========================================
+// Serial（输出到 stdout，不支持输入）
+// ==========================================
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  int available() { return 0; }
+  int read() { return -1; }
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+
+  size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+
+  size_t print(const String& s) { return fputs(s.c_str(), stdout) < 0 ? 0 : s.length(); }
+  size_t print(const char* s) { return fputs(s, stdout) < 0 ? 0 : strlen(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value) { return printf("%d", value); }
+  size_t print(unsigned int value) { return printf("%u", value); }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(unsigned long value) { return printf("%lu", value); }
+
+  size_t println() { size_t n = print("\n"); fflush(stdout); return n; }
+  template <typename T>
+  size_t println(const T& value) { size_t n = print(value); return n + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(stdout, format, args);
+    va_end(args);
+    return n < 0 ? 0 : n;
+  }
+};
+
+extern HardwareSerial Serial;
+
+// ==========================================
+// 时间与随机数
+// ==========================================
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// ==========================================
+// PROGMEM（主机上就是普通常量内存）
+// ==========================================
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
@@ -0,0 +1,123 @@
+// 主机端性能基准
+//   cardchess_bench [深度]        标准 bench：固定局面，输出节点签名和 nps（与设备串口 bench 命令一致）
+//   cardchess_bench micro [深度]  perft / 评估 / FEN编解码 / SAN / 搜索微基准，结束时输出 profiler 统计表
+// 配合 perf / 编译器 sanitizer 在烧录前定位热点
+#include "bench.h"
+#include "common.h"
+#include "engine.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void benchPerft(const char* name, const char* fen, int depth) {
+  ChessBoard board;
+  board.fromFEN(String(fen));
+  unsigned long start = micros();
+  unsigned long nodes = perft(board, depth);
+  unsigned long us = micros() - start;
+  printf("perft   %-10s depth %d  nodes %10lu  %8.1f ms  %10.0f nps\n",
+         name, depth, nodes, us / 1000.0, us ? nodes * 1e6 / us : 0.0);
+}
+
+static void benchSearch(const char* name, const char* fen, int depth) {
+  ChessBoard board;
+  board.fromFEN(String(fen));
+  SearchContext context;
+  SearchInfo info;
+  unsigned long start = micros();
+  searchBestMove(board, board.getCurrentPlayer(), depth, context, &info);
+  unsigned long us = micros() - start;
+  printf("search  %-10s depth %d  nodes %10lu  %8.1f ms  %10.0f nps\n",
+         name, depth, info.nodes, us / 1000.0, us ? info.nodes * 1e6 / us : 0.0);
+}
+
+static void benchEvaluate(const char* fen, int iterations) {
+  ChessBoard board;
+  board.fromFEN(String(fen));
+  volatile int sink = 0;
+  unsigned long start = micros();
+  for (int i = 0; i < iterations; i++) {
+    sink += evaluateBoard(board, (i & 1) ? WHITE : BLACK);
+  }
+  unsigned long us = micros() - start;
+  printf("eval    %d calls  %.1f ns/call\n", iterations, us * 1000.0 / iterations);
+}
+
+static void benchFEN(const char* fen, int iterations) {
+  ChessBoard board;
+  board.readFEN(fen);
+  char out[FEN_BUFFER_SIZE];
+  volatile size_t sink = 0;
+
+  unsigned long start = micros();
+  for (int i = 0; i < iterations; i++) {
+    sink += board.writeFEN(out, sizeof(out));
+  }
+  unsigned long encodeUs = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < iterations; i++) {
+    sink += board.readFEN(fen);
+  }
+  unsigned long decodeUs = micros() - start;
+  printf("fen     %d calls  encode %.1f ns/call  decode %.1f ns/call\n",
+         iterations, encodeUs * 1000.0 / iterations, decodeUs * 1000.0 / iterations);
+}
+
+static void benchSAN(const char* fen, int iterations) {
+  ChessBoard board;
+  board.readFEN(fen);
+  MoveList list;
+  board.generateLegalMoves(list);
+  char sans[MAX_MOVES][SAN_BUFFER_SIZE];
+  for (int i = 0; i < list.count; i++) {
+    board.formatSAN(list[i], sans[i], sizeof(sans[i]));
+  }
+  volatile size_t sink = 0;
+
+  unsigned long start = micros();
+  for (int i = 0; i < iterations; i++) {
+    const Move& move = list[i % list.count];
+    sink += board.formatSAN(move, sans[i % list.count], SAN_BUFFER_SIZE);
+  }
+  unsigned long formatUs = micros() - start;
+
+  start = micros();
+  for (int i = 0; i < iterations; i++) {
+    Move move;
+    sink += board.parseSAN(sans[i % list.count], move);
+  }
+  unsigned long parseUs = micros() - start;
+  printf("san     %d calls  format %.1f us/call  parse %.1f us/call\n",
+         iterations, formatUs / (double)iterations, parseUs / (double)iterations);
+}
+
+static void runMicroBench(int depth) {
+  setSerialLogEnabled(false);
+
+  const char* START = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  const char* MIDDLE = "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8";
+
+  profilerReset();
+  benchPerft("start", START, depth + 1);
+  benchPerft("middle", MIDDLE, depth);
+  benchEvaluate(MIDDLE, 200000);
+  benchFEN(MIDDLE, 200000);
+  benchSAN(MIDDLE, 20000);
+  benchSearch("start", START, depth);
+  benchSearch("middle", MIDDLE, depth);
+
+  setSerialLogEnabled(true);
+  profilerDump();
+}
+
+int main(int argc, char** argv) {
+  setSerialLogEnabled(false);
+  if (argc > 1 && strcmp(argv[1], "micro") == 0) {
+    runMicroBench(argc > 2 ? atoi(argv[2]) : 3);
+    return 0;
+  }
+  runBench(argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_DEPTH, true, nullptr);
+  return 0;
+}
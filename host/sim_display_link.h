@@ -0,0 +1,53 @@
+#pragma once
+// 主机端的模拟传输通道：像素在传输“完成”时才从缓冲区读出写进模拟屏幕，
+// 围栏没等到就改写了传输缓冲区时，屏幕内容会和画布不一致，单元测试借此检查帧调度
+#include "display_pipeline.h"
+#include <string.h>
+#include <vector>
+
+class SimDisplayLink : public DisplayLink {
+private:
+  struct Transfer {
+    int x, y, w, h;
+    const uint16_t* pixels;
+  };
+
+  int width;
+  std::vector<uint16_t> screen;
+  Transfer current;
+  bool busy;
+  uint32_t started;
+  uint32_t completed;
+
+public:
+  SimDisplayLink(int screenWidth, int screenHeight)
+      : width(screenWidth), screen(screenWidth * screenHeight, 0), busy(false), started(0), completed(0) {}
+
+  // 模拟 DMA 完成当前传输
+  void complete() {
+    if (!busy) {
+      return;
+    }
+    for (int row = 0; row < current.h; row++) {
+      memcpy(&screen[(current.y + row) * width + current.x], current.pixels + row * current.w,
+             current.w * sizeof(uint16_t));
+    }
+    busy = false;
+    completed++;
+  }
+
+  void startTransfer(int x, int y, int w, int h, const uint16_t* pixels) {
+    complete();
+    Transfer transfer = {x, y, w, h, pixels};
+    current = transfer;
+    busy = true;
+    started++;
+  }
+
+  bool isBusy() { return busy; }
+  void waitIdle() { complete(); }
+
+  uint16_t pixelAt(int x, int y) const { return screen[y * width + x]; }
+  uint32_t getStarted() const { return started; }
+  uint32_t getCompleted() const { return completed; }
+};
@@ -0,0 +1,51 @@
+#pragma once
+// 主机端的块文件实现（stdio），供转换工具与单元测试读写谜题相关文件
+#include "block_file.h"
+#include <stdio.h>
+
+class StdioBlockFile : public BlockFile {
+private:
+  FILE* file;
+
+public:
+  StdioBlockFile() : file(nullptr) {}
+  ~StdioBlockFile() { close(); }
+
+  // writable 时以读写方式打开（不截断），文件不存在则创建
+  bool open(const char* path, bool writable = false) {
+    close();
+    file = fopen(path, writable ? "r+b" : "rb");
+    if (file == nullptr && writable) {
+      file = fopen(path, "w+b");
+    }
+    return file != nullptr;
+  }
+
+  // 以读写方式新建文件，已存在时清空
+  bool create(const char* path) {
+    close();
+    file = fopen(path, "w+b");
+    return file != nullptr;
+  }
+
+  void close() {
+    if (file != nullptr) {
+      fclose(file);
+      file = nullptr;
+    }
+  }
+
+  bool seek(uint32_t offset) { return file != nullptr && fseek(file, (long)offset, SEEK_SET) == 0; }
+  size_t read(uint8_t* buffer, size_t size) { return file != nullptr ? fread(buffer, 1, size, file) : 0; }
+  size_t write(const uint8_t* data, size_t size) { return file != nullptr ? fwrite(data, 1, size, file) : 0; }
+  void flush() { if (file != nullptr) fflush(file); }
+
+  uint32_t size() {
+    if (file == nullptr) return 0;
+    long current = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, current, SEEK_SET);
+    return (uint32_t)end;
+  }
+};
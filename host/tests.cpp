@@ -0,0 +1,1426 @@
+// 主机端单元测试：规则、引擎、UCI、谜题加载、对局日志
+// 运行：ctest 或 ./cardchess_tests [用例名子串]
+#include "ai_worker.h"
+#include "animation.h"
+#include "bench.h"
+#include "common.h"
+#include "dirty_rect.h"
+#include "display_pipeline.h"
+#include "engine.h"
+#include "game_journal.h"
+#include "game_record.h"
+#include "icon_data.h"
+#include "key_events.h"
+#include "palette.h"
+#include "pgn.h"
+#include "power_governor.h"
+#include "uci.h"
+#include "puzzle.h"
+#include "puzzle_index.h"
+#include "puzzle_pack.h"
+#include "puzzle_progress.h"
+#include "puzzle_text.h"
+#include "sim_display_link.h"
+#include "stdio_block_file.h"
+#include "tile_cache.h"
+#include "write_queue.h"
+#include "../tools/icon_source.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long va_ = (long long)(a), vb_ = (long long)(b); \
+    if (va_ != vb_) { \
+      printf("  FAIL %s:%d: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, va_, vb_); \
+      failures++; \
+    } \
+  } while (0)
+
+static ChessBoard boardFromFEN(const char* fen) {
+  ChessBoard board;
+  board.fromFEN(String(fen));
+  return board;
+}
+
+// ==========================================
+// 规则
+// ==========================================
+
+static void testPerftStartPosition() {
+  ChessBoard board;
+  CHECK_EQ(perft(board, 1), 20);
+  CHECK_EQ(perft(board, 2), 400);
+  CHECK_EQ(perft(board, 3), 8902);
+}
+
+static void testPerftReferencePositions() {
+  // 标准 perft 参考局面：覆盖易位、吃过路兵（含横向牵制）、升变
+  struct PerftCase { const char* fen; int depth; unsigned long nodes; };
+  static const PerftCase CASES[] = {
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2, 2039},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3, 2812},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 2, 1486},
+  };
+  for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+    ChessBoard board = boardFromFEN(CASES[i].fen);
+    CHECK_EQ(perft(board, CASES[i].depth), CASES[i].nodes);
+  }
+}
+
+static void testPawnDoublePushBlocked() {
+  // a3上的马挡住了a2兵的双步
+  ChessBoard board = boardFromFEN("rnbqkbnr/1ppppppp/p7/8/8/N7/PPPPPPPP/R1BQKBNR w - - 0 2");
+  CHECK(!board.validateMove(Position(0, 1), Position(0, 3)));
+  CHECK_EQ(perft(board, 1), 20);
+}
+
+static void testMakeMovePromotion() {
+  ChessBoard board = boardFromFEN("8/P7/8/8/8/8/8/k6K w - - 0 1");
+  CHECK(board.makeMove(Move(Position(0, 6), Position(0, 7), KNIGHT)));
+  CHECK_EQ(board.getPiece(0, 7).type, KNIGHT);
+  CHECK_EQ(board.getPiece(0, 7).color, WHITE);
+  CHECK_EQ(board.getCurrentPlayer(), BLACK);
+  CHECK_EQ(board.getCurrentState(), NormalPlay);
+}
+
+static void testFENRoundTrip() {
+  static const char* const FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "rnbqkbnr/pp1ppppp/8/2pP4/8/8/PPP1PPPP/RNBQKBNR w Kq c6 0 3",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 17 42",
+  };
+  for (size_t i = 0; i < sizeof(FENS) / sizeof(FENS[0]); i++) {
+    ChessBoard board;
+    char out[FEN_BUFFER_SIZE];
+    CHECK(board.readFEN(FENS[i]));
+    CHECK(board.writeFEN(out, sizeof(out)) == strlen(FENS[i]));
+    CHECK(strcmp(out, FENS[i]) == 0);
+  }
+
+  // 缓冲区不足时不写入
+  ChessBoard board;
+  char small[16];
+  CHECK_EQ(board.writeFEN(small, sizeof(small)), 0);
+}
+
+static void testFENRejectsMalformed() {
+  ChessBoard board = boardFromFEN("4k3/8/8/8/8/8/8/4K3 b - - 5 9");
+  CHECK(!board.readFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w"));          // 行数不足
+  CHECK(!board.readFEN("rnbqkbnr/ppppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w")); // 9格
+  CHECK(!board.readFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w"));  // 非法棋子
+  CHECK(!board.readFEN("4k3/8/8/8/8/8/8/4K3 w KX - 0 1"));                 // 非法易位权
+  // 失败时棋盘保持不变
+  char out[FEN_BUFFER_SIZE];
+  board.writeFEN(out, sizeof(out));
+  CHECK(strcmp(out, "4k3/8/8/8/8/8/8/4K3 b - - 5 9") == 0);
+
+  // 省略的字段使用默认值
+  CHECK(board.readFEN("4k3/8/8/8/8/8/8/4K3 w"));
+  board.writeFEN(out, sizeof(out));
+  CHECK(strcmp(out, "4k3/8/8/8/8/8/8/4K3 w - - 0 1") == 0);
+}
+
+static void testFENTracksMoves() {
+  ChessBoard board;
+  char out[FEN_BUFFER_SIZE];
+  CHECK(board.makeMove(Move(Position(4, 1), Position(4, 3))));
+  board.writeFEN(out, sizeof(out));
+  CHECK(strcmp(out, "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1") == 0);
+  CHECK(board.makeMove(Move(Position(6, 7), Position(5, 5))));
+  board.writeFEN(out, sizeof(out));
+  CHECK(strcmp(out, "rnbqkb1r/pppppppp/5n2/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 1 2") == 0);
+
+  // 车在原位被吃，对方失去该侧易位权
+  board = boardFromFEN("r3k2r/8/8/8/8/8/6B1/R3K2R w KQkq - 0 1");
+  CHECK(board.makeMove(Move(Position(6, 1), Position(0, 7))));
+  board.writeFEN(out, sizeof(out));
+  CHECK(strcmp(out, "B3k2r/8/8/8/8/8/8/R3K2R b KQk - 0 1") == 0);
+
+  // FEN没有给出的易位权不能走
+  board = boardFromFEN("4k3/8/8/8/8/8/8/4K2R w - - 0 1");
+  CHECK(!board.validateMove(Position(4, 0), Position(6, 0)));
+}
+
+// ==========================================
+// SAN
+// ==========================================
+
+static void checkSAN(const ChessBoard& board, const char* san, int fx, int fy, int tx, int ty, PieceType promotion) {
+  Move move;
+  bool ok = board.parseSAN(san, move);
+  if (!ok || move != Move(Position(fx, fy), Position(tx, ty)) || move.promotion != promotion) {
+    printf("  FAIL parseSAN(%s)\n", san);
+    failures++;
+  }
+}
+
+static void testParseSAN() {
+  ChessBoard board;
+  checkSAN(board, "e4", 4, 1, 4, 3, NONE);
+  checkSAN(board, "Nf3", 6, 0, 5, 2, NONE);
+  checkSAN(board, "Nf3!?", 6, 0, 5, 2, NONE);
+  Move move;
+  CHECK(!board.parseSAN("e5", move));
+  CHECK(!board.parseSAN("Nd2", move));
+  CHECK(!board.parseSAN("", move));
+
+  // 消歧义：两个车都能到d1
+  board = boardFromFEN("4k3/8/8/8/8/8/4K3/R6R w - - 0 1");
+  CHECK(!board.parseSAN("Rd1", move));
+  board = boardFromFEN("4k3/8/8/8/8/8/8/R4RK1 w - - 0 1");
+  checkSAN(board, "Rad1", 0, 0, 3, 0, NONE);
+  checkSAN(board, "Rfd1", 5, 0, 3, 0, NONE);
+  board = boardFromFEN("4k3/8/8/R7/8/8/8/R3K3 w - - 0 1");
+  checkSAN(board, "R1a3", 0, 0, 0, 2, NONE);
+  checkSAN(board, "R5a3+", 0, 4, 0, 2, NONE);
+
+  // 升变、吃子、将军标记
+  board = boardFromFEN("3r1k2/4P3/8/8/8/8/8/4K3 w - - 0 1");
+  checkSAN(board, "exd8=Q+", 4, 6, 3, 7, QUEEN);
+  checkSAN(board, "exd8=N", 4, 6, 3, 7, KNIGHT);
+  checkSAN(board, "e8Q+", 4, 6, 4, 7, QUEEN);
+  checkSAN(board, "e8", 4, 6, 4, 7, QUEEN);
+
+  // 易位与吃过路兵
+  board = boardFromFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1");
+  checkSAN(board, "O-O", 4, 0, 6, 0, NONE);
+  checkSAN(board, "0-0-0", 4, 0, 2, 0, NONE);
+  checkSAN(board, "exd6", 4, 4, 3, 5, NONE);
+  checkSAN(board, "exd6e.p.", 4, 4, 3, 5, NONE);
+}
+
+static void checkFormatSAN(const char* fen, int fx, int fy, int tx, int ty, PieceType promotion, const char* expected) {
+  ChessBoard board = boardFromFEN(fen);
+  char san[SAN_BUFFER_SIZE];
+  size_t len = board.formatSAN(Move(Position(fx, fy), Position(tx, ty), promotion), san, sizeof(san));
+  if (len == 0 || strcmp(san, expected) != 0) {
+    printf("  FAIL formatSAN: expected %s, got %s\n", expected, len ? san : "(none)");
+    failures++;
+  }
+}
+
+static void testFormatSAN() {
+  const char* START = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  checkFormatSAN(START, 4, 1, 4, 3, NONE, "e4");
+  checkFormatSAN(START, 6, 0, 5, 2, NONE, "Nf3");
+  checkFormatSAN("4k3/8/8/8/8/8/8/R4RK1 w - - 0 1", 0, 0, 3, 0, NONE, "Rad1");
+  checkFormatSAN("4k3/8/8/R7/8/8/8/R3K3 w - - 0 1", 0, 4, 0, 2, NONE, "R5a3");
+  checkFormatSAN("4k3/8/8/8/8/2N1N3/8/4K3 w - - 0 1", 2, 2, 3, 4, NONE, "Ncd5");
+  checkFormatSAN("7k/2N5/8/8/8/2N1N3/8/4K3 w - - 0 1", 2, 2, 3, 4, NONE, "Nc3d5");
+  checkFormatSAN("3r1k2/4P3/8/8/8/8/8/4K3 w - - 0 1", 4, 6, 3, 7, NONE, "exd8=Q+");
+  checkFormatSAN("3r1k2/4P3/8/8/8/8/8/4K3 w - - 0 1", 4, 6, 3, 7, KNIGHT, "exd8=N");
+  checkFormatSAN("r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1", 4, 4, 3, 5, NONE, "exd6");
+  checkFormatSAN("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", 4, 0, 2, 0, NONE, "O-O-O");
+  checkFormatSAN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 0, 0, 0, 7, NONE, "Ra8#");
+
+  // 非法走法不输出
+  ChessBoard board;
+  char san[SAN_BUFFER_SIZE];
+  CHECK_EQ(board.formatSAN(Move(Position(4, 1), Position(4, 4)), san, sizeof(san)), 0);
+}
+
+static void testSerialLogMuteKeepsSwitch() {
+  ChessBoard board;
+  char san[SAN_BUFFER_SIZE];
+  setSerialLogEnabled(true);
+  {
+    SerialLogMute outer;
+    CHECK(!isSerialLogEnabled());
+    // formatSAN 内部静音结束后，外层的静音仍然有效
+    CHECK(board.formatSAN(Move(Position(4, 1), Position(4, 3)), san, sizeof(san)) > 0);
+    CHECK(!isSerialLogEnabled());
+  }
+  CHECK(isSerialLogEnabled());
+  CHECK(board.formatSAN(Move(Position(4, 1), Position(4, 3)), san, sizeof(san)) > 0);
+  CHECK(isSerialLogEnabled());
+  setSerialLogEnabled(false);
+}
+
+// ==========================================
+// 引擎
+// ==========================================
+
+static void testSearchFindsMateInOne() {
+  ChessBoard board = boardFromFEN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+  SearchContext context;
+  SearchInfo info;
+  Move best = searchBestMove(board, WHITE, 2, context, &info);
+  CHECK(best == Move(Position(0, 0), Position(0, 7)));
+  CHECK(info.nodes > 0);
+}
+
+static void testSearchIsDeterministic() {
+  ChessBoard board;
+  SearchContext context;
+  SearchInfo a, b;
+  Move first = searchBestMove(board, WHITE, 2, context, &a);
+  Move second = searchBestMove(board, WHITE, 2, context, &b);
+  CHECK(first == second);
+  CHECK_EQ(a.nodes, b.nodes);
+}
+
+static uint64_t squareBit(int x, int y) { return 1ULL << (y * 8 + x); }
+
+static void testLegalTargetCache() {
+  ChessBoard board;
+  // 开局：e2 兵能走 e3/e4，g1 马能跳 f3/h3，按 y、x 顺序给出；黑方棋子不是走子方，为0
+  CHECK(board.getLegalTargets(Position(4, 1)) == (squareBit(4, 2) | squareBit(4, 3)));
+  CHECK(board.getLegalTargets(Position(4, 6)) == 0);
+  CHECK(board.selectPiece(Position(6, 0)));
+  CHECK_EQ((int)board.getValidMoves().size(), 2);
+  CHECK(board.getValidMoves()[0] == Position(5, 2) && board.getValidMoves()[1] == Position(7, 2));
+
+  // 走子后缓存作废，换成黑方的走法；缓存里没有的走法被拒绝
+  CHECK(!board.makeMove(Move(Position(4, 1), Position(4, 4))));
+  CHECK(board.makeMove(Move(Position(4, 1), Position(4, 3))));
+  CHECK(board.getLegalTargets(Position(4, 1)) == 0);
+  CHECK(board.getLegalTargets(Position(4, 6)) == (squareBit(4, 5) | squareBit(4, 4)));
+  // 悔棋和直接摆子也作废缓存
+  board.undoMove();
+  CHECK(board.getLegalTargets(Position(4, 1)) == (squareBit(4, 2) | squareBit(4, 3)));
+  board.setPiece(4, 1, Piece());
+  CHECK(board.getLegalTargets(Position(5, 0)) != 0);
+  // 只读查询内部模拟走子，不让缓存作废
+  CHECK(board.isLegalTargetCacheValid());
+  CHECK(board.validateMove(Position(3, 1), Position(3, 3)));
+  MoveList generated;
+  board.generateLegalMoves(generated);
+  CHECK(board.isLegalTargetCacheValid());
+
+  // 与完整走法生成一致（没有升变的局面，两者走法数相同）
+  const char* fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  };
+  for (int i = 0; i < 2; i++) {
+    CHECK(board.readFEN(fens[i]));
+    MoveList list;
+    board.generateLegalMoves(list);
+    int cached = 0;
+    for (int square = 0; square < 64; square++) {
+      for (uint64_t targets = board.getLegalTargets(Position(square % 8, square / 8)); targets != 0; targets &= targets - 1) {
+        cached++;
+      }
+    }
+    CHECK_EQ(cached, list.count);
+  }
+
+  // 将死与逼和从缓存判断
+  CHECK(board.readFEN("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"));
+  CHECK(board.isCheckmate(WHITE) && !board.isStalemate(WHITE) && !board.hasValidMoves());
+  CHECK(board.readFEN("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"));
+  CHECK(board.isStalemate(BLACK) && !board.isCheckmate(BLACK) && !board.hasValidMoves());
+  CHECK(!board.isStalemate(WHITE));
+}
+
+static void testPickAIMoveIsSeeded() {
+  ChessBoard board;
+  SearchContext a(12345), b(12345);
+  Move first = pickAIMove(board, WHITE, 2, a, nullptr);
+  // 另一个上下文的搜索不影响这一个的随机数和计数
+  SearchInfo other;
+  pickAIMove(board, WHITE, 1, b, &other);
+  b.seedRandom(12345);
+  SearchInfo info;
+  Move second = pickAIMove(board, WHITE, 2, b, &info);
+  CHECK(first == second);
+  CHECK_EQ(a.nodes, info.nodes);
+  CHECK(other.nodes < info.nodes);
+}
+
+static void testBenchSignature() {
+  // 纯速度优化不应改变这个数字；有意修改搜索/走法顺序时同步更新
+  BenchResult result;
+  runBench(2, false, &result);
+  CHECK_EQ(result.positions, 30);
+  CHECK_EQ(result.nodes, 26238);
+}
+
+// ==========================================
+// UCI
+// ==========================================
+
+static void testUciMoveText() {
+  ChessBoard board;
+  Move move;
+  CHECK(UciSession::parseMove(board, "e2e4", move));
+  CHECK(move == Move(Position(4, 1), Position(4, 3)));
+  CHECK(!UciSession::parseMove(board, "e2e5", move));
+  CHECK(!UciSession::parseMove(board, "e7e5", move));
+
+  char text[6];
+  UciSession::formatMove(board, move, text);
+  CHECK(strcmp(text, "e2e4") == 0);
+
+  ChessBoard promo = boardFromFEN("8/P7/8/8/8/8/8/k6K w - - 0 1");
+  CHECK(UciSession::parseMove(promo, "a7a8n", move));
+  CHECK_EQ(move.promotion, KNIGHT);
+  UciSession::formatMove(promo, move, text);
+  CHECK(strcmp(text, "a7a8n") == 0);
+}
+
+// ==========================================
+// 谜题
+// ==========================================
+
+static void testBuiltinPuzzlesLoad() {
+  // 谜题2的走法与局面不符（c3上的马挡住了c4），未编入内置数据
+  CHECK_EQ(Puzzle::count(), 2);
+  Puzzle puzzle;
+  CHECK(!Puzzle::load(Puzzle::count(), puzzle));
+  for (int i = 0; i < Puzzle::count(); i++) {
+    CHECK(Puzzle::load(i, puzzle));
+    if (i == 0) CHECK_EQ(puzzle.getMoveCount(), 7);
+    // 整条正解都必须能在棋盘上走通
+    ChessBoard board;
+    CHECK(puzzle.applyTo(board));
+    CHECK_EQ(board.getCurrentPlayer(), puzzle.getSideToMove());
+    for (int k = 0; k < puzzle.getMoveCount(); k++) {
+      CHECK(board.makeMove(puzzle.getMove(k)));
+    }
+  }
+}
+
+static void testPuzzlePackRoundTrip() {
+  const char* fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w Kq f6 0 1",
+  };
+  for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+    ChessBoard board = boardFromFEN(fens[i]);
+    uint8_t packed[PUZZLE_POSITION_BYTES];
+    packPosition(board, packed);
+    ChessBoard restored;
+    CHECK(unpackPosition(packed, restored));
+    char fen[FEN_BUFFER_SIZE];
+    CHECK(restored.writeFEN(fen, sizeof(fen)));
+    CHECK(strcmp(fen, fens[i]) == 0);
+  }
+
+  Move promotion(Position(6, 6), Position(7, 7), QUEEN);
+  Move unpacked = unpackMove(packMove(promotion));
+  CHECK(unpacked == promotion);
+  CHECK_EQ(unpacked.promotion, QUEEN);
+}
+
+static void testPuzzlePackRandomAccess() {
+  // 用内置谜题拼出一个谜题包，再按序号倒序读回
+  const char* path = "cardchess_test_puzzles.pak";
+  int count = Puzzle::count();
+  CHECK(count <= 4);
+  if (count > 4) return;
+  uint8_t header[PUZZLE_PACK_HEADER_SIZE];
+  encodePuzzlePackHeader(count, header);
+  FILE* out = fopen(path, "wb");
+  CHECK(out != nullptr);
+  if (out == nullptr) return;
+  fwrite(header, 1, sizeof(header), out);
+  uint32_t offset = PUZZLE_PACK_HEADER_SIZE + 4 * (count + 1);
+  uint8_t records[4][PUZZLE_RECORD_MAX_SIZE];
+  size_t lengths[4];
+  for (int i = 0; i <= count; i++) {
+    uint8_t entry[4] = {(uint8_t)offset, (uint8_t)(offset >> 8), (uint8_t)(offset >> 16), (uint8_t)(offset >> 24)};
+    fwrite(entry, 1, sizeof(entry), out);
+    if (i == count) break;
+    Puzzle puzzle;
+    Puzzle::load(i, puzzle);
+    uint16_t moves[PUZZLE_MAX_MOVES];
+    for (int k = 0; k < puzzle.getMoveCount(); k++) moves[k] = puzzle.getPackedMove(k);
+    lengths[i] = encodePuzzleRecord(puzzle.getPackedPosition(), 1500 + i, moves, puzzle.getMoveCount(), records[i]);
+    offset += lengths[i];
+  }
+  for (int i = 0; i < count; i++) fwrite(records[i], 1, lengths[i], out);
+  fclose(out);
+
+  StdioBlockFile file;
+  PuzzlePack pack;
+  CHECK(file.open(path) && pack.open(&file));
+  CHECK_EQ(pack.size(), count);
+  for (int i = count - 1; i >= 0; i--) {
+    Puzzle expected;
+    Puzzle loaded;
+    Puzzle::load(i, expected);
+    CHECK(pack.load(i, loaded));
+    CHECK_EQ(loaded.getRating(), 1500 + i);
+    CHECK(memcmp(loaded.getPackedPosition(), expected.getPackedPosition(), PUZZLE_POSITION_BYTES) == 0);
+    CHECK_EQ(loaded.getMoveCount(), expected.getMoveCount());
+    for (int k = 0; k < loaded.getMoveCount(); k++) {
+      CHECK_EQ(loaded.getPackedMove(k), expected.getPackedMove(k));
+    }
+  }
+  Puzzle puzzle;
+  CHECK(!pack.load(count, puzzle));
+  file.close();
+
+  // 魔数错误的文件不能打开
+  out = fopen(path, "wb");
+  fwrite("CCPX", 1, 4, out);
+  fwrite(header + 4, 1, sizeof(header) - 4, out);
+  fclose(out);
+  CHECK(file.open(path));
+  CHECK(!pack.open(&file));
+  file.close();
+  remove(path);
+}
+
+static void testPuzzleIndexRatingBand() {
+  // 1000个谜题：等级分 800 + 2*i，每第10个带 fork 主题
+  const char* path = "cardchess_test_puzzles.idx";
+  const int puzzles = 1000;
+  int entries = puzzles + puzzles / 10;
+  FILE* out = fopen(path, "wb");
+  CHECK(out != nullptr);
+  if (out == nullptr) return;
+  uint8_t buffer[PUZZLE_INDEX_HEADER_SIZE];
+  encodePuzzleIndexHeader(entries, buffer);
+  fwrite(buffer, 1, PUZZLE_INDEX_HEADER_SIZE, out);
+  for (int theme = PUZZLE_THEME_ALL; theme <= PUZZLE_THEME_FORK; theme++) {
+    for (int i = 0; i < puzzles; i++) {
+      if (theme == PUZZLE_THEME_ALL || (theme == PUZZLE_THEME_FORK && i % 10 == 0)) {
+        encodePuzzleIndexEntry(theme, 800 + 2 * i, i, buffer);
+        fwrite(buffer, 1, PUZZLE_INDEX_ENTRY_SIZE, out);
+      }
+    }
+  }
+  fclose(out);
+
+  StdioBlockFile file;
+  PuzzleIndex index;
+  CHECK(file.open(path) && index.open(&file));
+  CHECK_EQ(index.countInBand(PUZZLE_THEME_ALL, 0, 0xFFFF), puzzles);
+  CHECK_EQ(index.countInBand(PUZZLE_THEME_ALL, 1300, 1400), 51);
+  CHECK_EQ(index.countInBand(PUZZLE_THEME_FORK, 1300, 1400), 6);
+  CHECK_EQ(index.countInBand(PUZZLE_THEME_PIN, 0, 0xFFFF), 0);
+  for (int k = 0; k < 50; k++) {
+    uint32_t puzzle;
+    CHECK(index.pickRandom(PUZZLE_THEME_FORK, 1300, 1400, puzzle));
+    CHECK(puzzle % 10 == 0 && 800 + 2 * puzzle >= 1300 && 800 + 2 * puzzle <= 1400);
+  }
+  uint32_t puzzle;
+  CHECK(!index.pickRandom(PUZZLE_THEME_MATE_IN_2, 0, 0xFFFF, puzzle));
+  CHECK_EQ(puzzleThemeFromName("mateIn2"), PUZZLE_THEME_MATE_IN_2);
+  file.close();
+  remove(path);
+}
+
+static void testTextPuzzlesMatchBuiltin() {
+  // puzzle.txt 的FEN已改成标准顺序，谜题2走法非法被跳过，谜题3截断到3步
+  StdioBlockFile file;
+  PuzzleTextReader reader;
+  CHECK(file.open(CARDCHESS_SOURCE_DIR "/puzzle.txt") && reader.open(&file));
+  CHECK_EQ(reader.count(), Puzzle::count());
+  for (int i = reader.count() - 1; i >= 0; i--) {
+    Puzzle expected;
+    Puzzle loaded;
+    char title[PUZZLE_TITLE_SIZE];
+    Puzzle::load(i, expected);
+    CHECK(reader.load(i, loaded, title));
+    CHECK(memcmp(loaded.getPackedPosition(), expected.getPackedPosition(), PUZZLE_POSITION_BYTES) == 0);
+    CHECK_EQ(loaded.getMoveCount(), expected.getMoveCount());
+    for (int k = 0; k < loaded.getMoveCount() && k < expected.getMoveCount(); k++) {
+      CHECK_EQ(loaded.getPackedMove(k), expected.getPackedMove(k));
+    }
+    if (i == 0) CHECK(strcmp(title, "1.经典转向（黑先）") == 0);
+  }
+}
+
+static void testTextPuzzleStreaming() {
+  // 标准FEN、超长解说、与解说同一行的 <MOVES>、回合号与注释符号
+  const char* path = "cardchess_test_puzzles.txt";
+  FILE* out = fopen(path, "wb");
+  CHECK(out != nullptr);
+  if (out == nullptr) return;
+  fprintf(out, "\xEF\xBB\xBF  Scholar's mate  \r\n");
+  fprintf(out, "r1bqkbnr/pppp1ppp/2n5/4p2Q/4P3/8/PPPP1PPP/RNB1KBNR w KQkq - 2 3\r\n");
+  for (int i = 0; i < 200; i++) fprintf(out, "很长的解说<b>文字</b> ");
+  fprintf(out, "<MOVES>3. Bc4 Nf6?? 4. Qxf7#!</MOVES>\n\n");
+  fprintf(out, "Broken\n8/8/8/8/8/8/8/K6k w - - 0 1\n<MOVES>Qh8</MOVES>\n");
+  fprintf(out, "Mate in one\n6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1\n<MOVES>\n1. Ra8#\n</MOVES>");
+  fclose(out);
+
+  StdioBlockFile file;
+  PuzzleTextReader reader;
+  CHECK(file.open(path) && reader.open(&file));
+  CHECK_EQ(reader.count(), 2);
+  Puzzle puzzle;
+  char title[PUZZLE_TITLE_SIZE];
+  CHECK(reader.load(1, puzzle, title));
+  CHECK(strcmp(title, "Mate in one") == 0);
+  CHECK_EQ(puzzle.getMoveCount(), 1);
+  CHECK(reader.load(0, puzzle, title));
+  CHECK(strcmp(title, "Scholar's mate") == 0);
+  CHECK_EQ(puzzle.getMoveCount(), 3);
+  CHECK(!reader.load(2, puzzle, title));
+  file.close();
+  remove(path);
+}
+
+static void testPuzzleProgressInPlace() {
+  const char* path = "cardchess_test_puzzles.prg";
+  remove(path);
+  const uint32_t puzzles = 1000;
+  StdioBlockFile file;
+  PuzzleProgress progress;
+  CHECK(file.open(path, true) && progress.open(&file, puzzles));
+  uint32_t size = file.size();
+  CHECK_EQ(size, PUZZLE_PROGRESS_HEADER_SIZE + (puzzles + 7) / 8 + puzzles);
+
+  // 解决 0-99（50除外）以及 105
+  for (uint32_t i = 0; i < 100; i++) {
+    if (i != 50) CHECK(progress.markSolved(i));
+  }
+  CHECK(progress.markSolved(105));
+  uint32_t index;
+  CHECK(progress.findUnsolved(0, index) && index == 50);
+  CHECK(progress.findUnsolved(51, index) && index == 100);
+  CHECK(progress.findUnsolved(105, index) && index == 106);
+  CHECK(progress.addAttempt(7) && progress.addAttempt(7));
+  CHECK(progress.setLastIndex(321));
+  file.close();
+
+  // 重新打开后状态保留，文件没有变长
+  CHECK(file.open(path, true) && progress.open(&file, puzzles));
+  CHECK_EQ(file.size(), size);
+  CHECK(progress.isSolved(99) && progress.isSolved(105) && !progress.isSolved(50) && !progress.isSolved(100));
+  CHECK_EQ(progress.getAttempts(7), 2);
+  CHECK_EQ(progress.getLastIndex(), 321);
+
+  // 末尾回绕：只剩 50 未解决时，从 900 开始找也能回到 50
+  for (uint32_t i = 100; i < puzzles; i++) progress.markSolved(i);
+  CHECK(progress.findUnsolved(900, index) && index == 50);
+  CHECK(progress.markSolved(50));
+  CHECK(!progress.findUnsolved(0, index));
+  file.close();
+
+  // 谜题数量变化时重新初始化
+  CHECK(file.open(path, true) && progress.open(&file, 10));
+  CHECK(!progress.isSolved(3));
+  CHECK(progress.findUnsolved(9, index) && index == 9);
+  file.close();
+
+  // 经写入队列（设备上由后台任务写出，主机端 flush() 时同步写出）
+  QueuedBlockFile queue;
+  CHECK(file.open(path, true) && queue.attach(&file) && progress.open(&queue, 10));
+  CHECK(progress.markSolved(4) && progress.addAttempt(4) && progress.setLastIndex(6));
+  CHECK(progress.isSolved(4));
+  CHECK(queue.sync() && !queue.hasPending());
+  queue.attach(nullptr);
+  CHECK(progress.open(&file, 10));
+  CHECK(progress.isSolved(4) && progress.getAttempts(4) == 1 && progress.getLastIndex() == 6);
+  file.close();
+  remove(path);
+}
+
+// ==========================================
+// 对局日志与记录
+// ==========================================
+
+static void testGameRecordUndoRedoSeek() {
+  // 包含吃过路兵、升变、双方易位和一串兑子，超过两个关键帧间隔
+  const char* moves[] = {"e4", "d5", "exd5", "c5", "dxc6", "Nf6", "cxb7", "e6", "bxa8=Q", "Be7",
+                         "Nf3", "O-O", "Be2", "Bb7", "O-O", "Bxa8", "d4", "Qc7", "c4", "Rd8",
+                         "Nc3", "Nc6", "d5", "exd5", "cxd5", "Nb4", "a3", "Nbxd5", "Nxd5", "Nxd5",
+                         "Qxd5", "Bxd5", "Rd1", "Bxf3"};
+  const int count = sizeof(moves) / sizeof(moves[0]);
+  char fens[count + 1][FEN_BUFFER_SIZE];
+  char fen[FEN_BUFFER_SIZE];
+  ChessBoard board;
+  GameRecord record;
+  record.reset(board);
+  board.writeFEN(fens[0], sizeof(fens[0]));
+  for (int i = 0; i < count; i++) {
+    Move move;
+    CHECK(board.parseSAN(moves[i], move) && board.makeMove(move));
+    CHECK(record.push(move, board));
+    board.writeFEN(fens[i + 1], sizeof(fens[i + 1]));
+  }
+  CHECK_EQ(record.getTotal(), count);
+
+  // 逐步悔棋到开局，每一步的FEN（含易位权、过路兵格、回合计数）都与当时一致
+  for (int i = count - 1; i >= 0; i--) {
+    CHECK(record.undo(board));
+    board.writeFEN(fen, sizeof(fen));
+    CHECK(strcmp(fen, fens[i]) == 0);
+  }
+  CHECK(!record.canUndo());
+  for (int i = 1; i <= count; i++) {
+    CHECK(record.redo(board));
+    board.writeFEN(fen, sizeof(fen));
+    CHECK(strcmp(fen, fens[i]) == 0);
+  }
+  CHECK(!record.canRedo());
+
+  // 任意跳转：近处逐步走，远处从关键帧重放
+  const int targets[] = {3, 30, 17, 16, 0, 34, 9, 33, 1};
+  for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+    CHECK(record.seek(board, targets[i]) && record.getPly() == targets[i]);
+    board.writeFEN(fen, sizeof(fen));
+    CHECK(strcmp(fen, fens[targets[i]]) == 0);
+  }
+  CHECK(!record.seek(board, count + 1));
+
+  // 悔棋后走新的一步会丢弃原来的后续
+  CHECK(record.seek(board, 20));
+  Move move;
+  CHECK(board.parseSAN("h3", move) && board.makeMove(move) && record.push(move, board));
+  CHECK_EQ(record.getTotal(), 21);
+  CHECK(!record.canRedo());
+  CHECK(record.seek(board, 17));
+  board.writeFEN(fen, sizeof(fen));
+  CHECK(strcmp(fen, fens[17]) == 0);
+}
+
+static void testPgnExportImport() {
+  const char* path = "cardchess_test_games.pgn";
+  StdioBlockFile file;
+  CHECK(file.create(path));
+
+  // 第一局：中途悔棋两步再走，最后以将死结束，结果自动写入
+  ChessBoard board;
+  PgnWriter writer;
+  CHECK(writer.begin(&file, board, "Player", "CardChess AI"));
+  const char* moves[] = {"e4", "e5", "Nc3", "Nc6", "Bc4", "Bc5", "Qh5", "Nf6", "Qxf7#"};
+  for (int i = 0; i < 9; i++) {
+    Move move;
+    CHECK(board.parseSAN(moves[i], move) && board.makeMove(move) && writer.appendMove(move, board));
+    if (i == 5) {
+      // 先走了 Bc5 之后的两步错着再撤回
+      Move extra;
+      CHECK(board.parseSAN("a3", extra) && board.makeMove(extra) && writer.appendMove(extra, board));
+      CHECK(board.parseSAN("a6", extra) && board.makeMove(extra) && writer.appendMove(extra, board));
+      CHECK(writer.truncate(6));
+      CHECK(board.readFEN("r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/2N5/PPPP1PPP/R1BQK1NR w KQkq - 4 4"));
+    }
+  }
+  CHECK(writer.isFinished());
+  char expected[FEN_BUFFER_SIZE];
+  board.writeFEN(expected, sizeof(expected));
+
+  // 第二局：从FEN开始，黑先，未结束
+  ChessBoard second;
+  CHECK(second.readFEN("4k3/8/8/8/8/8/4P3/4K3 b - - 0 30"));
+  CHECK(writer.begin(&file, second, "A", "B"));
+  Move move;
+  CHECK(second.parseSAN("Kd7", move) && second.makeMove(move) && writer.appendMove(move, second));
+  CHECK(second.parseSAN("e4", move) && second.makeMove(move) && writer.appendMove(move, second));
+  CHECK(writer.finish("*"));
+
+  // 第三局：手写的PGN，含BOM之外的各种注释、变着、NAG 与数字易位
+  const char* manual =
+      "\n[Event \"Manual \\\"quoted\\\"\"]\n[White \"W\"]\n[Black \"B\"]\n[Result \"1/2-1/2\"]\n\n"
+      "1.e4 {best by test} e5 2. Nf3 (2. f4 exf4 (2... d5)) 2... Nc6 $1 3. Bb5 a6 ; Ruy Lopez\n"
+      "4. Ba4 Nf6 5. 0-0 Be7 1/2-1/2\n";
+  CHECK(file.writeAt(file.size(), (const uint8_t*)manual, strlen(manual)));
+  file.flush();
+
+  PgnReader reader;
+  CHECK(reader.open(&file));
+  CHECK_EQ(reader.count(), 3);
+  PgnGameInfo info;
+  GameRecord record;
+  ChessBoard loaded;
+  char fen[FEN_BUFFER_SIZE];
+  CHECK(reader.load(0, info));
+  CHECK(strcmp(info.white, "Player") == 0 && strcmp(info.result, "1-0") == 0 && info.fen[0] == '\0');
+  CHECK(reader.readMoves(info, loaded, record));
+  CHECK_EQ(record.getTotal(), 9);
+  loaded.writeFEN(fen, sizeof(fen));
+  CHECK(strcmp(fen, expected) == 0);
+
+  CHECK(reader.load(1, info));
+  CHECK(strcmp(info.result, "*") == 0 && strcmp(info.fen, "4k3/8/8/8/8/8/4P3/4K3 b - - 0 30") == 0);
+  CHECK(reader.readMoves(info, loaded, record));
+  CHECK_EQ(record.getTotal(), 2);
+  CHECK(loaded.getPiece(4, 3).is(PAWN, WHITE));
+
+  CHECK(reader.load(2, info));
+  CHECK(strcmp(info.event, "Manual \"quoted\"") == 0 && strcmp(info.result, "1/2-1/2") == 0);
+  CHECK(reader.readMoves(info, loaded, record));
+  CHECK_EQ(record.getTotal(), 10);
+  CHECK(loaded.getPiece(6, 0).is(KING, WHITE) && loaded.getPiece(4, 6).is(BISHOP, BLACK));
+
+  // 往回翻后读取走法不影响顺序读取
+  CHECK(reader.load(0, info) && reader.readMoves(info, loaded, record));
+  CHECK(reader.next(info) && strcmp(info.white, "A") == 0);
+  CHECK(!reader.load(3, info));
+  file.close();
+  remove(path);
+}
+
+static void testPgnReaderSeeksLargeFile() {
+  const char* path = "cardchess_test_many.pgn";
+  FILE* out = fopen(path, "wb");
+  CHECK(out != nullptr);
+  if (out == nullptr) return;
+  fputs("\xEF\xBB\xBF", out);
+  const int games = 200;
+  for (int i = 0; i < games; i++) {
+    fprintf(out, "[Event \"Game %d\"]\n[Result \"*\"]\n\n1. %s *\n\n", i, i % 2 ? "d4" : "e4");
+  }
+  fclose(out);
+
+  StdioBlockFile file;
+  PgnReader reader;
+  CHECK(file.open(path) && reader.open(&file));
+  CHECK_EQ(reader.count(), games);
+  PgnGameInfo info;
+  char name[16];
+  const int order[] = {150, 3, 199, 64, 63, 0, 100};
+  for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+    snprintf(name, sizeof(name), "Game %d", order[i]);
+    CHECK(reader.load(order[i], info) && strcmp(info.event, name) == 0);
+  }
+  ChessBoard board;
+  GameRecord record;
+  CHECK(reader.load(77, info) && reader.readMoves(info, board, record));
+  CHECK(board.getPiece(3, 3).is(PAWN, WHITE));
+  file.close();
+  remove(path);
+}
+
+static void testGameJournalRecovery() {
+  const char* path = "cardchess_test_game.jnl";
+  StdioBlockFile file;
+  GameJournal journal;
+  ChessBoard board;
+  board.initBoard();
+  CHECK(file.create(path) && journal.start(&file, board, JOURNAL_FLAG_WHITE_PLAYER));
+  CHECK_EQ(journal.size(), GAME_JOURNAL_HEADER_SIZE + JOURNAL_CHECKPOINT_SIZE);
+
+  // 走满一个检查点间隔再多几步，途中包含升变
+  const char* moves[] = {"e4", "d5", "exd5", "c6", "dxc6", "Qb6", "cxb7", "Bd7", "bxa8=N"};
+  for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+    Move move;
+    CHECK(board.parseSAN(moves[i], move) && board.makeMove(move));
+    CHECK(journal.appendMove(move, board, JOURNAL_FLAG_WHITE_PLAYER));
+  }
+  const char* shuffle[] = {"Nf6", "Nf3", "Ng8", "Ng1"};
+  for (int i = 0; i < JOURNAL_CHECKPOINT_INTERVAL; i++) {
+    Move move;
+    CHECK(board.parseSAN(shuffle[i % 4], move) && board.makeMove(move));
+    CHECK(journal.appendMove(move, board, JOURNAL_FLAG_WHITE_PLAYER));
+  }
+  uint32_t expectedSize = GAME_JOURNAL_HEADER_SIZE + 2 * JOURNAL_CHECKPOINT_SIZE +
+                          (9 + JOURNAL_CHECKPOINT_INTERVAL) * JOURNAL_MOVE_SIZE;
+  CHECK_EQ(journal.size(), expectedSize);
+  char expected[FEN_BUFFER_SIZE];
+  board.writeFEN(expected, sizeof(expected));
+
+  // 完整日志：恢复出同一局面，末尾没有残缺数据
+  ChessBoard recovered;
+  uint8_t flags = 0;
+  char fen[FEN_BUFFER_SIZE];
+  CHECK(journal.recover(&file, recovered, flags));
+  recovered.writeFEN(fen, sizeof(fen));
+  CHECK(strcmp(fen, expected) == 0);
+  CHECK_EQ(flags, JOURNAL_FLAG_WHITE_PLAYER);
+  CHECK(!journal.hasTornTail());
+
+  // 模拟断电：最后一步只写了2字节，恢复到上一步，之后的追加接在有效记录后面
+  const uint8_t torn[2] = {0x12, 0x34};
+  CHECK(file.writeAt(expectedSize, torn, sizeof(torn)));
+  file.flush();
+  board.writeFEN(expected, sizeof(expected));
+  CHECK(journal.recover(&file, recovered, flags));
+  recovered.writeFEN(fen, sizeof(fen));
+  CHECK(strcmp(fen, expected) == 0);
+  CHECK(journal.hasTornTail());
+  CHECK_EQ(journal.size(), expectedSize);
+
+  // 中间记录损坏：CRC链断开，停在损坏记录之前
+  uint8_t byte;
+  uint32_t corrupt = expectedSize - 2 * JOURNAL_MOVE_SIZE;
+  CHECK(file.readAt(corrupt, &byte, 1));
+  byte ^= 0x40;
+  CHECK(file.writeAt(corrupt, &byte, 1));
+  file.flush();
+  CHECK(journal.recover(&file, recovered, flags));
+  CHECK_EQ(journal.size(), corrupt);
+  CHECK(!recovered.isCheckmate(WHITE) && recovered.getCurrentPlayer() == BLACK);
+
+  // 不是日志文件
+  CHECK(file.create(path));
+  CHECK(!journal.recover(&file, recovered, flags));
+  file.close();
+  remove(path);
+}
+
+static void testWriteQueueBatches() {
+  const char* path = "cardchess_test_queue.bin";
+  StdioBlockFile file;
+  QueuedBlockFile queue;
+  CHECK(file.create(path) && queue.attach(&file));
+
+  // 写入先留在缓冲区，sync() 后才落到文件
+  const uint8_t a[3] = {1, 2, 3};
+  const uint8_t b[2] = {4, 5};
+  CHECK(queue.seek(0) && queue.write(a, sizeof(a)) == sizeof(a));
+  CHECK(queue.write(b, sizeof(b)) == sizeof(b));
+  CHECK(queue.writeAt(10, b, sizeof(b)));
+  CHECK(queue.hasPending());
+  CHECK_EQ(file.size(), 0);
+  CHECK(queue.sync());
+  CHECK(!queue.hasPending());
+  CHECK_EQ(file.size(), 12);
+  uint8_t buffer[12];
+  CHECK(file.readAt(0, buffer, sizeof(buffer)));
+  CHECK(buffer[0] == 1 && buffer[4] == 5 && buffer[10] == 4 && buffer[11] == 5);
+
+  // 读取前自动写出待写数据
+  const uint8_t c[1] = {9};
+  CHECK(queue.writeAt(5, c, 1));
+  CHECK(queue.readAt(5, buffer, 1) && buffer[0] == 9);
+
+  // 超出缓冲区时退回同步写出，数据不丢也不乱序
+  uint8_t record[40];
+  for (int i = 0; i < 50; i++) {
+    memset(record, i, sizeof(record));
+    CHECK(queue.writeAt(i * sizeof(record), record, sizeof(record)));
+  }
+  CHECK(queue.sync());
+  CHECK_EQ(file.size(), 50 * sizeof(record));
+  for (int i = 0; i < 50; i++) {
+    CHECK(file.readAt(i * sizeof(record), record, sizeof(record)) && record[0] == i && record[39] == i);
+  }
+
+  // 经队列写对局日志，恢复结果与直接写相同
+  ChessBoard board;
+  board.initBoard();
+  GameJournal journal;
+  CHECK(file.create(path) && queue.attach(&file) && journal.start(&queue, board, 0));
+  Move move;
+  CHECK(board.parseSAN("e4", move) && board.makeMove(move) && journal.appendMove(move, board, 0));
+  CHECK(queue.sync());
+  ChessBoard recovered;
+  uint8_t flags;
+  CHECK(journal.recover(&file, recovered, flags));
+  CHECK(recovered.getPiece(4, 3).type == PAWN && recovered.getCurrentPlayer() == BLACK);
+  queue.attach(nullptr);
+  file.close();
+  remove(path);
+}
+
+static void testDirtyTrackerMergesRegions() {
+  DirtyTracker tracker(240, 135);
+  // 第一帧整屏重画，之后内容不变时没有脏矩形
+  tracker.beginFrame();
+  tracker.update(0, 1, 54, 1, 20, 20);
+  tracker.update(1, 1, 70, 1, 20, 20);
+  tracker.update(63, 1, 166, 113, 20, 20);
+  CHECK(tracker.isFullFrame());
+  tracker.endFrame();
+  tracker.beginFrame();
+  tracker.update(0, 1, 54, 1, 20, 20);
+  tracker.update(1, 1, 70, 1, 20, 20);
+  tracker.update(63, 1, 166, 113, 20, 20);
+  CHECK(!tracker.isFullFrame());
+  CHECK_EQ(tracker.getCount(), 0);
+  tracker.endFrame();
+
+  // 相隔很远的两格各自一个矩形，超出屏幕的部分被裁掉
+  tracker.beginFrame();
+  tracker.update(0, 2, 54, 1, 20, 20);
+  tracker.update(1, 1, 70, 1, 20, 20);
+  tracker.update(63, 2, 166, 123, 20, 20);
+  CHECK_EQ(tracker.getCount(), 2);
+  CHECK(tracker.getRect(0).x == 54 && tracker.getRect(0).w == 20);
+  CHECK(tracker.getRect(1).y == 123 && tracker.getRect(1).h == 12);
+  tracker.endFrame();
+
+  // 相邻的格子合并成一个矩形
+  tracker.beginFrame();
+  tracker.update(0, 3, 54, 1, 20, 20);
+  tracker.update(1, 3, 70, 1, 20, 20);
+  CHECK_EQ(tracker.getCount(), 1);
+  CHECK(tracker.getRect(0).x == 54 && tracker.getRect(0).w == 36 && tracker.getRect(0).h == 20);
+  tracker.endFrame();
+
+  // 超过上限时并入最近的矩形，总面积仍盖住所有变化
+  tracker.beginFrame();
+  for (int i = 0; i < 12; i++) {
+    tracker.update(10 + i, 4, i * 20, (i % 2) * 100, 10, 10);
+  }
+  CHECK(tracker.getCount() <= DIRTY_RECT_MAX);
+  for (int i = 0; i < 12; i++) {
+    bool covered = false;
+    for (int r = 0; r < tracker.getCount(); r++) {
+      const DirtyRect& rect = tracker.getRect(r);
+      covered = covered || (rect.x <= i * 20 && rect.y <= (i % 2) * 100 &&
+                            rect.x + rect.w >= i * 20 + 10 && rect.y + rect.h >= (i % 2) * 100 + 10);
+    }
+    CHECK(covered);
+  }
+  tracker.endFrame();
+
+  // 屏幕被其他界面覆盖后下一帧整屏重画
+  tracker.invalidate();
+  tracker.beginFrame();
+  CHECK(tracker.isFullFrame());
+}
+
+static void testDisplayPipelineFences() {
+  static uint16_t canvas[240 * 135];
+  for (int i = 0; i < 240 * 135; i++) {
+    canvas[i] = (uint16_t)(i * 7);
+  }
+  SimDisplayLink link(240, 135);
+  DisplayPipeline pipeline;
+  CHECK(!pipeline.present(canvas, 240, DirtyRect{0, 0, 240, 135}));
+  pipeline.begin(&link);
+
+  // 整屏分成多段传输，present() 返回时最后一段还在传
+  CHECK(pipeline.present(canvas, 240, DirtyRect{0, 0, 240, 135}));
+  int chunks = (135 + DISPLAY_STAGING_PIXELS / 240 - 1) / (DISPLAY_STAGING_PIXELS / 240);
+  CHECK_EQ(pipeline.getTransfers(), chunks);
+  CHECK(pipeline.isBusy());
+  CHECK_EQ(link.getCompleted(), chunks - 1);
+
+  // 传输进行中改写画布不影响屏幕，下一帧的矩形等上一次传输完成后才开始
+  for (int i = 0; i < 240 * 135; i++) {
+    canvas[i] = (uint16_t)~canvas[i];
+  }
+  CHECK(pipeline.present(canvas, 240, DirtyRect{54, 1, 36, 20}));
+  CHECK_EQ(pipeline.getStalls(), chunks);
+  CHECK_EQ(link.pixelAt(0, 134), (uint16_t)(134 * 240 * 7));
+  pipeline.finish();
+  CHECK(!pipeline.isBusy());
+  CHECK_EQ(link.pixelAt(54, 1), canvas[1 * 240 + 54]);
+  CHECK_EQ(link.pixelAt(89, 20), canvas[20 * 240 + 89]);
+  CHECK_EQ(link.pixelAt(90, 20), (uint16_t)((20 * 240 + 90) * 7));
+  CHECK_EQ(link.pixelAt(54, 21), (uint16_t)((21 * 240 + 54) * 7));
+
+  // 传输在下一帧前已完成时不用等待
+  link.complete();
+  pipeline.present(canvas, 240, DirtyRect{200, 100, 20, 20});
+  CHECK_EQ(pipeline.getStalls(), chunks);
+  pipeline.poll();
+  CHECK(pipeline.isBusy());
+  link.complete();
+  pipeline.poll();
+  CHECK_EQ(link.pixelAt(219, 119), canvas[119 * 240 + 219]);
+
+  // 8位画布按调色板转换
+  static uint8_t indexed[240 * 135];
+  uint16_t colors[256];
+  for (int i = 0; i < 256; i++) {
+    colors[i] = (uint16_t)(0x1000 + i);
+    indexed[i] = (uint8_t)(255 - i);
+  }
+  pipeline.setPalette(colors);
+  pipeline.present(indexed, 240, DirtyRect{10, 0, 100, 1});
+  pipeline.finish();
+  CHECK_EQ(link.pixelAt(10, 0), 0x1000 + 245);
+  CHECK_EQ(link.pixelAt(109, 0), 0x1000 + 146);
+  CHECK_EQ(link.getStarted(), link.getCompleted());
+}
+
+static void testMoveAnimationFrames() {
+  // 50fps：每20ms一帧，落后时跳过错过的帧而不是连画几帧
+  FrameScheduler frames(50);
+  CHECK(!frames.due(0));
+  frames.start(1000);
+  CHECK(frames.due(1000));
+  CHECK(!frames.due(1019));
+  CHECK(frames.due(1020));
+  CHECK(frames.due(1085));
+  CHECK_EQ(frames.getDropped(), 2);
+  CHECK(!frames.due(1099));
+  CHECK(frames.due(1100));
+  CHECK_EQ(frames.getFrames(), 4);
+
+  // 棋子从 (56,115) 滑到 (104,19)，位置单调靠近终点，每帧的矩形盖住上一帧和这一帧的棋子
+  MoveAnimation animation;
+  animation.begin(Piece(QUEEN, WHITE), 56, 115, 104, 19, 0, 180);
+  CHECK(animation.isActive());
+  int lastX = 56, lastY = 115;
+  bool finished = false;
+  for (uint32_t now = 20; !finished; now += 20) {
+    int x, y;
+    DirtyRect rect;
+    finished = animation.step(now, 16, x, y, rect);
+    CHECK(x >= lastX && y <= lastY);
+    CHECK(rect.x <= lastX && rect.x <= x && rect.y <= y && rect.y <= lastY);
+    CHECK(rect.x + rect.w >= lastX + 16 && rect.x + rect.w >= x + 16);
+    CHECK(rect.y + rect.h >= lastY + 16 && rect.y + rect.h >= y + 16);
+    // 矩形只有棋子经过的那一小块
+    CHECK(rect.w * rect.h < 48 * 48);
+    lastX = x;
+    lastY = y;
+    CHECK(now <= 180);
+  }
+  CHECK(lastX == 104 && lastY == 19);
+}
+
+static void countJobCall(void* arg) { (*(int*)arg)++; }
+
+static void testAiWorkerDiscardsCancelled() {
+  ChessBoard board;
+  board.initBoard();
+  AiWorker worker;
+  Move move;
+  CHECK(!worker.poll(move));
+  // 主机端同步搜索：start() 返回时结果已就绪，只能取一次
+  worker.start(board, Color::WHITE);
+  CHECK(!worker.isBusy());
+  CHECK(worker.poll(move));
+  CHECK(move.from.isValid() && move.to.isValid());
+  CHECK(board.getPiece(move.from).color == Color::WHITE);
+  CHECK(!worker.poll(move));
+
+  // 作废后结果不再交出
+  worker.start(board, Color::WHITE);
+  worker.cancel();
+  CHECK(!worker.poll(move));
+
+  // run() 返回时任务已经执行完
+  int calls = 0;
+  worker.run(countJobCall, &calls);
+  CHECK_EQ(calls, 1);
+  CHECK(!worker.isBusy());
+}
+
+static void testKeyEventsOnPress() {
+  KeyEventQueue events;
+  KeyEvent event;
+  // 按下产生一次带时刻的事件，按住不放不再产生（默认不自动重复）
+  const uint8_t pressA[] = {'a'};
+  events.scan(pressA, 1, 1000);
+  events.scan(pressA, 1, 2000);
+  CHECK(events.pop(event) && event.key == 'a' && !event.repeat);
+  CHECK_EQ(event.time, 1000u);
+  CHECK(!events.pop(event));
+
+  // 按住 a 再按 ; 和 /，只有新按下的两个键排队，按扫描顺序取出；修饰键不产生事件
+  const uint8_t chord[] = {'a', ';', 0x81, '/'};
+  events.scan(chord, 4, 2100);
+  CHECK(events.pop(event) && event.key == ';');
+  CHECK(events.pop(event) && event.key == '/');
+  CHECK(events.isEmpty());
+
+  // 松开超过防抖时间后再按同一个键又是一次事件
+  events.scan(nullptr, 0, 2200);
+  events.scan(pressA, 1, 2300);
+  CHECK(events.pop(event) && event.key == 'a');
+
+  // 处理慢时排队的事件不丢，超过上限的丢弃
+  uint32_t now = 3000;
+  for (int i = 0; i < KEY_QUEUE_SIZE + 4; i++) {
+    uint8_t k = (uint8_t)('0' + i % 2);
+    events.scan(&k, 1, now += 50);
+  }
+  int count = 0;
+  while (events.pop(event)) {
+    count++;
+  }
+  CHECK_EQ(count, KEY_QUEUE_SIZE);
+  CHECK_EQ(events.getDropped(), 4u);
+}
+
+static void testKeyEventsRepeatAndDebounce() {
+  KeyEventQueue events;
+  KeyRepeatConfig config = KeyEventQueue::defaultConfig();
+  config.keys = ";.";
+  config.debounceMs = 30;
+  config.repeatDelayMs = 300;
+  config.repeatIntervalMs = 100;
+  config.repeatMinIntervalMs = 60;
+  config.repeatAccelMs = 20;
+  events.configure(config);
+  KeyEvent event;
+
+  // 抖动：松开后 30ms 内又出现不算再按一次；不同的键各自防抖，快速连按两个键都不丢
+  const uint8_t up[] = {';'};
+  const uint8_t down[] = {'.'};
+  events.scan(up, 1, 0);
+  events.scan(nullptr, 0, 10);
+  events.scan(up, 1, 20);
+  events.scan(down, 1, 25);
+  CHECK(events.pop(event) && event.key == ';' && event.time == 0);
+  CHECK(events.pop(event) && event.key == '.' && event.time == 25);
+  CHECK(events.isEmpty());
+  events.scan(nullptr, 0, 100);
+
+  // 按住 ; 每 10ms 扫描一次：300ms 后开始重复，间隔 100、80、60、60……
+  uint32_t expected[] = {1300, 1400, 1480, 1540, 1600};
+  int repeats = 0;
+  for (uint32_t now = 1000; now <= 1600; now += 10) {
+    events.scan(up, 1, now);
+    while (events.pop(event)) {
+      if (now == 1000) {
+        CHECK(!event.repeat);
+        continue;
+      }
+      CHECK(event.repeat && event.key == ';');
+      CHECK(repeats < 5 && event.time == expected[repeats]);
+      repeats++;
+    }
+  }
+  CHECK_EQ(repeats, 5);
+
+  // 处理慢（一直不取）时同一个键的重复只排一个，松手后不会多走
+  events.scan(nullptr, 0, 1700);
+  events.scan(up, 1, 2000);
+  events.scan(up, 1, 2700);
+  events.scan(up, 1, 3400);
+  events.scan(nullptr, 0, 3500);
+  CHECK(events.pop(event) && !event.repeat && event.time == 2000);
+  CHECK(events.pop(event) && event.repeat && event.time == 2300);
+  CHECK(events.isEmpty());
+
+  // 不在重复列表里的键不重复
+  const uint8_t space[] = {' '};
+  events.scan(space, 1, 5000);
+  events.scan(space, 1, 6000);
+  CHECK(events.pop(event) && !event.repeat);
+  CHECK(events.isEmpty());
+  CHECK_EQ(events.getRepeats(), 6u);
+}
+
+static void testIdleGovernorDutyCycle() {
+  // 活动时 100Hz（10ms 一轮），空闲时 25Hz（40ms 一轮），空闲 3 秒后 light sleep
+  IdleGovernor governor(100, 25, 3000);
+  uint32_t rest;
+
+  // 有活动：工作 2ms，休息到 10ms
+  governor.beginLoop(0);
+  CHECK_EQ(governor.endLoop(2000, 2, true, true, rest), POWER_ACTIVE);
+  CHECK_EQ(rest, 8000u);
+  // 工作超过周期时不休息
+  governor.beginLoop(10000);
+  CHECK_EQ(governor.endLoop(25000, 25, true, true, rest), POWER_ACTIVE);
+  CHECK_EQ(rest, 0u);
+
+  // 刚空闲：40ms 一轮
+  governor.beginLoop(25000);
+  CHECK_EQ(governor.endLoop(26000, 26, false, true, rest), POWER_IDLE);
+  CHECK_EQ(rest, 39000u);
+  // 空闲超过 3 秒才 light sleep，不允许时保持 delay()
+  governor.beginLoop(65000);
+  CHECK_EQ(governor.endLoop(3026000, 3026, false, false, rest), POWER_IDLE);
+  governor.beginLoop(3065000);
+  CHECK_EQ(governor.endLoop(3066000, 3066, false, true, rest), POWER_SLEEP);
+  governor.beginLoop(3105000);
+
+  // 占空比 = 工作 / (工作 + 休息)，休息时间记在上一轮选定的状态上
+  const PowerStateStats& active = governor.getStats(POWER_ACTIVE);
+  CHECK_EQ(active.loops, 2u);
+  CHECK(active.awakeMicros == 17000 && active.restMicros == 8000);
+  CHECK_EQ(governor.getDutyPermille(POWER_ACTIVE), 680u);
+  CHECK_EQ(governor.getDutyPermille(POWER_SLEEP), 25u);
+  CHECK_EQ(governor.getStats(POWER_IDLE).loops, 2u);
+
+  governor.resetStats();
+  CHECK_EQ(governor.getDutyPermille(POWER_ACTIVE), 0u);
+
+  // micros() 回绕时照常计算
+  IdleGovernor wrapped(100, 25, 3000);
+  wrapped.beginLoop(0xFFFFF000u);
+  CHECK_EQ(wrapped.endLoop(0x00000F00u, 10, true, true, rest), POWER_ACTIVE);
+  CHECK_EQ(rest, 10000u - 0x1F00u);
+
+  // 空闲时的扫描周期短于按键防抖时间，按下超过防抖时间的键不会漏掉
+  CHECK(1000 / IDLE_LOOP_HZ < (int)KeyEventQueue::defaultConfig().debounceMs);
+}
+
+static void testTileBlitClipped() {
+  // 64×48 的缓冲区，图块放在 (40, 8)
+  const int width = 64, height = 48;
+  static TilePixel buffer[width * height];
+  static TilePixel tile[TILE_SIZE * TILE_SIZE];
+  for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++) tile[i] = 7;
+  for (int i = 0; i < width * height; i++) buffer[i] = 1;
+
+  // 裁剪矩形在纵向上盖住图块、横向上错开：什么也不写
+  blitTileClipped(buffer, width, tile, 40, 8, 0, 0, 16, height);
+  // 横向盖住、纵向错开
+  blitTileClipped(buffer, width, tile, 40, 8, 0, 30, width, 10);
+  int written = 0;
+  for (int i = 0; i < width * height; i++) written += buffer[i] != 1;
+  CHECK_EQ(written, 0);
+
+  // 部分重叠：只写交集 (44..55, 8..11)
+  blitTileClipped(buffer, width, tile, 40, 8, 44, 0, 12, 12);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      bool inside = x >= 44 && x < 56 && y >= 8 && y < 12;
+      CHECK_EQ(buffer[y * width + x], inside ? 7 : 1);
+    }
+  }
+}
+
+static void testTileCacheComposites() {
+  // 2×2 的图标：左上角是透明色，其余是图标颜色
+  static const uint16_t whiteIcon[4] = {0x0000, 0x1111, 0x2222, 0x3333};
+  static const uint16_t blackIcon[4] = {0xFFFF, 0x4444, 0x5555, 0x6666};
+  TileIcon icons[TILE_PIECES];
+  for (int i = 0; i < TILE_PIECES; i++) {
+    icons[i].pixels = i < 6 ? whiteIcon : blackIcon;
+    icons[i].transparent = i < 6 ? 0x0000 : 0xFFFF;
+  }
+  const uint16_t backgrounds[TILE_BACKGROUND_COUNT] = {0xA000, 0xB000, 0xC000, 0xD000};
+  static TileCache cache;
+  CHECK(cache.get(Piece(KING, WHITE), TILE_LIGHT) == nullptr);
+  cache.build(icons, 2, 2, backgrounds);
+  CHECK(cache.isBuilt());
+  CHECK_EQ(cache.getBytes(), TILE_PIECES * TILE_BACKGROUND_COUNT * TILE_SIZE * TILE_SIZE * sizeof(uint16_t));
+  CHECK(cache.get(Piece(), TILE_DARK) == nullptr);
+
+  // 图标居中，透明处和图标外都是底色
+  const int origin = (TILE_SIZE - 2) / 2;
+  const uint16_t* tile = cache.get(Piece(QUEEN, BLACK), TILE_DARK);
+  CHECK(tile != nullptr);
+  CHECK_EQ(tile[0], 0xB000);
+  CHECK_EQ(tile[origin * TILE_SIZE + origin], 0xB000);
+  CHECK_EQ(tile[origin * TILE_SIZE + origin + 1], 0x4444);
+  CHECK_EQ(tile[(origin + 1) * TILE_SIZE + origin + 1], 0x6666);
+  tile = cache.get(Piece(PAWN, WHITE), TILE_VALID_MOVE);
+  CHECK_EQ(tile[origin * TILE_SIZE + origin], 0xD000);
+  CHECK_EQ(tile[(origin + 1) * TILE_SIZE + origin], 0x2222);
+  CHECK(cache.get(Piece(PAWN, WHITE), TILE_LIGHT) != cache.get(Piece(PAWN, BLACK), TILE_LIGHT));
+}
+
+static void testCanvasPaletteIndexes() {
+  CanvasPalette palette;
+  CHECK_EQ(palette.add(0x0000), 0);
+  CHECK_EQ(palette.add(0xFFFF), 1);
+  CHECK_EQ(palette.add(0x0000), 0);
+  const uint16_t icon[6] = {0xFFFF, 0x9AD6, 0x9AD6, 0x1082, 0xFFFF, 0x3C6A};
+  palette.addImage(icon, 6, 0xFFFF);
+  CHECK_EQ(palette.getCount(), 5);
+  CHECK_EQ(palette.indexOf(0x1082), 3);
+  // 不在调色板中的颜色取最接近的
+  CHECK_EQ(palette.indexOf(0x0020), 0);
+  CHECK_EQ(palette.indexOf(0xFFDF), 1);
+
+  // 565 -> 888 -> 565 还原出原值，8位调色板不损失颜色
+  for (uint32_t color = 0; color < 0x10000; color++) {
+    uint8_t r, g, b;
+    CanvasPalette::toRGB888((uint16_t)color, r, g, b);
+    CHECK_EQ(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3), (int)color);
+  }
+
+  // 图块按下标合成
+  TileIcon icons[TILE_PIECES];
+  for (int i = 0; i < TILE_PIECES; i++) {
+    icons[i].pixels = icon;
+    icons[i].transparent = 0xFFFF;
+  }
+  const uint16_t backgrounds[TILE_BACKGROUND_COUNT] = {0x3C6A, 0x0000, 0xFFFF, 0x9AD6};
+  static TileCache cache;
+  cache.build(icons, 3, 2, backgrounds, &palette);
+  const TilePixel* tile = cache.get(Piece(ROOK, WHITE), TILE_LIGHT);
+  const int left = (TILE_SIZE - 3) / 2;
+  const int top = (TILE_SIZE - 2) / 2;
+  CHECK_EQ(tile[0], 4);
+  CHECK_EQ(tile[top * TILE_SIZE + left], 4);
+  CHECK_EQ(tile[top * TILE_SIZE + left + 1], 2);
+  CHECK_EQ(tile[(top + 1) * TILE_SIZE + left], 3);
+}
+
+static void testIconCodecRoundTrip() {
+  // 生成的压缩图标逐像素还原出原图
+  const IconBitmap* bitmaps[] = {&WHITE_KING_ICON, &WHITE_KNIGHT_ICON, &BLACK_QUEEN_ICON, &BLACK_PAWN_ICON};
+  const uint16_t* sources[] = {whiteKingData, whiteKnightData, blackQueenData, blackPawnData};
+  uint16_t pixels[196];
+  for (int i = 0; i < 4; i++) {
+    CHECK(decodeIcon(*bitmaps[i], pixels));
+    CHECK(memcmp(pixels, sources[i], sizeof(pixels)) == 0);
+  }
+  CHECK(WHITE_KNIGHT_ICON.bits == 1 && BLACK_QUEEN_ICON.bits == 5);
+
+  // 超过128像素的游程、跨字节的下标
+  uint16_t image[20 * 20];
+  for (int i = 0; i < 20 * 20; i++) {
+    image[i] = i < 150 || i % 7 == 0 ? 0xFFFF : (uint16_t)(i % 23);
+  }
+  std::vector<uint16_t> palette;
+  std::vector<uint8_t> data;
+  uint8_t bits;
+  encodeIcon(image, 20, 20, 0xFFFF, palette, bits, data);
+  CHECK_EQ((int)palette.size(), 23);
+  CHECK_EQ(bits, 5);
+  IconBitmap icon = {20, 20, bits, 0xFFFF, palette.data(), data.data(), (uint16_t)data.size()};
+  uint16_t decoded[20 * 20];
+  CHECK(decodeIcon(icon, decoded));
+  CHECK(memcmp(decoded, image, sizeof(image)) == 0);
+
+  // 截断的数据被拒绝
+  icon.size--;
+  CHECK(!decodeIcon(icon, decoded));
+}
+
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+static const TestCase TESTS[] = {
+  {"perft_start_position", testPerftStartPosition},
+  {"perft_reference_positions", testPerftReferencePositions},
+  {"pawn_double_push_blocked", testPawnDoublePushBlocked},
+  {"make_move_promotion", testMakeMovePromotion},
+  {"fen_round_trip", testFENRoundTrip},
+  {"fen_rejects_malformed", testFENRejectsMalformed},
+  {"fen_tracks_moves", testFENTracksMoves},
+  {"parse_san", testParseSAN},
+  {"format_san", testFormatSAN},
+  {"search_finds_mate_in_one", testSearchFindsMateInOne},
+  {"search_is_deterministic", testSearchIsDeterministic},
+  {"pick_ai_move_is_seeded", testPickAIMoveIsSeeded},
+  {"serial_log_mute_keeps_switch", testSerialLogMuteKeepsSwitch},
+  {"legal_target_cache", testLegalTargetCache},
+  {"bench_signature", testBenchSignature},
+  {"uci_move_text", testUciMoveText},
+  {"builtin_puzzles_load", testBuiltinPuzzlesLoad},
+  {"puzzle_pack_round_trip", testPuzzlePackRoundTrip},
+  {"puzzle_pack_random_access", testPuzzlePackRandomAccess},
+  {"puzzle_index_rating_band", testPuzzleIndexRatingBand},
+  {"text_puzzles_match_builtin", testTextPuzzlesMatchBuiltin},
+  {"text_puzzle_streaming", testTextPuzzleStreaming},
+  {"puzzle_progress_in_place", testPuzzleProgressInPlace},
+  {"game_record_undo_redo_seek", testGameRecordUndoRedoSeek},
+  {"game_journal_recovery", testGameJournalRecovery},
+  {"pgn_export_import", testPgnExportImport},
+  {"pgn_reader_seeks_large_file", testPgnReaderSeeksLargeFile},
+  {"write_queue_batches", testWriteQueueBatches},
+  {"dirty_tracker_merges_regions", testDirtyTrackerMergesRegions},
+  {"display_pipeline_fences", testDisplayPipelineFences},
+  {"move_animation_frames", testMoveAnimationFrames},
+  {"ai_worker_discards_cancelled", testAiWorkerDiscardsCancelled},
+  {"key_events_on_press", testKeyEventsOnPress},
+  {"key_events_repeat_and_debounce", testKeyEventsRepeatAndDebounce},
+  {"idle_governor_duty_cycle", testIdleGovernorDutyCycle},
+  {"tile_blit_clipped", testTileBlitClipped},
+  {"tile_cache_composites", testTileCacheComposites},
+  {"canvas_palette_indexes", testCanvasPaletteIndexes},
+  {"icon_codec_round_trip", testIconCodecRoundTrip},
+};
+
+int main(int argc, char** argv) {
+  setSerialLogEnabled(false);
+
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  int run = 0;
+  for (size_t i = 0; i < sizeof(TESTS) / sizeof(TESTS[0]); i++) {
+    if (filter != nullptr && strstr(TESTS[i].name, filter) == nullptr) {
+      continue;
+    }
+    int before = failures;
+    TESTS[i].run();
+    printf("%s %s\n", failures == before ? "[ OK ]" : "[FAIL]", TESTS[i].name);
+    run++;
+  }
+  printf("%d tests, %d failures\n", run, failures);
+  return failures == 0 ? 0 : 1;
+}
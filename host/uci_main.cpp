@@ -0,0 +1,20 @@
+// 主机端 UCI 引擎入口：从 stdin 逐行读取命令，应答写到 stdout
+// 用法示例：cutechess-cli -engine cmd=./cardchess_uci ...
+#include "common.h"
+#include "uci.h"
+#include <iostream>
+#include <string>
+
+int main() {
+  // 关闭 movePiece 等处的调试输出，避免污染 UCI 协议流
+  setSerialLogEnabled(false);
+
+  UciSession session;
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (!session.handleLine(line.c_str())) {
+      break;
+    }
+  }
+  return 0;
+}
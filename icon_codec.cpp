@@ -0,0 +1,91 @@
+#include "icon_codec.h"
+
+const int ICON_MAX_RUN = 128;
+
+bool decodeIcon(const IconBitmap& icon, uint16_t* out) {
+  int total = icon.width * icon.height;
+  uint16_t mask = (uint16_t)((1 << icon.bits) - 1);
+  int pos = 0;
+  int offset = 0;
+  while (pos < total) {
+    if (offset >= icon.size) {
+      return false;
+    }
+    uint8_t token = pgm_read_byte(&icon.data[offset++]);
+    int run = (token & 0x7F) + 1;
+    if (pos + run > total) {
+      return false;
+    }
+    if ((token & 0x80) == 0) {
+      for (int i = 0; i < run; i++) {
+        out[pos++] = icon.transparent;
+      }
+      continue;
+    }
+    uint16_t acc = 0;
+    int accBits = 0;
+    for (int i = 0; i < run; i++) {
+      if (accBits < icon.bits) {
+        if (offset >= icon.size) {
+          return false;
+        }
+        acc = (uint16_t)((acc << 8) | pgm_read_byte(&icon.data[offset++]));
+        accBits += 8;
+      }
+      accBits -= icon.bits;
+      out[pos++] = pgm_read_word(&icon.palette[(acc >> accBits) & mask]);
+    }
+  }
+  return offset == icon.size;
+}
+
+void encodeIcon(const uint16_t* pixels, int width, int height, uint16_t transparent,
+                std::vector<uint16_t>& palette, uint8_t& bits, std::vector<uint8_t>& data) {
+  int total = width * height;
+  palette.clear();
+  data.clear();
+  std::vector<uint8_t> indexes(total, 0);
+  for (int i = 0; i < total; i++) {
+    if (pixels[i] == transparent) {
+      continue;
+    }
+    size_t index = 0;
+    while (index < palette.size() && palette[index] != pixels[i]) {
+      index++;
+    }
+    if (index == palette.size()) {
+      palette.push_back(pixels[i]);
+    }
+    indexes[i] = (uint8_t)index;
+  }
+  bits = 1;
+  while ((1u << bits) < palette.size()) {
+    bits++;
+  }
+
+  int pos = 0;
+  while (pos < total) {
+    bool opaque = pixels[pos] != transparent;
+    int run = 1;
+    while (pos + run < total && run < ICON_MAX_RUN && (pixels[pos + run] != transparent) == opaque) {
+      run++;
+    }
+    data.push_back((uint8_t)((opaque ? 0x80 : 0) | (run - 1)));
+    if (opaque) {
+      uint32_t acc = 0;
+      int accBits = 0;
+      for (int i = 0; i < run; i++) {
+        acc = (acc << bits) | indexes[pos + i];
+        accBits += bits;
+        while (accBits >= 8) {
+          accBits -= 8;
+          data.push_back((uint8_t)(acc >> accBits));
+        }
+      }
+      if (accBits > 0) {
+        data.push_back((uint8_t)(acc << (8 - accBits)));
+      }
+    }
+    pos += run;
+  }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// 压缩图标：每个图标有自己的小调色板（不含透明色），像素按行依次编码为游程
+//   记号字节 0xxxxxxx：接下来 x+1 个像素是透明色
+//   记号字节 1xxxxxxx：接下来 x+1 个像素不透明，后面紧跟它们的调色板下标，
+//                      每个 bits 位、高位在前，这一段末尾补齐到整字节
+//   bits 取能容纳调色板的最小位数（1-8），只有两三种颜色的白棋是 1-2 位，带抗锯齿灰阶的黑棋是 4-5 位
+struct IconBitmap {
+  uint8_t width;
+  uint8_t height;
+  uint8_t bits;
+  uint16_t transparent;     // 解码后透明像素的颜色（与原始图标的透明色相同）
+  const uint16_t* palette;  // PROGMEM
+  const uint8_t* data;      // PROGMEM
+  uint16_t size;            // data 的字节数
+};
+
+// 解码到 out（width*height 个 RGB565 像素），数据损坏时返回false
+bool decodeIcon(const IconBitmap& icon, uint16_t* out);
+
+// 编码一个 RGB565 图标（生成器和测试用），palette/bits/data 为输出
+void encodeIcon(const uint16_t* pixels, int width, int height, uint16_t transparent,
+                std::vector<uint16_t>& palette, uint8_t& bits, std::vector<uint8_t>& data);
@@ -0,0 +1,169 @@
+// 由 tools/icon_pack 根据 tools/icon_source.h 生成，不要手工修改
+// 重新生成：构建 CMake 的 icon_data 目标
+// 12 个图标：原始 RGB565 4704 字节，压缩后 1150 字节
+#pragma once
+#include "icon_codec.h"
+
+// 2 colors, 1 bpp, 62 bytes
+static const uint16_t WHITE_KING_PALETTE[2] PROGMEM = {0x9AD6, 0xB5B6};
+static const uint8_t WHITE_KING_DATA[62] PROGMEM = {
+  0x13, 0x80, 0x00, 0x0B, 0x82, 0x00, 0x0A, 0x82, 0x00, 0x08, 0x81, 0xC0,
+  0x00, 0x81, 0x00, 0x00, 0x80, 0x80, 0x05, 0x89, 0x00, 0x00, 0x03, 0x81,
+  0x00, 0x01, 0x81, 0x00, 0x01, 0x81, 0x00, 0x03, 0x81, 0x00, 0x01, 0x81,
+  0x00, 0x01, 0x81, 0x00, 0x03, 0x82, 0x00, 0x00, 0x81, 0x00, 0x00, 0x82,
+  0x00, 0x04, 0x86, 0x00, 0x0C, 0x80, 0x00, 0x06, 0x87, 0x00, 0x05, 0x87,
+  0x00, 0x10
+};
+static const IconBitmap WHITE_KING_ICON = {14, 14, 1, 0x0000, WHITE_KING_PALETTE, WHITE_KING_DATA, 62};
+
+// 3 colors, 2 bpp, 64 bytes
+static const uint16_t WHITE_QUEEN_PALETTE[3] PROGMEM = {0x9AD6, 0xCE59, 0x8410};
+static const uint8_t WHITE_QUEEN_DATA[64] PROGMEM = {
+  0x2D, 0x81, 0x00, 0x00, 0x81, 0x00, 0x08, 0x81, 0x00, 0x00, 0x81, 0x00,
+  0x06, 0x80, 0x00, 0x01, 0x80, 0x00, 0x00, 0x81, 0x10, 0x00, 0x81, 0x00,
+  0x03, 0x80, 0x00, 0x01, 0x80, 0x00, 0x00, 0x81, 0x00, 0x00, 0x81, 0x00,
+  0x04, 0x80, 0x00, 0x00, 0x85, 0x00, 0x00, 0x05, 0x86, 0x00, 0x00, 0x07,
+  0x85, 0x00, 0x00, 0x07, 0x84, 0x00, 0x00, 0x07, 0x86, 0x80, 0x00, 0x06,
+  0x86, 0x00, 0x00, 0x11
+};
+static const IconBitmap WHITE_QUEEN_ICON = {14, 14, 2, 0x0000, WHITE_QUEEN_PALETTE, WHITE_QUEEN_DATA, 64};
+
+// 3 colors, 2 bpp, 41 bytes
+static const uint16_t WHITE_ROOK_PALETTE[3] PROGMEM = {0x9AD6, 0xF79E, 0xBDD7};
+static const uint8_t WHITE_ROOK_DATA[41] PROGMEM = {
+  0x3B, 0x80, 0x00, 0x00, 0x81, 0x00, 0x00, 0x80, 0x40, 0x07, 0x85, 0x00,
+  0x00, 0x07, 0x84, 0x00, 0x00, 0x09, 0x83, 0x00, 0x08, 0x84, 0x00, 0x00,
+  0x08, 0x84, 0x80, 0x00, 0x08, 0x84, 0x00, 0x00, 0x08, 0x85, 0x00, 0x00,
+  0x06, 0x87, 0x00, 0x00, 0x10
+};
+static const IconBitmap WHITE_ROOK_ICON = {14, 14, 2, 0x0000, WHITE_ROOK_PALETTE, WHITE_ROOK_DATA, 41};
+
+// 2 colors, 1 bpp, 43 bytes
+static const uint16_t WHITE_BISHOP_PALETTE[2] PROGMEM = {0x3186, 0x9AD6};
+static const uint8_t WHITE_BISHOP_DATA[43] PROGMEM = {
+  0x13, 0x80, 0x00, 0x0C, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0B, 0x81, 0xC0,
+  0x00, 0x80, 0x80, 0x08, 0x81, 0xC0, 0x01, 0x81, 0xC0, 0x07, 0x81, 0xC0,
+  0x00, 0x82, 0xE0, 0x07, 0x85, 0xFC, 0x07, 0x85, 0xFC, 0x08, 0x83, 0xF0,
+  0x07, 0x86, 0xFE, 0x06, 0x87, 0xFF, 0x1E
+};
+static const IconBitmap WHITE_BISHOP_ICON = {14, 14, 1, 0x0000, WHITE_BISHOP_PALETTE, WHITE_BISHOP_DATA, 43};
+
+// 1 colors, 1 bpp, 37 bytes
+static const uint16_t WHITE_KNIGHT_PALETTE[1] PROGMEM = {0x9AD6};
+static const uint8_t WHITE_KNIGHT_DATA[37] PROGMEM = {
+  0x2E, 0x80, 0x00, 0x0B, 0x83, 0x00, 0x08, 0x85, 0x00, 0x07, 0x86, 0x00,
+  0x05, 0x83, 0x00, 0x00, 0x82, 0x00, 0x05, 0x81, 0x00, 0x01, 0x83, 0x00,
+  0x08, 0x84, 0x00, 0x07, 0x85, 0x00, 0x07, 0x85, 0x00, 0x06, 0x87, 0x00,
+  0x10
+};
+static const IconBitmap WHITE_KNIGHT_ICON = {14, 14, 1, 0x0000, WHITE_KNIGHT_PALETTE, WHITE_KNIGHT_DATA, 37};
+
+// 3 colors, 2 bpp, 55 bytes
+static const uint16_t WHITE_PAWN_PALETTE[3] PROGMEM = {0x9AD6, 0xB5B6, 0x4A49};
+static const uint8_t WHITE_PAWN_DATA[55] PROGMEM = {
+  0x06, 0x80, 0x00, 0x0A, 0x83, 0x40, 0x09, 0x84, 0x00, 0x00, 0x08, 0x84,
+  0x00, 0x00, 0x09, 0x82, 0x00, 0x09, 0x84, 0x00, 0x80, 0x08, 0x84, 0x00,
+  0x00, 0x09, 0x82, 0x00, 0x0A, 0x82, 0x00, 0x09, 0x84, 0x00, 0x00, 0x07,
+  0x86, 0x00, 0x00, 0x05, 0x88, 0x00, 0x00, 0x00, 0x03, 0x89, 0x00, 0x00,
+  0x00, 0x03, 0x89, 0x00, 0x00, 0x00, 0x01
+};
+static const IconBitmap WHITE_PAWN_ICON = {14, 14, 2, 0x0000, WHITE_PAWN_PALETTE, WHITE_PAWN_DATA, 55};
+
+// 18 colors, 5 bpp, 126 bytes
+static const uint16_t BLACK_KING_PALETTE[18] PROGMEM = {0xDEDB, 0x0861, 0x4208, 0x6B6D, 0x0000, 0x5ACB, 0x94B2, 0xEF5D,
+  0xF79E, 0xE71C, 0x2124, 0xE73C, 0x4228, 0x4A69, 0x1082, 0x4A49,
+  0x8C51, 0x18C3};
+static const uint8_t BLACK_KING_DATA[126] PROGMEM = {
+  0x05, 0x81, 0x00, 0x40, 0x09, 0x84, 0x10, 0xC8, 0x32, 0x00, 0x08, 0x84,
+  0x11, 0x08, 0x42, 0x00, 0x07, 0x80, 0x28, 0x00, 0x82, 0x29, 0x08, 0x00,
+  0x81, 0x29, 0x40, 0x03, 0x8B, 0x31, 0x08, 0x42, 0x10, 0x84, 0x21, 0x08,
+  0x70, 0x00, 0x8C, 0x21, 0x08, 0x42, 0x10, 0x84, 0x21, 0x08, 0x42, 0x00,
+  0x01, 0x81, 0x21, 0x00, 0x01, 0x83, 0x21, 0x08, 0x80, 0x00, 0x87, 0x21,
+  0x08, 0x95, 0x10, 0x8B, 0x00, 0x82, 0x21, 0x08, 0x01, 0x87, 0x21, 0x08,
+  0x95, 0x90, 0x84, 0x00, 0x82, 0x21, 0x08, 0x00, 0x83, 0x21, 0x08, 0xC0,
+  0x01, 0x8A, 0x69, 0x08, 0x42, 0x10, 0x84, 0x21, 0x1C, 0x03, 0x88, 0x29,
+  0x08, 0x42, 0x10, 0x84, 0x20, 0x04, 0x80, 0x78, 0x06, 0x80, 0x20, 0x04,
+  0x89, 0x21, 0x08, 0x42, 0x10, 0x84, 0x24, 0x00, 0x03, 0x89, 0x21, 0x08,
+  0x42, 0x10, 0x84, 0x24, 0x40, 0x01
+};
+static const IconBitmap BLACK_KING_ICON = {14, 14, 5, 0xFFFF, BLACK_KING_PALETTE, BLACK_KING_DATA, 126};
+
+// 22 colors, 5 bpp, 126 bytes
+static const uint16_t BLACK_QUEEN_PALETTE[22] PROGMEM = {0x1082, 0x0000, 0x0861, 0x2104, 0x52AA, 0x528A, 0xCE59, 0xFFDF,
+  0x9492, 0x2945, 0x6B6D, 0x2124, 0xD69A, 0xBDF7, 0x31A6, 0x5ACB,
+  0x39C7, 0x738E, 0x2965, 0x10A2, 0xF79E, 0x4228};
+static const uint8_t BLACK_QUEEN_DATA[126] PROGMEM = {
+  0x03, 0x81, 0x00, 0x40, 0x01, 0x81, 0x10, 0x40, 0x06, 0x87, 0x18, 0x42,
+  0x40, 0x84, 0x25, 0x05, 0x86, 0x30, 0x42, 0x74, 0x04, 0x20, 0x03, 0x82,
+  0x48, 0x42, 0x00, 0x85, 0x08, 0x4E, 0x40, 0x8C, 0x00, 0x85, 0x28, 0x54,
+  0x10, 0x84, 0x00, 0x85, 0x08, 0x42, 0x10, 0x84, 0x00, 0x8F, 0x08, 0x56,
+  0xC0, 0x85, 0xA1, 0x08, 0x42, 0x10, 0xB8, 0x21, 0x01, 0x8A, 0x78, 0x42,
+  0x10, 0x84, 0x21, 0x08, 0x42, 0x03, 0x89, 0x08, 0x42, 0x10, 0x84, 0x21,
+  0x08, 0x40, 0x03, 0x89, 0x80, 0x42, 0x10, 0x84, 0x21, 0x0C, 0x40, 0x04,
+  0x87, 0x08, 0x42, 0x10, 0x84, 0x21, 0x05, 0x87, 0x08, 0x42, 0x10, 0x84,
+  0x32, 0x04, 0x80, 0x98, 0x02, 0x81, 0xA5, 0x00, 0x02, 0x80, 0xA8, 0x03,
+  0x89, 0x08, 0x42, 0x10, 0x84, 0x21, 0x08, 0x40, 0x03, 0x89, 0x08, 0x42,
+  0x10, 0x84, 0x21, 0x08, 0x40, 0x01
+};
+static const IconBitmap BLACK_QUEEN_ICON = {14, 14, 5, 0xFFFF, BLACK_QUEEN_PALETTE, BLACK_QUEEN_DATA, 126};
+
+// 15 colors, 4 bpp, 105 bytes
+static const uint16_t BLACK_ROOK_PALETTE[15] PROGMEM = {0xC618, 0x1082, 0x0000, 0x7BCF, 0xD6BA, 0x0020, 0x73AE, 0xD69A,
+  0x8410, 0xBDF7, 0xB596, 0x31A6, 0x5AEB, 0x18C3, 0xEF5D};
+static const uint8_t BLACK_ROOK_DATA[105] PROGMEM = {
+  0x01, 0x81, 0x01, 0x00, 0x82, 0x22, 0x20, 0x00, 0x81, 0x13, 0x05, 0x84,
+  0x24, 0x22, 0x20, 0x00, 0x81, 0x52, 0x04, 0x88, 0x62, 0x22, 0x22, 0x22,
+  0x20, 0x04, 0x88, 0x22, 0x22, 0x22, 0x22, 0x20, 0x04, 0x88, 0x72, 0x22,
+  0x22, 0x22, 0x80, 0x05, 0x86, 0x22, 0x22, 0x22, 0x20, 0x06, 0x86, 0x22,
+  0x22, 0x22, 0x20, 0x06, 0x86, 0x22, 0x22, 0x22, 0x20, 0x06, 0x86, 0x22,
+  0x22, 0x22, 0x20, 0x06, 0x87, 0x22, 0x22, 0x22, 0x29, 0x04, 0x88, 0xA2,
+  0x22, 0x22, 0x22, 0xB0, 0x03, 0x80, 0xC0, 0x00, 0x86, 0xDD, 0xD2, 0x1D,
+  0xD0, 0x00, 0x80, 0x20, 0x02, 0x8B, 0x22, 0x22, 0x22, 0x22, 0x22, 0x2E,
+  0x01, 0x8B, 0x22, 0x22, 0x22, 0x22, 0x22, 0x2E, 0x00
+};
+static const IconBitmap BLACK_ROOK_ICON = {14, 14, 4, 0xFFFF, BLACK_ROOK_PALETTE, BLACK_ROOK_DATA, 105};
+
+// 16 colors, 4 bpp, 88 bytes
+static const uint16_t BLACK_BISHOP_PALETTE[16] PROGMEM = {0x18E3, 0x0000, 0xD6BA, 0x6B4D, 0x632C, 0xDEDB, 0x8C71, 0xAD75,
+  0xF7BE, 0x2945, 0x8C51, 0x1082, 0x630C, 0x39E7, 0xD69A, 0x52AA};
+static const uint8_t BLACK_BISHOP_DATA[88] PROGMEM = {
+  0x05, 0x81, 0x01, 0x0A, 0x82, 0x21, 0x10, 0x0A, 0x82, 0x34, 0x10, 0x09,
+  0x82, 0x56, 0x10, 0x00, 0x81, 0x17, 0x07, 0x82, 0x81, 0x10, 0x00, 0x81,
+  0x11, 0x06, 0x83, 0x91, 0x11, 0x00, 0x82, 0x11, 0x10, 0x05, 0x87, 0xA1,
+  0x1B, 0xC1, 0x11, 0x06, 0x86, 0x11, 0x11, 0x11, 0x10, 0x05, 0x87, 0x11,
+  0x11, 0x11, 0x11, 0x05, 0x87, 0xD1, 0x11, 0x11, 0x11, 0x06, 0x85, 0x11,
+  0x11, 0x11, 0x05, 0x80, 0xE0, 0x02, 0x80, 0x80, 0x03, 0x80, 0xF0, 0x03,
+  0x8A, 0x11, 0x11, 0x11, 0x11, 0x11, 0x80, 0x02, 0x8A, 0x11, 0x11, 0x11,
+  0x11, 0x11, 0x80, 0x00
+};
+static const IconBitmap BLACK_BISHOP_ICON = {14, 14, 4, 0xFFFF, BLACK_BISHOP_PALETTE, BLACK_BISHOP_DATA, 88};
+
+// 18 colors, 5 bpp, 109 bytes
+static const uint16_t BLACK_KNIGHT_PALETTE[18] PROGMEM = {0x0000, 0x4228, 0x9CD3, 0x528A, 0x52AA, 0x9CF3, 0xEF7D, 0xD69A,
+  0xAD75, 0x39E7, 0x3186, 0xDEFB, 0x6B6D, 0x8430, 0xD6BA, 0x4208,
+  0x31A6, 0x4A49};
+static const uint8_t BLACK_KNIGHT_DATA[109] PROGMEM = {
+  0x04, 0x80, 0x00, 0x0B, 0x83, 0x08, 0x80, 0x30, 0x08, 0x86, 0x21, 0x40,
+  0x00, 0x00, 0x00, 0x07, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x89,
+  0x31, 0xC0, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x88, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x02, 0x8A, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
+  0x02, 0x83, 0x00, 0x00, 0xA0, 0x00, 0x85, 0x58, 0x00, 0x00, 0x00, 0x03,
+  0x81, 0x23, 0x00, 0x00, 0x86, 0x68, 0x00, 0x00, 0x00, 0x00, 0x05, 0x87,
+  0x70, 0x00, 0x00, 0x00, 0x00, 0x05, 0x87, 0x00, 0x00, 0x00, 0x00, 0x0F,
+  0x04, 0x80, 0x00, 0x06, 0x80, 0x80, 0x03, 0x8A, 0x30, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x22, 0x02, 0x8A, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E,
+  0x00
+};
+static const IconBitmap BLACK_KNIGHT_ICON = {14, 14, 5, 0xFFFF, BLACK_KNIGHT_PALETTE, BLACK_KNIGHT_DATA, 109};
+
+// 8 colors, 3 bpp, 72 bytes
+static const uint16_t BLACK_PAWN_PALETTE[8] PROGMEM = {0x10A2, 0x0000, 0x4208, 0xD6BA, 0x8410, 0x2965, 0xBDF7, 0xAD75};
+static const uint8_t BLACK_PAWN_DATA[72] PROGMEM = {
+  0x05, 0x82, 0x04, 0x00, 0x09, 0x84, 0x44, 0x92, 0x08, 0x84, 0x44, 0x92,
+  0x08, 0x84, 0x24, 0x92, 0x08, 0x84, 0x04, 0x90, 0x07, 0x86, 0x70, 0x92,
+  0x58, 0x06, 0x86, 0x04, 0x92, 0x68, 0x08, 0x82, 0x24, 0x80, 0x09, 0x84,
+  0x84, 0x98, 0x08, 0x84, 0xC4, 0x92, 0x06, 0x88, 0x98, 0x92, 0x49, 0xE0,
+  0x03, 0x80, 0x60, 0x00, 0x88, 0x24, 0x92, 0x49, 0x60, 0x02, 0x8A, 0x24,
+  0x92, 0x49, 0x24, 0x00, 0x02, 0x8A, 0x24, 0x92, 0x49, 0x24, 0x80, 0x00
+};
+static const IconBitmap BLACK_PAWN_ICON = {14, 14, 3, 0xFFFF, BLACK_PAWN_PALETTE, BLACK_PAWN_DATA, 72};
@@ -0,0 +1,110 @@
+#include "key_events.h"
+#include <string.h>
+
+KeyEventQueue::KeyEventQueue()
+    : config(defaultConfig()), heldCount(0), head(0), count(0), presses(0), repeats(0), dropped(0) {}
+
+KeyRepeatConfig KeyEventQueue::defaultConfig() {
+  KeyRepeatConfig repeatConfig;
+  repeatConfig.keys = nullptr;
+  repeatConfig.debounceMs = 30;
+  repeatConfig.repeatDelayMs = 350;
+  repeatConfig.repeatIntervalMs = 150;
+  repeatConfig.repeatMinIntervalMs = 60;
+  repeatConfig.repeatAccelMs = 15;
+  return repeatConfig;
+}
+
+int KeyEventQueue::findHeld(uint8_t key) const {
+  for (int i = 0; i < heldCount; i++) {
+    if (held[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool KeyEventQueue::canRepeat(uint8_t key) const {
+  return config.keys != nullptr && strchr(config.keys, (char)key) != nullptr;
+}
+
+bool KeyEventQueue::hasQueuedRepeat(uint8_t key) const {
+  for (int i = 0; i < count; i++) {
+    const KeyEvent& event = events[(head + i) % KEY_QUEUE_SIZE];
+    if (event.repeat && event.key == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool KeyEventQueue::push(uint8_t key, bool repeat, uint32_t time) {
+  if (count >= KEY_QUEUE_SIZE) {
+    dropped++;
+    return false;
+  }
+  KeyEvent& event = events[(head + count) % KEY_QUEUE_SIZE];
+  event.key = key;
+  event.repeat = repeat;
+  event.time = time;
+  count++;
+  return true;
+}
+
+void KeyEventQueue::scan(const uint8_t* keys, int keyCount, uint32_t now) {
+  for (int i = 0; i < keyCount; i++) {
+    uint8_t key = keys[i];
+    if (isModifier(key)) {
+      continue;
+    }
+    int index = findHeld(key);
+    if (index >= 0) {
+      // 按住不放（或防抖时间内又出现）：到时间就重复，用差值比较以免 millis() 回绕出错
+      HeldKey& heldKey = held[index];
+      heldKey.lastSeen = now;
+      if (canRepeat(key) && (int32_t)(now - heldKey.nextRepeat) >= 0) {
+        // 处理慢时只补一次，不追赶错过的重复
+        if (!hasQueuedRepeat(key) && push(key, true, heldKey.nextRepeat)) {
+          repeats++;
+        }
+        heldKey.nextRepeat = now + heldKey.interval;
+        if (heldKey.interval > config.repeatMinIntervalMs + config.repeatAccelMs) {
+          heldKey.interval -= config.repeatAccelMs;
+        } else {
+          heldKey.interval = config.repeatMinIntervalMs;
+        }
+      }
+      continue;
+    }
+    if (heldCount >= KEY_SCAN_MAX) {
+      continue;
+    }
+    HeldKey& heldKey = held[heldCount++];
+    heldKey.key = key;
+    heldKey.lastSeen = now;
+    heldKey.nextRepeat = now + config.repeatDelayMs;
+    heldKey.interval = config.repeatIntervalMs;
+    if (push(key, false, now)) {
+      presses++;
+    }
+  }
+
+  // 这次没扫描到、且已超过防抖时间的键视为松开
+  int kept = 0;
+  for (int i = 0; i < heldCount; i++) {
+    if ((uint32_t)(now - held[i].lastSeen) < config.debounceMs || held[i].lastSeen == now) {
+      held[kept++] = held[i];
+    }
+  }
+  heldCount = kept;
+}
+
+bool KeyEventQueue::pop(KeyEvent& event) {
+  if (count == 0) {
+    return false;
+  }
+  event = events[head];
+  head = (head + 1) % KEY_QUEUE_SIZE;
+  count--;
+  return true;
+}
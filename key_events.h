@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+
+// 按键事件：每次扫描键盘给出当前按下的键和扫描时刻，与之前的扫描比较，新按下的键产生一个事件
+//   键值与 M5Cardputer 的 getKey() 相同（按住 Shift 时是上档字符），修饰键（0 与 0x80 以上）不产生事件
+//   每个键单独防抖：松开后 debounceMs 内又出现视为抖动，不算再按一次；不同的键互不影响
+//   可自动重复的键按住超过 repeatDelayMs 后开始重复，间隔从 repeatIntervalMs 逐次缩短到 repeatMinIntervalMs
+//   同一个键的重复事件在队列里最多一个，处理慢时不会积压，松手后不会多走
+//   一次扫描里同时按下的几个键按扫描顺序排队，界面逐个处理
+const int KEY_SCAN_MAX = 8;     // 同时按下的键数上限
+const int KEY_QUEUE_SIZE = 16;  // 排队的事件数上限，满了丢弃最新的
+
+struct KeyEvent {
+  uint8_t key;
+  bool repeat;    // 按住不放产生的重复事件
+  uint32_t time;  // 按下（或该次重复到期）的时刻，毫秒
+};
+
+struct KeyRepeatConfig {
+  const char* keys;              // 可自动重复的键，nullptr 表示都不重复
+  uint32_t debounceMs;
+  uint32_t repeatDelayMs;        // 按下到第一次重复
+  uint32_t repeatIntervalMs;     // 第一次重复之后的间隔
+  uint32_t repeatMinIntervalMs;  // 加速到的最短间隔
+  uint32_t repeatAccelMs;        // 每次重复后间隔缩短多少
+};
+
+class KeyEventQueue {
+private:
+  struct HeldKey {
+    uint8_t key;
+    uint32_t lastSeen;    // 最后一次扫描到它的时刻
+    uint32_t nextRepeat;  // 下一次重复的时刻
+    uint32_t interval;    // 当前的重复间隔
+  };
+
+  KeyRepeatConfig config;
+  HeldKey held[KEY_SCAN_MAX];   // 按着（或刚松开还在防抖时间内）的键
+  int heldCount;
+  KeyEvent events[KEY_QUEUE_SIZE];
+  int head;
+  int count;
+  uint32_t presses;
+  uint32_t repeats;
+  uint32_t dropped;
+
+  int findHeld(uint8_t key) const;
+  bool canRepeat(uint8_t key) const;
+  bool hasQueuedRepeat(uint8_t key) const;
+  bool push(uint8_t key, bool repeat, uint32_t time);
+
+public:
+  KeyEventQueue();
+
+  static bool isModifier(uint8_t key) { return key == 0 || key >= 0x80; }
+  static KeyRepeatConfig defaultConfig();
+
+  void configure(const KeyRepeatConfig& repeatConfig) { config = repeatConfig; }
+
+  // 一次扫描的结果：now 时刻有 keyCount 个键按着
+  void scan(const uint8_t* keys, int keyCount, uint32_t now);
+
+  // 取出最早的事件
+  bool pop(KeyEvent& event);
+
+  bool isEmpty() const { return count == 0; }
+
+  uint32_t getPresses() const { return presses; }
+  uint32_t getRepeats() const { return repeats; }
+  uint32_t getDropped() const { return dropped; }
+};
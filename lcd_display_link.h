@@ -0,0 +1,34 @@
+#pragma once
+#include "display_pipeline.h"
+#include <M5Cardputer.h>
+
+// 屏幕的 DMA 传输通道：第一次传输时占住 SPI 总线（startWrite），
+// 之后每段用 pushImageDMA 发出后立即返回，等到通道空闲时才释放总线（endWrite 会等 DMA 结束）
+// 像素已是屏幕字节序（swap565），LovyanGFX 不再逐行转换，直接交给 DMA
+class LcdDisplayLink : public DisplayLink {
+private:
+  bool writing;
+
+public:
+  LcdDisplayLink() : writing(false) {}
+
+  void begin() { M5Cardputer.Display.initDMA(); }
+
+  void startTransfer(int x, int y, int w, int h, const uint16_t* pixels) {
+    if (!writing) {
+      M5Cardputer.Display.startWrite();
+      writing = true;
+    }
+    M5Cardputer.Display.pushImageDMA(x, y, w, h, (const lgfx::swap565_t*)pixels);
+  }
+
+  bool isBusy() { return writing && M5Cardputer.Display.dmaBusy(); }
+
+  void waitIdle() {
+    if (writing) {
+      M5Cardputer.Display.waitDMA();
+      M5Cardputer.Display.endWrite();
+      writing = false;
+    }
+  }
+};
@@ -1,10 +1,29 @@
 #include <M5Cardputer.h>
+#include "ai_worker.h"
+#include "animation.h"
 #include "common.h"
 #include "draw_helper.h"
+#include "game_journal.h"
+#include "game_record.h"
+#include "key_events.h"
+#include "lcd_display_link.h"
+#include "pgn.h"
+#include "power_governor.h"
 #include "puzzle.h"
+#include "puzzle_index.h"
+#include "puzzle_pack.h"
+#include "puzzle_progress.h"
+#include "puzzle_text.h"
+#include "sd_block_file.h"
+#include "write_queue.h"
+#include "engine.h"
+#include "bench.h"
+#include "profiler.h"
+#include "uci.h"
 #include <FS.h>
 #include <SD.h>
 #include <SPI.h>
+#include <esp_sleep.h>
 
 // SD卡引脚配置
 #define SD_CS_PIN 12
@@ -14,10 +33,25 @@
 
 // SD卡相关常量
 #define CHESS_SAVE_DIR "/chess"
-#define CHESS_SAVE_FILE "/chess/board.fen"
+#define CHESS_SAVE_FILE "/chess/board.fen"  // 旧版整局FEN存档，只读，加载后转为对局日志
+#define CHESS_JOURNAL_FILE "/chess/game.jnl"
+// 下完的对局逐步追加到 games.pgn；浏览时优先读用户放入的 library.pgn
+#define CHESS_PGN_FILE "/chess/games.pgn"
+#define CHESS_PGN_LIBRARY "/chess/library.pgn"
+#define CHESS_PUZZLE_PACK "/chess/puzzles.pak"
+#define CHESS_PUZZLE_INDEX "/chess/puzzles.idx"
+#define CHESS_PUZZLE_TEXT "/chess/puzzle.txt"
+// 各谜题来源对应的进度文件
+#define CHESS_PROGRESS_PACK "/chess/puzzles.prg"
+#define CHESS_PROGRESS_TEXT "/chess/puzzle.prg"
+#define CHESS_PROGRESS_BUILTIN "/chess/builtin.prg"
 
 // SD卡状态
 bool sdInitialized = false;
+// 上次挂载失败的时刻；后台路径（自动保存、记谱）隔一段时间才重试，没插卡时不会每步都卡住
+uint32_t sdMountFailedAt = 0;
+bool sdMountFailed = false;
+const uint32_t SD_MOUNT_RETRY_MS = 30000;
 
 // 键盘键值定义
 #define KEY_TAB 0x2b
@@ -28,35 +62,121 @@ void logLine(const String& line) {
 }
 
 
-// AI相关声明
-extern Move chooseAIMove(Color side, const ChessBoard& board);
-
 // 全局画布
 M5Canvas *canvas;
 
+// 预合成的棋子图块和画布调色板
+TileCache pieceTiles;
+CanvasPalette canvasPalette;
+
+// 异步推屏：画布经两块传输缓冲区用 DMA 发到屏幕
+LcdDisplayLink lcdLink;
+DisplayPipeline displayPipeline;
+
 // 光标位置（棋盘坐标）
 int cursorX = 0;
 int cursorY = 0;
 
+// 界面状态：loop() 把按键事件交给当前界面的处理函数，处理完立即返回，界面里不再等待按键
+enum UiScreen {
+    SCREEN_START,          // 开始菜单
+    SCREEN_PGN_BROWSER,    // PGN对局浏览
+    SCREEN_MESSAGE,        // 错误提示，任意键回到开始菜单
+    SCREEN_GAME,           // 对局、谜题和回放
+    SCREEN_CONFIRM_RESET,  // “重置棋盘？”确认框，Y/N
+    SCREEN_PUZZLE_HINT,    // 谜题提示，任意键回到棋盘
+    SCREEN_WRONG_MOVE,     // 谜题走错的提示，任意键回到棋盘
+    SCREEN_PUZZLE_DONE     // 谜题完成，R重试/N下一题/M主菜单
+};
+UiScreen activeScreen = SCREEN_START;
+KeyEventQueue keyEvents;
+
 // 游戏状态
-bool isGameStarted = false;
 bool isWhitePlayer = true;
 int selectedOption = 0; // 0: white, 1: black, 2: random, 3: load
 
 // 谜题模式相关
 bool isPuzzleMode = false;
-std::vector<Puzzle> puzzles;
 int currentPuzzleIndex = 0;
 Puzzle currentPuzzle;
 int currentMoveIndex = 0;
 
+// SD卡谜题包，存在时优先于内置谜题；文件在首次进入谜题模式时打开并一直保持
+SdBlockFile puzzlePackFile;
+PuzzlePack puzzlePack;
+
+// 谜题包的（主题, 等级分）二级索引，可选；有索引时按选定的主题和目标等级分挑选谜题，
+// 两者在谜题完成界面调整（T 换主题，; . 调等级分）
+SdBlockFile puzzleIndexFile;
+PuzzleIndex puzzleIndex;
+uint8_t puzzleTheme = PUZZLE_THEME_ALL;
+uint16_t puzzleTargetRating = 1400;
+const uint16_t PUZZLE_RATING_BAND = 100;
+const uint16_t PUZZLE_RATING_STEP = 100;
+const uint16_t PUZZLE_RATING_MIN = 600;
+const uint16_t PUZZLE_RATING_MAX = 2800;
+
+// 手写谜题文本（puzzle.txt 格式），没有谜题包时使用，作者无需重新刷固件即可增加谜题
+SdBlockFile puzzleTextFile;
+PuzzleTextReader puzzleText;
+
+// 当前谜题来源的解题进度（已解决位图、失败次数、上次的谜题）；写入经队列交给后台任务，不阻塞按键处理
+bool puzzleSourcesOpened = false;
+SdBlockFile puzzleProgressFile;
+QueuedBlockFile progressQueue;
+PuzzleProgress puzzleProgress;
+
+// 对局日志：新对局时新建，每步棋只追加一条记录；写入经队列交给后台任务，不阻塞按键处理
+SdBlockFile journalFile;
+QueuedBlockFile journalQueue;
+GameJournal gameJournal;
+Move pendingJournalMove;       // 等待玩家选择升变棋子的走法
+bool hasPendingJournalMove = false;
+
+// 本局全部走法，用于多级悔棋/重做和回放
+GameRecord gameRecord;
+bool isReplayMode = false;
+int replayReturnPly = 0;       // 进入回放前所在的步数，退出时回到这里
+
+// PGN导出：对局开始时只记下起始局面，走第一步时才写标签，只看不走不会留下空对局
+SdBlockFile pgnFile;
+QueuedBlockFile pgnQueue;
+PgnWriter pgnWriter;
+ChessBoard pgnStartBoard;
+bool pgnPending = false;
+int pgnBasePly = 0;            // PGN第0步对应的 gameRecord 步数
+
+// PGN浏览：流式读取，只保留当前这一局的标签
+SdBlockFile pgnLibraryFile;
+PgnReader pgnReader;
+PgnGameInfo pgnInfo;
+int pgnGameIndex = 0;
+
 // AI走棋记录
 Position aiLastMoveFrom = Position(-1, -1); // 记录AI上一步走棋的起始位置
 Position aiLastMoveTo = Position(-1, -1);   // 记录AI上一步走棋的目标位置
 
-// 按键处理相关
-unsigned long lastKeyPressTime = 0;
-const unsigned long DEBOUNCE_DELAY = 100;
+// 后台AI：玩家走完后开始搜索，走子动画和按键处理照常进行
+AiWorker aiWorker;
+
+// 走子动画：loop() 按固定帧率推进，每帧只重画滑动棋子经过的矩形
+FrameScheduler animationFrames(ANIMATION_FPS);
+MoveAnimation moveAnimation;
+ChessBoard animationBoard;     // 动画期间的场景：终点格还是走子前的内容
+
+// 谜题中对手的应着：玩家走对后停一会再走，等待期间不阻塞按键
+bool hasPuzzleReply = false;
+unsigned long puzzleReplyTime = 0;
+const unsigned long PUZZLE_REPLY_DELAY_MS = 400;
+void cancelPendingMoves();
+
+// 空闲调速：没有动画、搜索和写入时降低 loop() 频率，空闲久了在两次键盘扫描之间 light sleep
+IdleGovernor idleGovernor;
+bool screenAsleep = false;   // light sleep 时熄屏，按任意键亮屏
+
+// 方向键按住自动重复（菜单、棋盘光标、回放）
+const char* REPEAT_KEYS = ";.,/";
+uint32_t maxKeyLatency = 0;   // 按键从扫描到处理的最长延迟（毫秒）
 
 // SD卡初始化
 bool initializeSDCard() {
@@ -126,34 +246,258 @@ bool initializeSDCard() {
         }
     }
 
+    journalQueue.begin();
+    pgnQueue.begin();
+    progressQueue.begin();
     sdInitialized = true;
     return true;
 }
 
-// 保存棋盘状态到SD卡
-bool saveBoardState() {
-    if (!sdInitialized) {
+// 需要时挂载SD卡：已挂载时直接返回；retryNow 为 false 时，距上次失败不足 SD_MOUNT_RETRY_MS 不再尝试
+// 开机挂载一次，之后插入的卡在进入谜题、新对局、浏览对局或自动保存时挂载
+bool mountSDCard(bool retryNow) {
+    if (sdInitialized) {
+        return true;
+    }
+    if (!retryNow && sdMountFailed && millis() - sdMountFailedAt < SD_MOUNT_RETRY_MS) {
         return false;
     }
+    sdMountFailed = !initializeSDCard();
+    sdMountFailedAt = millis();
+    return !sdMountFailed;
+}
 
-    String fen = chessBoard.toFEN();
-    // 附加玩家颜色信息
-    fen += ";isWhitePlayer:" + String(isWhitePlayer ? 1 : 0);
-    File file = SD.open(CHESS_SAVE_FILE, FILE_WRITE);
-    if (!file) {
-        serialPrintf("[SD] Failed to open file for writing: %s\n", CHESS_SAVE_FILE);
+// 打开SD卡上的谜题包，文件不存在或格式不对时返回false
+bool openPuzzlePack() {
+    if (!SD.exists(CHESS_PUZZLE_PACK)) {
         return false;
     }
+    if (!puzzlePackFile.open(CHESS_PUZZLE_PACK)) {
+        serialPrintf("[SD] Failed to open puzzle pack: %s\n", CHESS_PUZZLE_PACK);
+        return false;
+    }
+    if (!puzzlePack.open(&puzzlePackFile)) {
+        puzzlePackFile.close();
+        return false;
+    }
+    if (SD.exists(CHESS_PUZZLE_INDEX) && puzzleIndexFile.open(CHESS_PUZZLE_INDEX) &&
+        !puzzleIndex.open(&puzzleIndexFile)) {
+        puzzleIndexFile.close();
+    }
+    return true;
+}
 
-    if (file.print(fen)) {
-        serialPrintf("[SD] Board state saved to %s\n", CHESS_SAVE_FILE);
-        file.close();
+// 打开SD卡上手写的谜题文本，没有有效谜题时返回false
+bool openPuzzleText() {
+    if (!SD.exists(CHESS_PUZZLE_TEXT) || !puzzleTextFile.open(CHESS_PUZZLE_TEXT)) {
+        return false;
+    }
+    puzzleText.open(&puzzleTextFile);
+    if (puzzleText.count() == 0) {
+        puzzleText.close();
+        puzzleTextFile.close();
+        return false;
+    }
+    serialPrintf("[PUZZLE] %d puzzles in %s\n", puzzleText.count(), CHESS_PUZZLE_TEXT);
+    return true;
+}
+
+// 当前谜题来源的谜题数量
+int getPuzzleCount() {
+    if (puzzlePack.isOpen()) return (int)puzzlePack.size();
+    if (puzzleText.isOpen()) return puzzleText.count();
+    return Puzzle::count();
+}
+
+// 选择谜题来源：谜题包优先，其次是 puzzle.txt，都没有时使用内置谜题；再打开该来源的进度文件
+// 挂载失败时不记为已打开，之后插卡再进谜题模式仍会打开卡上的谜题
+void openPuzzleSources() {
+    if (puzzleSourcesOpened || !mountSDCard(true)) {
+        return;
+    }
+    puzzleSourcesOpened = true;
+    const char* progressPath = CHESS_PROGRESS_BUILTIN;
+    if (openPuzzlePack()) {
+        progressPath = CHESS_PROGRESS_PACK;
+    } else if (openPuzzleText()) {
+        progressPath = CHESS_PROGRESS_TEXT;
+    }
+    if (!puzzleProgressFile.open(progressPath, true)) {
+        serialPrintf("[SD] Failed to open progress file: %s\n", progressPath);
+        return;
+    }
+    progressQueue.attach(&puzzleProgressFile);
+    if (!puzzleProgress.open(&progressQueue, getPuzzleCount())) {
+        progressQueue.attach(nullptr);
+        puzzleProgressFile.close();
+    }
+}
+
+// 按序号读取谜题：谜题包每次只读一条记录，谜题文本从当前位置往后流式读取
+bool loadPuzzle(int index, Puzzle& out) {
+    if (puzzlePack.isOpen()) return puzzlePack.load(index, out);
+    if (puzzleText.isOpen()) {
+        char title[PUZZLE_TITLE_SIZE];
+        if (!puzzleText.load(index, out, title)) return false;
+        serialPrintf("[PUZZLE] %s\n", title);
         return true;
-    } else {
-        serialPrintf("[SD] Failed to write to file: %s\n", CHESS_SAVE_FILE);
-        file.close();
+    }
+    return Puzzle::load(index, out);
+}
+
+// 从 from 开始找第一个未解决的谜题，全部解决或没有进度文件时返回 from
+int findUnsolvedPuzzle(int from) {
+    uint32_t index;
+    return puzzleProgress.findUnsolved(from, index) ? (int)index : from;
+}
+
+// 挑选下一个谜题：有索引时在目标等级分附近随机选（尽量避开已解决的），否则随机选后跳到未解决的
+int pickPuzzleIndex() {
+    uint32_t index;
+    uint16_t minRating = puzzleTargetRating > PUZZLE_RATING_BAND ? puzzleTargetRating - PUZZLE_RATING_BAND : 0;
+    if (puzzleIndex.isOpen()) {
+        for (int attempt = 0; attempt < 8; attempt++) {
+            if (!puzzleIndex.pickRandom(puzzleTheme, minRating, puzzleTargetRating + PUZZLE_RATING_BAND, index) ||
+                index >= puzzlePack.size()) {
+                break;
+            }
+            if (!puzzleProgress.isSolved(index)) {
+                return (int)index;
+            }
+        }
+    }
+    return findUnsolvedPuzzle(random(0, getPuzzleCount()));
+}
+
+// 保存棋盘状态到SD卡：新建对局日志，写入当前局面作为检查点
+// 卡还没挂载时先挂载（后台重试有间隔），对局日志不依赖之前是否选过 Load
+bool saveBoardState() {
+    if (!mountSDCard(false)) {
+        return false;
+    }
+
+    gameJournal.close();
+    hasPendingJournalMove = false;
+    // 旧日志的待写数据先写完，再截断文件
+    journalQueue.attach(nullptr);
+    if (!journalFile.create(CHESS_JOURNAL_FILE)) {
+        serialPrintf("[SD] Failed to open file for writing: %s\n", CHESS_JOURNAL_FILE);
+        return false;
+    }
+    journalQueue.attach(&journalFile);
+    if (!gameJournal.start(&journalQueue, chessBoard, isWhitePlayer ? JOURNAL_FLAG_WHITE_PLAYER : 0)) {
+        serialPrintf("[SD] Failed to write to file: %s\n", CHESS_JOURNAL_FILE);
+        journalQueue.attach(nullptr);
+        journalFile.close();
         return false;
     }
+    serialPrintf("[SD] Board state saved to %s\n", CHESS_JOURNAL_FILE);
+    return true;
+}
+
+// 结束当前PGN对局，未分胜负时记为 *
+void finishPgnGame() {
+    if (pgnWriter.isOpen()) {
+        if (!pgnWriter.isFinished()) {
+            pgnWriter.finish("*");
+        }
+        pgnWriter.close();
+    }
+    pgnPending = false;
+}
+
+// 以当前局面开始新的PGN对局
+void startPgnGame() {
+    finishPgnGame();
+    pgnStartBoard = chessBoard;
+    pgnBasePly = gameRecord.getPly();
+    pgnPending = true;
+}
+
+// 把刚走完的一步追加到PGN
+void recordPgnMove(const Move& move) {
+    if (!mountSDCard(false)) {
+        return;
+    }
+    if (pgnPending) {
+        pgnPending = false;
+        if (!pgnQueue.isAttached()) {
+            if (!pgnFile.open(CHESS_PGN_FILE, true)) {
+                serialPrintf("[SD] Failed to open file for writing: %s\n", CHESS_PGN_FILE);
+                return;
+            }
+            pgnQueue.attach(&pgnFile);
+        }
+        const char* white = isWhitePlayer ? "Player" : "CardChess AI";
+        const char* black = isWhitePlayer ? "CardChess AI" : "Player";
+        pgnWriter.begin(&pgnQueue, pgnStartBoard, white, black);
+    }
+    if (pgnWriter.isOpen()) {
+        pgnWriter.appendMove(move, chessBoard);
+    }
+}
+
+// 走完一步后追加到对局日志；升变要等玩家选好棋子（confirmJournalPromotion）再记录
+void journalMove(const Move& move) {
+    if (chessBoard.getCurrentState() == PromotionSelecting) {
+        pendingJournalMove = move;
+        hasPendingJournalMove = true;
+        return;
+    }
+    gameRecord.push(move, chessBoard);
+    recordPgnMove(move);
+    if (!gameJournal.isOpen() || !gameJournal.appendMove(move, chessBoard, isWhitePlayer ? JOURNAL_FLAG_WHITE_PLAYER : 0)) {
+        // 日志不可用（SD卡拔插、写入失败）时重新建立
+        saveBoardState();
+    }
+}
+
+// 悔棋/重做：至少走一步，停在轮到玩家走棋的局面，然后以新局面重建对局日志
+void stepHistory(bool backward) {
+    cancelPendingMoves();
+    Color playerColor = isWhitePlayer ? Color::WHITE : Color::BLACK;
+    int before = gameRecord.getPly();
+    if (backward) {
+        while (gameRecord.undo(chessBoard) && chessBoard.getCurrentPlayer() != playerColor) {
+        }
+        // 玩家执黑时退到开局会轮到AI，保留AI的第一步
+        if (chessBoard.getCurrentPlayer() != playerColor) {
+            gameRecord.redo(chessBoard);
+        }
+    } else {
+        while (gameRecord.redo(chessBoard)) {
+            recordPgnMove(gameRecord.getMove(gameRecord.getPly() - 1));
+            if (chessBoard.getCurrentPlayer() == playerColor) {
+                break;
+            }
+        }
+    }
+    if (gameRecord.getPly() == before) {
+        return;
+    }
+    if (backward) {
+        // PGN跟着撤回；退到PGN起点之前时从当前局面另起一局
+        int pgnPly = gameRecord.getPly() - pgnBasePly;
+        if (pgnWriter.isOpen() && pgnPly >= 0 && pgnPly <= pgnWriter.getPly()) {
+            pgnWriter.truncate(pgnPly);
+        } else if (pgnPly < 0 || pgnPending) {
+            startPgnGame();
+        }
+    }
+    aiLastMoveFrom = Position(-1, -1);
+    aiLastMoveTo = Position(-1, -1);
+    serialPrintf("[GAME] %s to ply %d/%d\n", backward ? "Undo" : "Redo", gameRecord.getPly(), gameRecord.getTotal());
+    saveBoardState();
+}
+
+// 升变确认后补记等待中的走法，升变棋子从终点格读取
+void confirmJournalPromotion() {
+    if (!hasPendingJournalMove) {
+        return;
+    }
+    hasPendingJournalMove = false;
+    pendingJournalMove.promotion = chessBoard.getPiece(pendingJournalMove.to).type;
+    journalMove(pendingJournalMove);
 }
 
 // 从SD卡加载棋盘状态
@@ -162,6 +506,27 @@ bool loadBoardState() {
         return false;
     }
 
+    gameJournal.close();
+    hasPendingJournalMove = false;
+    journalQueue.attach(nullptr);
+    if (SD.exists(CHESS_JOURNAL_FILE) && journalFile.open(CHESS_JOURNAL_FILE, true)) {
+        uint8_t flags = 0;
+        ChessBoard recovered;
+        journalQueue.attach(&journalFile);
+        if (gameJournal.recover(&journalQueue, recovered, flags)) {
+            chessBoard = recovered;
+            isWhitePlayer = (flags & JOURNAL_FLAG_WHITE_PLAYER) != 0;
+            serialPrintf("[SD] Board state loaded from %s\n", CHESS_JOURNAL_FILE);
+            // 残缺的尾部无法截断，直接用恢复出的局面新建日志
+            if (gameJournal.hasTornTail()) {
+                saveBoardState();
+            }
+            return true;
+        }
+        journalQueue.attach(nullptr);
+        journalFile.close();
+    }
+
     if (!SD.exists(CHESS_SAVE_FILE)) {
         serialPrintf("[SD] Save file not found: %s\n", CHESS_SAVE_FILE);
         return false;
@@ -173,35 +538,36 @@ bool loadBoardState() {
         return false;
     }
 
-    String fen = file.readString();
+    char line[FEN_BUFFER_SIZE + 24];
+    size_t len = file.read((uint8_t*)line, sizeof(line) - 1);
     file.close();
+    line[len] = '\0';
 
     // 解析玩家颜色信息
-    int semicolonIndex = fen.indexOf(';');
-    String boardFen = fen;
-    if (semicolonIndex != -1) {
-        boardFen = fen.substring(0, semicolonIndex);
-        String colorInfo = fen.substring(semicolonIndex + 1);
-        if (colorInfo.startsWith("isWhitePlayer:")) {
-            String colorValue = colorInfo.substring(14);
-            isWhitePlayer = (colorValue == "1");
+    char* colorInfo = strchr(line, ';');
+    if (colorInfo != nullptr) {
+        *colorInfo++ = '\0';
+        if (strncmp(colorInfo, "isWhitePlayer:", 14) == 0) {
+            isWhitePlayer = (colorInfo[14] == '1');
             serialPrintf("[SD] Player color loaded: %s\n", isWhitePlayer ? "White" : "Black");
         }
     }
 
-    if (chessBoard.fromFEN(boardFen)) {
+    if (chessBoard.readFEN(line)) {
         serialPrintf("[SD] Board state loaded from %s\n", CHESS_SAVE_FILE);
+        // 旧存档转为对局日志，之后每步只追加
+        saveBoardState();
         return true;
     } else {
-        serialPrintf("[SD] Failed to parse FEN string: %s\n", boardFen.c_str());
+        serialPrintf("[SD] Failed to parse FEN string: %s\n", line);
         return false;
     }
 }
 
-// 显示确认对话框
-bool showConfirmDialog(const String& message) {
+// 显示确认对话框，按键由对应界面的处理函数判断
+void showConfirmDialog(const String& message) {
     // 绘制背景
-    canvas->fillRect(40, 40, 160, 60, canvas->color565(0, 0, 0));
+    canvas->fillRect(40, 40, 160, 60, COLOR_BLACK);
     canvas->drawRect(40, 40, 160, 60, COLOR_WHITE);
     
     // 绘制消息
@@ -215,26 +581,26 @@ bool showConfirmDialog(const String& message) {
     canvas->drawString("OK (Y)", 80, 80);
     canvas->drawString("CANCEL (N)", 140, 80);
     
-    canvas->pushSprite(0, 0);
-    
-    // 等待用户输入
-    while (true) {
-        M5Cardputer.update();
-        // 直接检测按键状态，不依赖isChange()
-        if (M5Cardputer.Keyboard.isKeyPressed('y') || M5Cardputer.Keyboard.isKeyPressed('Y')) {
-            delay(200); // 防抖动
-            return true;
-        } else if (M5Cardputer.Keyboard.isKeyPressed('n') || M5Cardputer.Keyboard.isKeyPressed('N')) {
-            delay(200); // 防抖动
-            return false;
-        }
-        delay(50);
-    }
+    pushCanvas(canvas);
 }
 
 
 // 显示开始界面
 void showStartScreen() {
+    activeScreen = SCREEN_START;
+    // 上一局还没走出的AI走法和动画作废
+    cancelPendingMoves();
+    // 回到菜单前把排队中的存档写完，之后可能拔卡或关机
+    if (journalQueue.hasPending()) {
+        journalQueue.sync();
+    }
+    if (pgnQueue.hasPending()) {
+        pgnQueue.sync();
+    }
+    if (progressQueue.hasPending()) {
+        progressQueue.sync();
+    }
+    
     canvas->fillScreen(COLOR_BLACK);          // 清空屏幕为黑色背景
     canvas->setTextSize(1.8f);                // 设置文本大小为1.8
     canvas->setTextColor(COLOR_WHITE);        // 设置默认文本颜色为白色
@@ -255,14 +621,14 @@ void showStartScreen() {
     canvas->drawString("White", OPTION_TEXT_X, BASE_Y_POS);
     // 白色棋子图标使用固定x坐标
     int whitePawnY = BASE_Y_POS + TEXT_VERTICAL_ALIGN - PIECE_HEIGHT/2 - 5;
-    canvas->pushImage(FIXED_ICON_X, whitePawnY, PIECE_WIDTH, PIECE_HEIGHT, (uint16_t*)whitePawnData, COLOR_BLACK);
+    drawPieceIcon(canvas, Piece(PAWN, WHITE), FIXED_ICON_X, whitePawnY);
     
     // 黑色选项 - 第2个选项
     canvas->setTextColor(selectedOption == 1 ? COLOR_SELECTED : COLOR_WHITE);
     canvas->drawString("Black", OPTION_TEXT_X, BASE_Y_POS + OPTION_SPACING);
     // 黑色棋子图标使用固定x坐标
     int blackPawnY = BASE_Y_POS + OPTION_SPACING + TEXT_VERTICAL_ALIGN - PIECE_HEIGHT/2 - 5;
-    canvas->pushImage(FIXED_ICON_X, blackPawnY, PIECE_WIDTH, PIECE_HEIGHT, (uint16_t*)blackPawnData, COLOR_WHITE);
+    drawPieceIcon(canvas, Piece(PAWN, BLACK), FIXED_ICON_X, blackPawnY);
     
     // 随机选项 - 第3个选项
     canvas->setTextColor(selectedOption == 2 ? COLOR_SELECTED : COLOR_WHITE);
@@ -287,41 +653,176 @@ void showStartScreen() {
     
     // 开始提示 - 居中显示在所有选项下方（使用5倍间距）
     canvas->setTextColor(COLOR_WHITE);
-    canvas->drawString(";.select|Space play", 120, BASE_Y_POS + OPTION_SPACING * 5);
+    canvas->drawString(";.select|Space play|G games", 120, BASE_Y_POS + OPTION_SPACING * 5);
     
-    canvas->pushSprite(0, 0);                 // 将绘制内容显示到屏幕
+    pushCanvas(canvas);                 // 将绘制内容显示到屏幕
 }
 
-// 显示谜题选择界面
-
+// 打开PGN对局库，没有 library.pgn 时浏览自己下过的对局
+bool openPgnLibrary() {
+    if (!mountSDCard(true)) {
+        return false;
+    }
+    const char* path = SD.exists(CHESS_PGN_LIBRARY) ? CHESS_PGN_LIBRARY : CHESS_PGN_FILE;
+    pgnQueue.sync();
+    pgnReader.close();
+    if (!SD.exists(path) || !pgnLibraryFile.open(path)) {
+        serialPrintf("[SD] PGN file not found: %s\n", path);
+        return false;
+    }
+    pgnReader.open(&pgnLibraryFile);
+    int count = pgnReader.count();
+    serialPrintf("[SD] %d games in %s\n", count, path);
+    return count > 0;
+}
 
-// 绘制游戏界面
-void drawGameScreen() {
+// 显示PGN浏览界面：当前这一局的标签摘要
+void showPgnBrowser() {
     canvas->fillScreen(COLOR_BLACK);
+    canvas->setTextDatum(TC_DATUM);
+    canvas->setTextColor(COLOR_WHITE);
+    char line[PGN_TAG_VALUE_SIZE * 2 + 8];
+    canvas->setTextSize(1.8f);
+    snprintf(line, sizeof(line), "Game %d/%d", pgnGameIndex + 1, pgnReader.count());
+    canvas->drawString(line, 120, 6);
     
+    canvas->setTextSize(1);
+    canvas->setTextColor(COLOR_SELECTED);
+    snprintf(line, sizeof(line), "%s", pgnInfo.white[0] ? pgnInfo.white : "?");
+    canvas->drawString(line, 120, 34);
+    canvas->drawString("vs", 120, 48);
+    snprintf(line, sizeof(line), "%s", pgnInfo.black[0] ? pgnInfo.black : "?");
+    canvas->drawString(line, 120, 62);
+    canvas->setTextColor(COLOR_WHITE);
+    snprintf(line, sizeof(line), "%s  %s", pgnInfo.result, pgnInfo.date);
+    canvas->drawString(line, 120, 80);
+    canvas->drawString(pgnInfo.event, 120, 94);
+    canvas->drawString(";.select|Space load|B back", 120, 120);
+    pushCanvas(canvas);
+}
+
+// 游戏界面的脏矩形记录：0-63 为棋盘格（按屏幕位置），其后是两侧面板和顶部的将军提示
+DirtyTracker gameScreenDamage(SCREEN_WIDTH, SCREEN_HEIGHT);
+const int GAME_REGION_LEFT_PANEL = BOARD_SIZE * BOARD_SIZE;
+const int GAME_REGION_RIGHT_PANEL = GAME_REGION_LEFT_PANEL + 1;
+const int GAME_REGION_CHECK_INFO = GAME_REGION_LEFT_PANEL + 2;
+
+// 格子上的叠加标记，和棋子编码一起组成格子签名
+const uint8_t SQUARE_AI_MOVE = 1;
+const uint8_t SQUARE_SELECTED = 2;
+const uint8_t SQUARE_VALID_MOVE = 4;
+const uint8_t SQUARE_CURSOR = 8;
+
+void renderGameScene(const ChessBoard& board, bool isWhiteBottom);
+
+// 对局结束：走子方被将死或逼和（升变选择中还没轮到对方，不算）
+bool isGameOver(const ChessBoard& board) {
+    Color side = board.getCurrentPlayer();
+    return board.getCurrentState() != PromotionSelecting && (board.isCheckmate(side) || board.isStalemate(side));
+}
+
+// 计算本帧各区域的签名（按场景中的棋盘），变化的区域记为脏
+void trackGameScreenDamage(const ChessBoard& board, bool isWhiteBottom) {
+    uint8_t marks[BOARD_SIZE][BOARD_SIZE] = {};
+    if (aiLastMoveFrom.isValid()) {
+        marks[aiLastMoveFrom.x][aiLastMoveFrom.y] |= SQUARE_AI_MOVE;
+    }
+    if (aiLastMoveTo.isValid()) {
+        marks[aiLastMoveTo.x][aiLastMoveTo.y] |= SQUARE_AI_MOVE;
+    }
+    Position selected = board.getSelectedPiece();
+    if (selected.isValid()) {
+        marks[selected.x][selected.y] |= SQUARE_SELECTED;
+        const std::vector<Position>& validMoves = board.getValidMoves();
+        for (const Position& pos : validMoves) {
+            if (pos.isValid()) {
+                marks[pos.x][pos.y] |= SQUARE_VALID_MOVE;
+            }
+        }
+    }
+    marks[cursorX][cursorY] |= SQUARE_CURSOR;
+    
+    for (int y = 0; y < BOARD_SIZE; y++) {
+        for (int x = 0; x < BOARD_SIZE; x++) {
+            const Piece& piece = board.getPiece(x, y);
+            uint32_t code = piece.isEmpty() ? 0 : (piece.type | (piece.color == Color::BLACK ? 8 : 0));
+            uint32_t signature = code | (marks[x][y] << 4) | (isWhiteBottom ? 0x100 : 0);
+            int screenX, screenY;
+            boardToScreen(Position(x, y), screenX, screenY, isWhiteBottom);
+            // 光标和选中框向外画了2像素，区域包含这圈边框
+            int region = ((screenY - BOARD_Y) / SQUARE_SIZE) * BOARD_SIZE + (screenX - BOARD_X) / SQUARE_SIZE;
+            gameScreenDamage.update(region, signature, screenX - 2, screenY - 2, SQUARE_SIZE + 4, SQUARE_SIZE + 4);
+        }
+    }
+    
+    uint32_t leftPanel = isPuzzleMode ? 1 : 0;
+    if (isReplayMode) {
+        leftPanel = 2 | (gameRecord.getPly() << 2) | (gameRecord.getTotal() << 16);
+    }
+    gameScreenDamage.update(GAME_REGION_LEFT_PANEL, leftPanel, 0, 0, BOARD_X - BOARD_PADDING, SCREEN_HEIGHT);
+    
+    const Piece& cursorPiece = board.getPiece(cursorX, cursorY);
+    uint32_t rightPanel = (board.getCurrentPlayer() == Color::WHITE ? 0 : 1) | (cursorPiece.isEmpty() ? 0 : cursorPiece.type << 1);
+    int rightX = BOARD_X + BOARD_WIDTH + BOARD_PADDING;
+    gameScreenDamage.update(GAME_REGION_RIGHT_PANEL, rightPanel, rightX, 0, SCREEN_WIDTH - rightX, SCREEN_HEIGHT);
+    
+    // 将军提示画在顶部正中，压住棋盘边框和第一排格子的上沿；将死/逼和读棋盘的合法走法缓存
+    uint32_t checkInfo = board.isInCheck(Color::WHITE) ? 1 : (board.isInCheck(Color::BLACK) ? 2 : 0);
+    if (isGameOver(board)) {
+        checkInfo |= 4;
+    }
+    gameScreenDamage.update(GAME_REGION_CHECK_INFO, checkInfo, 0, 0, SCREEN_WIDTH, 10);
+}
+
+// 绘制游戏界面：只重画并推送和上一帧相比有变化的区域
+void drawGameScreen() {
     // 动态设置棋盘朝向：
     // 普通模式：玩家所执颜色在下
     // puzzle模式：白方在下（白方视角）
     bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
+    // 走子动画期间终点格还显示走子前的内容，滑动的棋子由 drawAnimationFrame() 单独画
+    const ChessBoard& board = moveAnimation.isActive() ? animationBoard : chessBoard;
+    bool isPromotion = board.getCurrentState() == PromotionSelecting;
+    
+    gameScreenDamage.beginFrame();
+    trackGameScreenDamage(board, isWhiteBottom);
+    if (gameScreenDamage.isFullFrame() || isPromotion) {
+        renderGameScene(board, isWhiteBottom);
+        pushCanvas(canvas);
+    } else {
+        // 在每个脏矩形的裁剪区域内重画场景，画布其余部分仍是上一帧的内容
+        for (int i = 0; i < gameScreenDamage.getCount(); i++) {
+            const DirtyRect& rect = gameScreenDamage.getRect(i);
+            canvas->setClipRect(rect.x, rect.y, rect.w, rect.h);
+            renderGameScene(board, isWhiteBottom);
+        }
+        canvas->clearClipRect();
+        for (int i = 0; i < gameScreenDamage.getCount(); i++) {
+            pushCanvasRect(canvas, gameScreenDamage.getRect(i));
+        }
+    }
+    // 升变选择框盖住了整个棋盘，签名描述的不是屏幕内容，下一帧仍整屏重画
+    if (!isPromotion) {
+        gameScreenDamage.endFrame();
+    }
+}
+
+// 把游戏界面完整画到画布上（受画布裁剪区域限制），棋子按 board 画
+void renderGameScene(const ChessBoard& board, bool isWhiteBottom) {
+    canvas->fillScreen(COLOR_BLACK);
     
     // 绘制棋盘
-    drawBoard(canvas, chessBoard, isWhiteBottom);
+    drawBoard(canvas, board, isWhiteBottom);
     
     // 绘制AI上一步走棋的起始位置和目标位置
-    if ((aiLastMoveFrom.isValid() || aiLastMoveTo.isValid()) && chessBoard.getCurrentState() != PromotionSelecting) {
+    if ((aiLastMoveFrom.isValid() || aiLastMoveTo.isValid()) && board.getCurrentState() != PromotionSelecting) {
         // 绘制起始位置（背景高亮）
         if (aiLastMoveFrom.isValid()) {
             int screenX, screenY;
             boardToScreen(aiLastMoveFrom, screenX, screenY, isWhiteBottom);
             
-            // 使用背景高亮，类似于升变状态选棋子的样式
-            canvas->fillRect(screenX, screenY, SQUARE_SIZE, SQUARE_SIZE, COLOR_SELECTED);
-            
-            // 如果该位置现在有棋子，重新绘制棋子
-            const Piece& piece = chessBoard.getPiece(aiLastMoveFrom);
-            if (!piece.isEmpty()) {
-                drawPiece(canvas, piece, screenX, screenY);
-            }
+            // 使用背景高亮，类似于升变状态选棋子的样式（有棋子时连同棋子一起画）
+            drawSquare(canvas, board.getPiece(aiLastMoveFrom), screenX, screenY, TILE_SELECTED);
         }
         
         // 绘制目标位置（背景高亮）
@@ -329,33 +830,27 @@ void drawGameScreen() {
             int screenX, screenY;
             boardToScreen(aiLastMoveTo, screenX, screenY, isWhiteBottom);
             
-            // 使用背景高亮，类似于升变状态选棋子的样式
-            canvas->fillRect(screenX, screenY, SQUARE_SIZE, SQUARE_SIZE, COLOR_SELECTED);
-            
-            // 如果该位置现在有棋子，重新绘制棋子
-            const Piece& piece = chessBoard.getPiece(aiLastMoveTo);
-            if (!piece.isEmpty()) {
-                drawPiece(canvas, piece, screenX, screenY);
-            }
+            // 使用背景高亮，类似于升变状态选棋子的样式（有棋子时连同棋子一起画）
+            drawSquare(canvas, board.getPiece(aiLastMoveTo), screenX, screenY, TILE_SELECTED);
         }
     }
     
     // 绘制选中的棋子和合法移动
-    Position selected = chessBoard.getSelectedPiece();
-    if (selected.isValid() && chessBoard.getCurrentState() != PromotionSelecting) {
+    Position selected = board.getSelectedPiece();
+    if (selected.isValid() && board.getCurrentState() != PromotionSelecting) {
         drawSelectedPiece(canvas, selected, isWhiteBottom);
-        drawValidMoves(canvas, chessBoard.getValidMoves(), isWhiteBottom);
+        drawValidMoves(canvas, board.getValidMoves(), isWhiteBottom);
     }
     
     // 检查是否处于升变状态
-    if (chessBoard.getCurrentState() == PromotionSelecting) {
+    if (board.getCurrentState() == PromotionSelecting) {
         // 绘制半透明遮罩
-        canvas->fillRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, canvas->color565(0, 0, 0)); // 移除透明度参数
+        canvas->fillRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, COLOR_BLACK); // 移除透明度参数
         
         // 获取升变兵的位置和颜色
-        Position pawnPos = chessBoard.getPromotionPawnPos();
-        Color color = chessBoard.getPromotionColor();
-        PieceType selectedPiece = chessBoard.getSelectedPromotionPiece();
+        Position pawnPos = board.getPromotionPawnPos();
+        Color color = board.getPromotionColor();
+        PieceType selectedPiece = board.getSelectedPromotionPiece();
         
         // 计算升变兵在屏幕上的位置
         int pawnScreenX, pawnScreenY;
@@ -376,8 +871,8 @@ void drawGameScreen() {
             int x = startX + i * SQUARE_SIZE;
             int y = startY;
             
-            // 绘制格子背景
-            canvas->fillRect(x, y, SQUARE_SIZE, SQUARE_SIZE, (pieceType == selectedPiece) ? COLOR_SELECTED : COLOR_LIGHT_SQUARE);
+            // 绘制格子背景和棋子
+            drawSquare(canvas, Piece(pieceType, color), x, y, (pieceType == selectedPiece) ? TILE_SELECTED : TILE_LIGHT);
             
             // 绘制多层边框增强光标可见性
             if (pieceType == selectedPiece) {
@@ -389,10 +884,6 @@ void drawGameScreen() {
             } else {
                 canvas->drawRect(x, y, SQUARE_SIZE, SQUARE_SIZE, COLOR_BORDER);
             }
-            
-            // 绘制棋子
-            Piece piece(pieceType, color);
-            drawPiece(canvas, piece, x, y);
         }
     } else {
         // 绘制光标
@@ -408,16 +899,20 @@ void drawGameScreen() {
     }
     
     // 绘制回合信息
-    drawTurnInfo(canvas, chessBoard.getCurrentPlayer());
+    drawTurnInfo(canvas, board.getCurrentPlayer());
     
     // 绘制光标位置的棋子信息
     drawPieceInfo(canvas);
     
-    // 绘制将军信息
-    if (chessBoard.isInCheck(Color::WHITE)) {
-        drawCheckInfo(canvas, true, Color::WHITE);
-    } else if (chessBoard.isInCheck(Color::BLACK)) {
-        drawCheckInfo(canvas, true, Color::BLACK);
+    // 绘制将军、将死或逼和信息
+    Color sideToMove = board.getCurrentPlayer();
+    bool gameOver = isGameOver(board);
+    if (gameOver) {
+        drawCheckInfo(canvas, board.isInCheck(sideToMove), sideToMove, true);
+    } else if (board.isInCheck(Color::WHITE)) {
+        drawCheckInfo(canvas, true, Color::WHITE, false);
+    } else if (board.isInCheck(Color::BLACK)) {
+        drawCheckInfo(canvas, true, Color::BLACK, false);
     }
     
     // 在屏幕左上角添加操作提示
@@ -426,816 +921,773 @@ void drawGameScreen() {
         canvas->setTextSize(1);
         canvas->drawString("ESC:reset", 28, 7);
         canvas->drawString("TAB:tip", 22, 19);
+    } else if (isReplayMode) {
+        char replayText[24];
+        snprintf(replayText, sizeof(replayText), "%d/%d", gameRecord.getPly(), gameRecord.getTotal());
+        canvas->setTextColor(COLOR_WHITE, COLOR_BLACK);
+        canvas->setTextSize(1);
+        canvas->drawString("Replay", 22, 7);
+        canvas->drawString(replayText, 22, 19);
+    } else {
+        canvas->setTextColor(COLOR_WHITE, COLOR_BLACK);
+        canvas->setTextSize(1);
+        canvas->drawString("Z/Y:undo", 28, 7);
+        canvas->drawString("P:replay", 28, 19);
+    }
+}
+
+// 停止走子动画；动画画到一半时滑动的棋子还留在画布上，下一帧整屏重画
+void stopMoveAnimation() {
+    if (moveAnimation.isActive()) {
+        moveAnimation.stop();
+        animationFrames.stop();
+        gameScreenDamage.invalidate();
+    }
+}
+
+// 走完一步后播放滑动动画，piece/captured 是走子前起点和终点的棋子
+void animateMove(const Move& move, const Piece& piece, const Piece& captured) {
+    stopMoveAnimation();
+    // 升变选择框盖住了棋盘，不播放
+    if (chessBoard.getCurrentState() == PromotionSelecting) {
+        return;
+    }
+    bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
+    int fromX, fromY, toX, toY;
+    boardToScreen(move.from, fromX, fromY, isWhiteBottom);
+    boardToScreen(move.to, toX, toY, isWhiteBottom);
+    animationBoard = chessBoard;
+    animationBoard.setPiece(move.to.x, move.to.y, captured);
+    unsigned long now = millis();
+    moveAnimation.begin(piece, fromX, fromY, toX, toY, now);
+    animationFrames.start(now);
+    drawGameScreen();
+}
+
+// 画一帧动画：在棋子上一帧与这一帧位置的并集内重画场景，再把棋子画在新位置
+void drawAnimationFrame() {
+    bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
+    int x, y;
+    DirtyRect rect;
+    bool finished = moveAnimation.step(millis(), SQUARE_SIZE, x, y, rect);
+    canvas->setClipRect(rect.x, rect.y, rect.w, rect.h);
+    renderGameScene(animationBoard, isWhiteBottom);
+    drawPiece(canvas, moveAnimation.getPiece(), x, y);
+    canvas->clearClipRect();
+    pushCanvasRect(canvas, rect);
+    if (finished) {
+        // 棋子已停在终点，换回真实局面，终点格的签名变化，按脏矩形重画
+        moveAnimation.stop();
+        animationFrames.stop();
+        drawGameScreen();
+    }
+}
+
+// 轮到AI时开始后台搜索
+void startAiTurn() {
+    Color aiColor = isWhitePlayer ? Color::BLACK : Color::WHITE;
+    if (!isPuzzleMode && !isReplayMode && chessBoard.getCurrentState() != PromotionSelecting &&
+        chessBoard.getCurrentPlayer() == aiColor) {
+        aiWorker.start(chessBoard, aiColor);
+    }
+}
+
+// 走出AI的走法并播放动画
+void applyAiMove(const Move& aiMove) {
+    Piece piece = chessBoard.getPiece(aiMove.from);
+    Piece captured = chessBoard.getPiece(aiMove.to);
+    // 记录AI走棋的起始位置和目标位置
+    aiLastMoveFrom = aiMove.from;
+    aiLastMoveTo = aiMove.to;
+    // 升变时直接按搜索结果确认棋子，不弹出选择框
+    chessBoard.makeMove(aiMove);
+    // 记录AI的走法
+    journalMove(aiMove);
+    animateMove(aiMove, piece, captured);
+}
+
+// 作废还没走出的AI走法、谜题应着和动画（局面被悔棋、重置或替换时）
+void cancelPendingMoves() {
+    aiWorker.cancel();
+    hasPuzzleReply = false;
+    stopMoveAnimation();
+}
+
+// loop() 每轮调用：推进动画；动画播完后走出已就绪的AI走法或到时的谜题应着
+void updateGameActivity() {
+    // 提示框、确认框等盖在棋盘上时暂停，后台搜索照常进行
+    if (activeScreen != SCREEN_GAME) {
+        return;
+    }
+    if (moveAnimation.isActive()) {
+        if (animationFrames.due(millis())) {
+            drawAnimationFrame();
+        }
+        return;
+    }
+    Move aiMove;
+    if (aiWorker.poll(aiMove)) {
+        if (aiMove.from.isValid() && aiMove.to.isValid()) {
+            applyAiMove(aiMove);
+        }
+        return;
+    }
+    if (hasPuzzleReply && (long)(millis() - puzzleReplyTime) >= 0) {
+        hasPuzzleReply = false;
+        Move nextMove = currentPuzzle.getMove(currentMoveIndex);
+        Piece piece = chessBoard.getPiece(nextMove.from);
+        Piece captured = chessBoard.getPiece(nextMove.to);
+        chessBoard.makeMove(nextMove);
+        aiLastMoveFrom = nextMove.from;
+        aiLastMoveTo = nextMove.to;
+        currentMoveIndex++;
+        animateMove(nextMove, piece, captured);
     }
-    
-    canvas->pushSprite(0, 0);
 }
 
-// 处理按键输入
-void handleKeyInput() {
-    if (M5Cardputer.Keyboard.isChange()) {
-        // 防抖动
-        if (millis() - lastKeyPressTime < DEBOUNCE_DELAY) {
+// 显示一条错误提示，任意键回到开始菜单
+void showMessageScreen(const char* message) {
+    canvas->fillScreen(COLOR_BLACK);
+    canvas->setTextColor(COLOR_WHITE);
+    canvas->setTextSize(1);
+    canvas->setTextDatum(CC_DATUM);
+    canvas->drawString(message, 120, 60);
+    canvas->drawString("Press any key to return", 120, 80);
+    canvas->setTextDatum(TC_DATUM);
+    pushCanvas(canvas);
+    activeScreen = SCREEN_MESSAGE;
+}
+
+// 进入对局界面，光标放在玩家一方的角上
+void enterGame() {
+    activeScreen = SCREEN_GAME;
+    cursorX = 0;
+    cursorY = isWhitePlayer ? 0 : 7;
+    // 重置AI走棋记录
+    aiLastMoveFrom = Position(-1, -1);
+    aiLastMoveTo = Position(-1, -1);
+}
+
+// 开始界面选中一项后按空格
+void startSelectedOption() {
+    if (selectedOption == 0) {
+        // 选择白色
+        isWhitePlayer = true;
+    } else if (selectedOption == 1) {
+        // 选择黑色
+        isWhitePlayer = false;
+    } else if (selectedOption == 2) {
+        // 随机选择颜色
+        isWhitePlayer = random(0, 2);
+    } else if (selectedOption == 3) {
+        // 读取存档 - 首先初始化SD卡
+        if (!initializeSDCard()) {
+            showMessageScreen("SDCard not found");
             return;
         }
-        lastKeyPressTime = millis();
-        
-        if (!isGameStarted) {
-            if (isPuzzleMode) {
-                // 谜题选择界面的按键处理
-                if (M5Cardputer.Keyboard.isKeyPressed(' ')) {
-                    // 开始选择的谜题
-                    const Puzzle& selectedPuzzle = puzzles[currentPuzzleIndex];
-                    // 加载谜题初始局面
-                    chessBoard.fromFEN(selectedPuzzle.getFEN());
-                    // 根据谜题的当前走棋方设置玩家颜色
-                    isWhitePlayer = (selectedPuzzle.getSideToMove() == Color::WHITE);
-                    isGameStarted = true;
-                    currentMoveIndex = 0;
-                    // 重绘游戏界面
-                    drawGameScreen();
-                    return;
-                } else if (M5Cardputer.Keyboard.isKeyPressed(';')) {
-                    // 上箭头 - 选择上一个谜题
-                    currentPuzzleIndex = (currentPuzzleIndex - 1 + puzzles.size()) % puzzles.size();
-                    currentPuzzle = puzzles[currentPuzzleIndex];
-                    chessBoard.fromFEN(currentPuzzle.getFEN());
-                    currentMoveIndex = 0;
-                    drawGameScreen();
-                } else if (M5Cardputer.Keyboard.isKeyPressed('.')) {
-                    // 下箭头 - 选择下一个谜题
-                    currentPuzzleIndex = (currentPuzzleIndex + 1) % puzzles.size();
-                    currentPuzzle = puzzles[currentPuzzleIndex];
-                    chessBoard.fromFEN(currentPuzzle.getFEN());
-                    currentMoveIndex = 0;
-                    drawGameScreen();
-                } else if (M5Cardputer.Keyboard.isKeyPressed('B')) {
-                    // B键返回主菜单
-                    isPuzzleMode = false;
-                    showStartScreen();
-                }
-            } else {
-                // 开始界面的按键处理
-                if (M5Cardputer.Keyboard.isKeyPressed(' ')) {
-                    // 根据选中的选项执行相应操作
-                    if (selectedOption == 0) {
-                        // 选择白色
-                        isWhitePlayer = true;
-                    } else if (selectedOption == 1) {
-                        // 选择黑色
-                        isWhitePlayer = false;
-                    } else if (selectedOption == 2) {
-                        // 随机选择颜色
-                        isWhitePlayer = random(0, 2);
-                    } else if (selectedOption == 3) {
-                        // 读取存档 - 首先初始化SD卡
-                        if (!initializeSDCard()) {
-                            // SD卡初始化失败，显示错误信息
-                            canvas->fillScreen(COLOR_BLACK);
-                            canvas->setTextColor(COLOR_WHITE);
-                            canvas->setTextSize(1);
-                            canvas->setTextDatum(CC_DATUM);
-                            canvas->drawString("SDCard not found", 120, 60);
-                            canvas->drawString("Press any key to return", 120, 80);
-                            canvas->pushSprite(0, 0);
-                            
-                            // 首先等待所有按键释放，清除当前按键状态
-                            bool anyKeyPressed = true;
-                            while (anyKeyPressed) {
-                                M5Cardputer.update();
-                                anyKeyPressed = false;
-                                
-                                // 检查字母键
-                                for (int i = 0; i < 26; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                        anyKeyPressed = true;
-                                        break;
-                                    }
-                                }
-                                if (anyKeyPressed) { delay(50); continue; }
-                                
-                                // 检查数字键
-                                for (int i = 0; i < 10; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                        anyKeyPressed = true;
-                                        break;
-                                    }
-                                }
-                                if (anyKeyPressed) { delay(50); continue; }
-                                
-                                // 检查特殊键
-                                if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                    M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                    anyKeyPressed = true;
-                                }
-                                
-                                if (anyKeyPressed) {
-                                    delay(50);
-                                }
-                            }
-                            
-                            // 然后等待用户按下任意键
-                            while (true) {
-                                M5Cardputer.update();
-                                if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                    M5Cardputer.Keyboard.isKeyPressed('\n') || 
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                    M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                    showStartScreen();
-                                    return;
-                                }
-                                delay(50);
-                            }
-                        }
-                        
-                        // SD卡初始化成功，检查存档是否存在
-                        if (SD.exists(CHESS_SAVE_FILE)) {
-                            if (loadBoardState()) {
-                                isGameStarted = true;
-                                // 加载后重设AI走棋记录
-                                aiLastMoveFrom = Position(-1, -1);
-                                aiLastMoveTo = Position(-1, -1);
-                                // 重绘游戏界面
-                                drawGameScreen();
-                                // 如果现在是AI的回合，AI需要走棋
-                                if (chessBoard.getCurrentPlayer() != (isWhitePlayer ? Color::WHITE : Color::BLACK)) {
-                                    delay(500); // 短暂延迟
-                                    Color aiColor = chessBoard.getCurrentPlayer();
-                                    Move aiMove = chooseAIMove(aiColor, chessBoard);
-                                    if (aiMove.from.isValid() && aiMove.to.isValid()) {
-                                        // 记录AI走棋的起始位置和目标位置
-                                        aiLastMoveFrom = aiMove.from;
-                                        aiLastMoveTo = aiMove.to;
-                                        chessBoard.movePiece(aiMove.from, aiMove.to);
-                                        // 保存AI移动后的棋盘状态
-                                        saveBoardState();
-                                        // 重绘游戏界面
-                                        drawGameScreen();
-                                    }
-                                }
-                                return;
-                            } else {
-                                // 加载失败，显示错误信息
-                                canvas->fillScreen(COLOR_BLACK);
-                                canvas->setTextColor(COLOR_WHITE);
-                                canvas->setTextSize(1);
-                                canvas->setTextDatum(CC_DATUM);
-                                canvas->drawString("Failed to load game", 120, 60);
-                                canvas->drawString("Press any key to return", 120, 80);
-                                canvas->pushSprite(0, 0);
-                                
-                                // 首先等待所有按键释放，清除当前按键状态
-                                bool anyKeyPressed = true;
-                                while (anyKeyPressed) {
-                                    M5Cardputer.update();
-                                    anyKeyPressed = false;
-                                    
-                                    // 检查字母键
-                                    for (int i = 0; i < 26; i++) {
-                                        if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                            anyKeyPressed = true;
-                                            break;
-                                        }
-                                    }
-                                    if (anyKeyPressed) { delay(50); continue; }
-                                    
-                                    // 检查数字键
-                                    for (int i = 0; i < 10; i++) {
-                                        if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                            anyKeyPressed = true;
-                                            break;
-                                        }
-                                    }
-                                    if (anyKeyPressed) { delay(50); continue; }
-                                    
-                                    // 检查特殊键
-                                    if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                        M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                        M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                        M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                        M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                        anyKeyPressed = true;
-                                    }
-                                    
-                                    if (anyKeyPressed) {
-                                        delay(50);
-                                    }
-                                }
-                                
-                                // 然后等待用户按下任意键
-                                while (true) {
-                                    M5Cardputer.update();
-                                    
-                                    // 检查字母键
-                                    for (int i = 0; i < 26; i++) {
-                                        if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                            showStartScreen();
-                                            return;
-                                        }
-                                    }
-                                    
-                                    // 检查数字键
-                                    for (int i = 0; i < 10; i++) {
-                                        if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                            showStartScreen();
-                                            return;
-                                        }
-                                    }
-                                    
-                                    // 检查特殊键
-                                    if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                        M5Cardputer.Keyboard.isKeyPressed('\n') || 
-                                        M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                        M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                        M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                        M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                        M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                        showStartScreen();
-                                        return;
-                                    }
-                                    
-                                    delay(50);
-                                }
-                            }
-                        } else {
-                            // 没有存档文件，显示错误信息
-                            canvas->fillScreen(COLOR_BLACK);
-                            canvas->setTextColor(COLOR_WHITE);
-                            canvas->setTextSize(1);
-                            canvas->setTextDatum(CC_DATUM);
-                            canvas->drawString("No saved game", 120, 60);
-                            canvas->drawString("Press any key to return", 120, 80);
-                            canvas->pushSprite(0, 0);
-                            
-                            // 首先等待所有按键释放，清除当前按键状态
-                            bool anyKeyPressed = true;
-                            while (anyKeyPressed) {
-                                M5Cardputer.update();
-                                anyKeyPressed = false;
-                                
-                                // 检查字母键
-                                for (int i = 0; i < 26; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                        anyKeyPressed = true;
-                                        break;
-                                    }
-                                }
-                                if (anyKeyPressed) { delay(50); continue; }
-                                
-                                // 检查数字键
-                                for (int i = 0; i < 10; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                        anyKeyPressed = true;
-                                        break;
-                                    }
-                                }
-                                if (anyKeyPressed) { delay(50); continue; }
-                                
-                                // 检查特殊键
-                                if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                    M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                    anyKeyPressed = true;
-                                }
-                                
-                                if (anyKeyPressed) {
-                                    delay(50);
-                                }
-                            }
-                            
-                            // 然后等待用户按下任意键
-                            while (true) {
-                                M5Cardputer.update();
-                                
-                                // 检查字母键
-                                for (int i = 0; i < 26; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                        showStartScreen();
-                                        return;
-                                    }
-                                }
-                                
-                                // 检查数字键
-                                for (int i = 0; i < 10; i++) {
-                                    if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                        showStartScreen();
-                                        return;
-                                    }
-                                }
-                                
-                                // 检查特殊键
-                                if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                    M5Cardputer.Keyboard.isKeyPressed('\n') || 
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                    M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                    M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                    M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                    showStartScreen();
-                                    return;
-                                }
-                                
-                                delay(50);
-                            }
-                        }
-                    } else if (selectedOption == 4) {
-                        // 谜题模式
-                        isPuzzleMode = true;
-                        // 加载谜题
-                        puzzles = Puzzle::loadPuzzles("");
-                        if (puzzles.empty()) {
-                            // 谜题加载失败，返回主菜单
-                            isPuzzleMode = false;
-                            showStartScreen();
-                            return;
-                        }
-                        // 随机选择一个谜题
-                        currentPuzzleIndex = random(0, puzzles.size());
-                        currentPuzzle = puzzles[currentPuzzleIndex];
-                        
-                        // 开始新游戏
-                        isGameStarted = true;
-                        // 从FEN加载棋盘
-                        chessBoard.fromFEN(currentPuzzle.getFEN());
-                        // 根据谜题的当前走棋方设置玩家颜色
-                        isWhitePlayer = (currentPuzzle.getSideToMove() == Color::WHITE);
-                        // 重置光标位置
-                        if (!isWhitePlayer) {
-                            cursorX = 0;
-                            cursorY = 7;
-                        } else {
-                            cursorX = 0;
-                            cursorY = 0;
-                        }
-                        // 重置AI走棋记录
-                        aiLastMoveFrom = Position(-1, -1);
-                        aiLastMoveTo = Position(-1, -1);
-                        // 重置当前走法索引
-                        currentMoveIndex = 0;
-                        
-                        // 重绘游戏界面
-                        drawGameScreen();
-                        return;
-                    }
-                    
-                    // 开始新游戏
-                    isGameStarted = true;
-                    // 初始化棋盘
-                    chessBoard.initBoard();
-                    // 重置AI走棋记录
-                    aiLastMoveFrom = Position(-1, -1);
-                    aiLastMoveTo = Position(-1, -1);
-                    // 设置光标初始位置
-                    if (!isWhitePlayer) {
-                        cursorX = 0;
-                        cursorY = 7;
-                    } else {
-                        cursorX = 0;
-                        cursorY = 0;
-                    }
-                    
-                    // 重绘游戏界面
-                    drawGameScreen();
-                    
-                    // 如果玩家选择黑方，AI（白方）需要先走棋
-                    if (!isWhitePlayer) {
-                        delay(500); // 短暂延迟
-                        Color aiColor = Color::WHITE;
-                        Move aiMove = chooseAIMove(aiColor, chessBoard);
-                        if (aiMove.from.isValid() && aiMove.to.isValid()) {
-                            // 记录AI走棋的起始位置和目标位置
-                            aiLastMoveFrom = aiMove.from;
-                            aiLastMoveTo = aiMove.to;
-                            chessBoard.movePiece(aiMove.from, aiMove.to);
-                            // 保存AI移动后的棋盘状态
-                            saveBoardState();
-                            // 重绘游戏界面
-                            drawGameScreen();
-                        }
-                    }
-                } else if (M5Cardputer.Keyboard.isKeyPressed(';')) {
-                    // 上箭头 - 选择上一个选项
-                    selectedOption = (selectedOption - 1 + 5) % 5;
-                    showStartScreen();
-                } else if (M5Cardputer.Keyboard.isKeyPressed('.')) {
-                    // 下箭头 - 选择下一个选项
-                    selectedOption = (selectedOption + 1) % 5;
-                    showStartScreen();
-                }
+        // SD卡初始化成功，检查存档是否存在
+        if (!SD.exists(CHESS_JOURNAL_FILE) && !SD.exists(CHESS_SAVE_FILE)) {
+            showMessageScreen("No saved game");
+            return;
+        }
+        if (!loadBoardState()) {
+            showMessageScreen("Failed to load game");
+            return;
+        }
+        enterGame();
+        // 存档只保存局面，走法记录从这里开始
+        gameRecord.reset(chessBoard);
+        startPgnGame();
+        drawGameScreen();
+        // 如果现在是AI的回合，AI在后台开始搜索
+        startAiTurn();
+        return;
+    } else if (selectedOption == 4) {
+        // 谜题模式
+        isPuzzleMode = true;
+        // 优先使用SD卡谜题包，否则使用编译期生成的内置谜题
+        openPuzzleSources();
+        if (getPuzzleCount() == 0) {
+            // 谜题加载失败，返回主菜单
+            isPuzzleMode = false;
+            showStartScreen();
+            return;
+        }
+        // 上次没做完的谜题优先，否则随机选择一个谜题
+        if (puzzleProgress.isOpen() && !puzzleProgress.isSolved(puzzleProgress.getLastIndex())) {
+            currentPuzzleIndex = puzzleProgress.getLastIndex();
+        } else {
+            currentPuzzleIndex = pickPuzzleIndex();
+        }
+        loadPuzzle(currentPuzzleIndex, currentPuzzle);
+        // 真正开始一道题时才记下序号（写入经队列在后台完成）
+        puzzleProgress.setLastIndex(currentPuzzleIndex);
+        // 从FEN加载棋盘
+        currentPuzzle.applyTo(chessBoard);
+        // 根据谜题的当前走棋方设置玩家颜色
+        isWhitePlayer = (currentPuzzle.getSideToMove() == Color::WHITE);
+        enterGame();
+        // 重置当前走法索引
+        currentMoveIndex = 0;
+        drawGameScreen();
+        return;
+    }
+
+    // 开始新游戏：初始化棋盘，新建对局日志和走法记录；开机后才插的卡在这里挂载
+    mountSDCard(true);
+    chessBoard.initBoard();
+    gameRecord.reset(chessBoard);
+    startPgnGame();
+    saveBoardState();
+    enterGame();
+    drawGameScreen();
+    // 如果玩家选择黑方，AI（白方）在后台开始搜索第一步
+    startAiTurn();
+}
+
+// 开始界面的按键处理
+void handleStartKey(uint8_t key) {
+    if (key == 'g' || key == 'G') {
+        // 浏览PGN对局
+        if (openPgnLibrary()) {
+            activeScreen = SCREEN_PGN_BROWSER;
+            pgnGameIndex = 0;
+            pgnReader.load(pgnGameIndex, pgnInfo);
+            showPgnBrowser();
+        } else {
+            showMessageScreen(sdInitialized ? "No PGN games" : "SDCard not found");
+        }
+    } else if (key == ' ') {
+        // 根据选中的选项执行相应操作
+        startSelectedOption();
+    } else if (key == ';') {
+        // 上箭头 - 选择上一个选项
+        selectedOption = (selectedOption - 1 + 5) % 5;
+        showStartScreen();
+    } else if (key == '.') {
+        // 下箭头 - 选择下一个选项
+        selectedOption = (selectedOption + 1) % 5;
+        showStartScreen();
+    }
+}
+
+// PGN浏览界面的按键处理
+void handlePgnBrowserKey(uint8_t key) {
+    int count = pgnReader.count();
+    if (key == ';' || key == '.') {
+        int step = key == ';' ? -1 : 1;
+        pgnGameIndex = (pgnGameIndex + step + count) % count;
+        pgnReader.load(pgnGameIndex, pgnInfo);
+        showPgnBrowser();
+    } else if (key == ' ') {
+        // 载入整局，从第一步开始回放，退出回放后可以接着和AI下
+        if (!pgnReader.readMoves(pgnInfo, chessBoard, gameRecord)) {
+            serialPrintf("[SD] PGN game %d stopped at ply %d (illegal move)\n", pgnGameIndex + 1, gameRecord.getTotal());
+        }
+        isWhitePlayer = chessBoard.getCurrentPlayer() == Color::WHITE;
+        enterGame();
+        saveBoardState();
+        startPgnGame();
+        isReplayMode = true;
+        replayReturnPly = gameRecord.getTotal();
+        gameRecord.seek(chessBoard, 0);
+        drawGameScreen();
+    } else if (key == 'b' || key == 'B') {
+        showStartScreen();
+    }
+}
+
+// 谜题完成：显示完成信息，R/N/M 由 handlePuzzleDoneKey() 处理
+void showPuzzleDone() {
+    canvas->fillScreen(COLOR_BLACK);
+    canvas->setTextSize(2);
+    canvas->setTextColor(COLOR_WHITE);
+    canvas->setTextDatum(CC_DATUM);
+    canvas->drawString("Congratulations!", 120, 40);
+    canvas->drawString("Puzzle Completed!", 120, 65);
+
+    // 显示选项
+    canvas->setTextSize(1);
+    canvas->drawString("R:Retry", 80, 100);
+    canvas->drawString("N:Next Puzzle", 140, 100);
+    if (puzzleIndex.isOpen()) {
+        // 有索引时可以选下一题的主题和等级分
+        char filter[48];
+        snprintf(filter, sizeof(filter), "Theme: %s  Rating: %u", puzzleThemeName(puzzleTheme),
+                 (unsigned)puzzleTargetRating);
+        canvas->drawString(filter, 120, 85);
+        canvas->drawString("M:Main Menu", 70, 120);
+        canvas->drawString("T:Theme ;.:Rating", 170, 120);
+    } else {
+        canvas->drawString("M:Main Menu", 100, 120);
+    }
+    canvas->setTextDatum(TC_DATUM);
+    pushCanvas(canvas);
+    activeScreen = SCREEN_PUZZLE_DONE;
+}
+
+// 谜题完成界面的按键处理
+void handlePuzzleDoneKey(uint8_t key) {
+    if (key == 'r' || key == 'R') {
+        // 重试当前谜题
+        currentPuzzle.applyTo(chessBoard);
+        currentMoveIndex = 0;
+        activeScreen = SCREEN_GAME;
+        drawGameScreen();
+    } else if (key == 'n' || key == 'N') {
+        // 下一个谜题
+        currentPuzzleIndex = puzzleIndex.isOpen() ? pickPuzzleIndex() : findUnsolvedPuzzle((currentPuzzleIndex + 1) % getPuzzleCount());
+        loadPuzzle(currentPuzzleIndex, currentPuzzle);
+        puzzleProgress.setLastIndex(currentPuzzleIndex);
+        currentPuzzle.applyTo(chessBoard);
+        // 谜题模式下白棋永远在下方，所以isWhitePlayer始终为true
+        isWhitePlayer = true;
+        currentMoveIndex = 0;
+        enterGame();
+        drawGameScreen();
+    } else if (key == 'm' || key == 'M') {
+        // 回到主菜单
+        isPuzzleMode = false;
+        currentMoveIndex = 0;
+        showStartScreen();
+    } else if (puzzleIndex.isOpen() && (key == 't' || key == 'T')) {
+        // 换下一题的主题
+        puzzleTheme = (puzzleTheme + 1) % PUZZLE_THEME_COUNT;
+        showPuzzleDone();
+    } else if (puzzleIndex.isOpen() && (key == ';' || key == '.')) {
+        // 调高/调低下一题的目标等级分
+        if (key == ';' && puzzleTargetRating + PUZZLE_RATING_STEP <= PUZZLE_RATING_MAX) {
+            puzzleTargetRating += PUZZLE_RATING_STEP;
+        } else if (key == '.' && puzzleTargetRating >= PUZZLE_RATING_MIN + PUZZLE_RATING_STEP) {
+            puzzleTargetRating -= PUZZLE_RATING_STEP;
+        }
+        showPuzzleDone();
+    }
+}
+
+// 谜题提示：高亮正解这一步的起点和终点，任意键回到棋盘
+Position hintSavedSelection = Position(-1, -1);
+
+void showPuzzleHint() {
+    // 获取正确的下一步移动
+    Move correctMove = currentPuzzle.getMove(currentMoveIndex);
+
+    // 保存当前选中状态
+    hintSavedSelection = chessBoard.getSelectedPiece();
+    chessBoard.deselectPiece();
+
+    // 重新绘制游戏界面
+    drawGameScreen();
+
+    // 高亮显示正确的起始位置，连同起始位置的棋子一起画
+    int screenX, screenY;
+    bool isWhiteBottom = true;
+    boardToScreen(correctMove.from, screenX, screenY, isWhiteBottom);
+    drawSquare(canvas, chessBoard.getPiece(correctMove.from), screenX, screenY, TILE_VALID_MOVE);
+
+    // 高亮显示目标位置，如果目标位置有棋子，连同棋子一起画
+    boardToScreen(correctMove.to, screenX, screenY, isWhiteBottom);
+    drawSquare(canvas, chessBoard.getPiece(correctMove.to), screenX, screenY, TILE_VALID_MOVE);
+
+    pushCanvas(canvas);
+    activeScreen = SCREEN_PUZZLE_HINT;
+}
+
+// 谜题提示界面：任意键恢复选中状态，回到棋盘
+void handlePuzzleHintKey(uint8_t key) {
+    (void)key;
+    if (hintSavedSelection.isValid()) {
+        chessBoard.selectPiece(hintSavedSelection);
+    }
+    activeScreen = SCREEN_GAME;
+    drawGameScreen();
+}
+
+// 谜题走错：撤销这一步，在右上角提示，任意键消除
+void showWrongMove() {
+    chessBoard.undoMove();
+    puzzleProgress.addAttempt(currentPuzzleIndex);
+
+    canvas->setTextColor(COLOR_WHITE, COLOR_BLACK);
+    canvas->setTextSize(1);
+    const char* wrongMoveText = "Wrong Move!";
+    int textWidth = canvas->textWidth(wrongMoveText);
+    int textX = canvas->width() - textWidth - 10;
+    int textY = 1;
+    canvas->drawString(wrongMoveText, textX, textY);
+    pushCanvas(canvas);
+    activeScreen = SCREEN_WRONG_MOVE;
+}
+
+// 光标处按空格：选择棋子，或把选中的棋子走到光标处
+void selectOrMoveAtCursor() {
+    Position currentPos(cursorX, cursorY);
+    if (!chessBoard.getSelectedPiece().isValid()) {
+        // 选择棋子
+        chessBoard.selectPiece(currentPos);
+        return;
+    }
+
+    // 尝试移动棋子
+    Position fromPos = chessBoard.getSelectedPiece();
+    // 走子前的棋子，供滑动动画使用
+    Piece movingPiece = chessBoard.getPiece(fromPos);
+    Piece capturedPiece = chessBoard.getPiece(currentPos);
+    if (!chessBoard.movePiece(fromPos, currentPos)) {
+        // 移动失败，尝试选择新的棋子
+        chessBoard.selectPiece(currentPos);
+        return;
+    }
+    // 移动成功，movePiece 内已切换玩家并取消选中
+    chessBoard.deselectPiece();
+    Move playerMove(fromPos, currentPos);
+
+    if (!isPuzzleMode) {
+        // 正常游戏模式：记录玩家的走法，播放落子动画，同时AI在后台开始搜索
+        journalMove(playerMove);
+        animateMove(playerMove, movingPiece, capturedPiece);
+        startAiTurn();
+        return;
+    }
+
+    // 谜题模式：检查当前走法是否与正解序列匹配
+    if (currentMoveIndex >= currentPuzzle.getMoveCount() || !(playerMove == currentPuzzle.getMove(currentMoveIndex))) {
+        showWrongMove();
+        return;
+    }
+    // 走法正确，更新走法索引
+    currentMoveIndex++;
+    if (currentMoveIndex >= currentPuzzle.getMoveCount()) {
+        puzzleProgress.markSolved(currentPuzzleIndex);
+        showPuzzleDone();
+        return;
+    }
+    animateMove(playerMove, movingPiece, capturedPiece);
+    // 自动执行对手的走法：停一会让玩家看清楚，由 updateGameActivity() 走出
+    if (currentMoveIndex % 2 != 0) {
+        hasPuzzleReply = true;
+        puzzleReplyTime = millis() + PUZZLE_REPLY_DELAY_MS;
+    }
+}
+
+// 回放模式的按键：左右逐步，上下每次跳一个关键帧间隔，P或ESC回到对局
+void handleReplayKey(uint8_t key) {
+    int ply = gameRecord.getPly();
+    if (key == ',') {
+        ply--;
+    } else if (key == '/') {
+        ply++;
+    } else if (key == ';') {
+        ply -= GAME_RECORD_KEYFRAME_INTERVAL;
+    } else if (key == '.') {
+        ply += GAME_RECORD_KEYFRAME_INTERVAL;
+    } else if (key == 'p' || key == 'P' || key == '`') {
+        ply = replayReturnPly;
+        isReplayMode = false;
+    }
+    if (ply < 0) ply = 0;
+    if (ply > gameRecord.getTotal()) ply = gameRecord.getTotal();
+    gameRecord.seek(chessBoard, ply);
+    // 高亮这一步的走法
+    if (ply > 0) {
+        Move last = gameRecord.getMove(ply - 1);
+        aiLastMoveFrom = last.from;
+        aiLastMoveTo = last.to;
+    } else {
+        aiLastMoveFrom = Position(-1, -1);
+        aiLastMoveTo = Position(-1, -1);
+    }
+    drawGameScreen();
+    // 回到对局时如果轮到AI，重新开始搜索
+    startAiTurn();
+}
+
+// 游戏界面的按键处理
+// 光标移动一格：单击在边上绕到另一边，按住自动重复时停在边上，不会一路绕圈
+int stepCursor(int value, int step, bool repeat) {
+    int next = value + step;
+    if (next < 0 || next > 7) {
+        return repeat ? value : (next + 8) % 8;
+    }
+    return next;
+}
+
+void handleGameKey(uint8_t key, bool repeat) {
+    if (isReplayMode) {
+        handleReplayKey(key);
+        return;
+    }
+
+    // 根据棋盘朝向调整光标移动方向（谜题模式白方在下）
+    bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
+    int forward = isWhiteBottom ? 1 : -1;
+    if (chessBoard.getCurrentState() == PromotionSelecting) {
+        // 升变状态下的按键处理：左右选择，空格确认
+        if (key == ',') {
+            chessBoard.navigatePromotionSelection(-1);
+        } else if (key == '/') {
+            chessBoard.navigatePromotionSelection(1);
+        } else if (key == ' ') {
+            chessBoard.confirmPromotion();
+            if (!isPuzzleMode) {
+                confirmJournalPromotion();
+                startAiTurn();
             }
+        }
+    } else if (key == '`') {
+        // ESC键处理
+        if (isPuzzleMode) {
+            // 谜题模式：直接重置为当前谜题的初始状态
+            cancelPendingMoves();
+            currentPuzzle.applyTo(chessBoard);
+            currentMoveIndex = 0;
+            enterGame();
         } else {
-                // 游戏界面的按键处理
-                
-                // 检查是否处于升变状态
-                if (chessBoard.getCurrentState() == PromotionSelecting) {
-                    // 升变状态下的按键处理
-                    if (M5Cardputer.Keyboard.isKeyPressed(',')) {
-                        // 左箭头 - 向左选择
-                        chessBoard.navigatePromotionSelection(-1);
-                    } else if (M5Cardputer.Keyboard.isKeyPressed('/')) {
-                        // 右箭头 - 向右选择
-                        chessBoard.navigatePromotionSelection(1);
-                    } else if (M5Cardputer.Keyboard.isKeyPressed(' ')) {
-                        // 空格键 - 确认选择
-                        chessBoard.confirmPromotion();
-                    }
-                } else {
-                    // 正常游戏状态下的按键处理
-                    if (M5Cardputer.Keyboard.isKeyPressed('`')) {
-                        // ESC键处理
-                        if (isPuzzleMode) {
-                            // 谜题模式：直接重置为当前谜题的初始状态
-                            const Puzzle& selectedPuzzle = puzzles[currentPuzzleIndex];
-                            // 加载谜题初始局面
-                            chessBoard.fromFEN(selectedPuzzle.getFEN());
-                            // 重置当前走法索引
-                            currentMoveIndex = 0;
-                            // 重置AI走棋记录
-                            aiLastMoveFrom = Position(-1, -1);
-                            aiLastMoveTo = Position(-1, -1);
-                            // 重置光标位置
-                            // 谜题模式下白棋永远在下方，所以cursorX和cursorY的计算基于白棋视角
-                            bool isWhitePerspective = isPuzzleMode ? true : isWhitePlayer;
-                            if (!isWhitePerspective) {
-                                cursorX = 0;
-                                cursorY = 7;
-                            } else {
-                                cursorX = 0;
-                                cursorY = 0;
-                            }
-                        } else {
-                            // 正常游戏模式：显示重置棋盘确认对话框
-                            if (showConfirmDialog("Reset board?")) {
-                                // 重置棋盘
-                                chessBoard.initBoard();
-                                // 重置AI走棋记录
-                                aiLastMoveFrom = Position(-1, -1);
-                                aiLastMoveTo = Position(-1, -1);
-                                // 重置光标位置
-                                if (!isWhitePlayer) {
-                                    cursorX = 0;
-                                    cursorY = 7;
-                                } else {
-                                    cursorX = 0;
-                                    cursorY = 0;
-                                }
-                                // 保存重置后的棋盘状态
-                                saveBoardState();
-                            }
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed(';')) {
-                        // 上
-                        // 根据棋盘朝向调整光标移动方向
-                        bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
-                        if (isWhiteBottom) {
-                            cursorY = (cursorY + 1) % 8;
-                        } else {
-                            cursorY = (cursorY - 1 + 8) % 8;
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed('.')) {
-                        // 下
-                        // 根据棋盘朝向调整光标移动方向
-                        bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
-                        if (isWhiteBottom) {
-                            cursorY = (cursorY - 1 + 8) % 8;
-                        } else {
-                            cursorY = (cursorY + 1) % 8;
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed(',')) {
-                        // 左
-                        // 根据棋盘朝向调整光标移动方向
-                        bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
-                        if (isWhiteBottom) {
-                            cursorX = (cursorX - 1 + 8) % 8;
-                        } else {
-                            cursorX = (cursorX + 1) % 8;
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed('/')) {
-                        // 右
-                        // 根据棋盘朝向调整光标移动方向
-                        bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
-                        if (isWhiteBottom) {
-                            cursorX = (cursorX + 1) % 8;
-                        } else {
-                            cursorX = (cursorX - 1 + 8) % 8;
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed(KEY_TAB)) {
-                        // TAB键 - 显示提示
-                        if (isPuzzleMode) {
-                            const Puzzle& localPuzzle = puzzles[currentPuzzleIndex];
-                            const std::vector<Move>& mainLine = localPuzzle.getMainLine();
-                            
-                            // 检查是否还有下一步移动
-                            if (currentMoveIndex < mainLine.size()) {
-                                // 获取正确的下一步移动
-                                const Move& correctMove = mainLine[currentMoveIndex];
-                                
-                                // 高亮显示正确的移动
-                                std::vector<Position> tipMoves;
-                                tipMoves.push_back(correctMove.to);
-                                
-                                // 保存当前选中状态
-                                Position savedSelected = chessBoard.getSelectedPiece();
-                                chessBoard.deselectPiece();
-                                
-                                // 重新绘制游戏界面
-                                drawGameScreen();
-                                
-                                // 高亮显示正确的目标位置
-                                int screenX, screenY;
-                                // 使用与drawGameScreen相同的逻辑来确定棋盘朝向
-                                bool isWhiteBottom = isPuzzleMode ? true : isWhitePlayer;
-                                boardToScreen(correctMove.from, screenX, screenY, isWhiteBottom);
-                                canvas->fillRect(screenX, screenY, SQUARE_SIZE, SQUARE_SIZE, COLOR_VALID_MOVE);
-                                // 重新绘制起始位置的棋子
-                                const Piece& piece = chessBoard.getPiece(correctMove.from);
-                                if (!piece.isEmpty()) {
-                                    drawPiece(canvas, piece, screenX, screenY);
-                                }
-                                
-                                // 高亮显示目标位置
-                                boardToScreen(correctMove.to, screenX, screenY, isWhiteBottom);
-                                canvas->fillRect(screenX, screenY, SQUARE_SIZE, SQUARE_SIZE, COLOR_VALID_MOVE);
-                                
-                                // 如果目标位置有棋子，重新绘制
-                                const Piece& targetPiece = chessBoard.getPiece(correctMove.to);
-                                if (!targetPiece.isEmpty()) {
-                                    drawPiece(canvas, targetPiece, screenX, screenY);
-                                }
-                                
-                                canvas->pushSprite(0, 0);
-                                
-                                // 等待玩家按下任何键
-                                while (true) {
-                                    M5Cardputer.update();
-                                    M5Cardputer.Keyboard.updateKeyList();
-                                    if (M5Cardputer.Keyboard.isPressed() > 0) {
-                                        break;
-                                    }
-                                }
-                                
-                                // 恢复选中状态
-                                if (savedSelected.isValid()) {
-                                    chessBoard.selectPiece(savedSelected);
-                                }
-                                
-                                // 重新绘制游戏界面
-                                drawGameScreen();
-                            }
-                        }
-                    } else if (M5Cardputer.Keyboard.isKeyPressed(' ')) {
-                            // 选择/落子
-                            Position currentPos(cursorX, cursorY);
-                            
-                            if (chessBoard.getSelectedPiece().isValid()) {
-                                // 尝试移动棋子
-                            Position fromPos = chessBoard.getSelectedPiece();
-                            if (chessBoard.movePiece(fromPos, currentPos)) {
-                                // 移动成功，switchPlayer is already called inside movePiece
-                                // 取消选中（虽然movePiece也会调用deselectPiece，但确保双重保险）
-                                chessBoard.deselectPiece();
-                                
-                                // 谜题模式特殊处理
-                                if (isPuzzleMode) {
-                                    const Puzzle& localPuzzle = puzzles[currentPuzzleIndex];
-                                    const std::vector<Move>& mainLine = localPuzzle.getMainLine();
-                                    
-                                    // 检查当前走法是否与正解序列匹配
-                                    Move playerMove(fromPos, currentPos);
-                                    if (currentMoveIndex < mainLine.size() && playerMove == mainLine[currentMoveIndex]) {
-                                        // 走法正确，更新走法索引
-                                        currentMoveIndex++;
-                                        
-                                        // 检查是否完成谜题
-                                        if (currentMoveIndex >= mainLine.size()) {
-                                            // 谜题完成，显示完成信息
-                                            canvas->fillScreen(COLOR_BLACK);
-                                            canvas->setTextSize(2);
-                                            canvas->setTextColor(COLOR_WHITE);
-                                            canvas->setTextDatum(CC_DATUM);
-                                            canvas->drawString("Congratulations!", 120, 40);
-                                            canvas->drawString("Puzzle Completed!", 120, 65);
-                                            
-                                            // 显示选项
-                                            canvas->setTextSize(1);
-                                            canvas->drawString("R:Retry", 80, 100);
-                                            canvas->drawString("N:Next Puzzle", 140, 100);
-                                            canvas->drawString("M:Main Menu", 100, 120);
-                                            canvas->pushSprite(0, 0);
-                                            
-                                            // 等待用户输入
-                                            while (true) {
-                                                M5Cardputer.update();
-                                                if (M5Cardputer.Keyboard.isKeyPressed('r') || M5Cardputer.Keyboard.isKeyPressed('R')) {
-                                                    // 重试当前谜题
-                                                    chessBoard.fromFEN(currentPuzzle.getFEN());
-                                                    currentMoveIndex = 0;
-                                                    drawGameScreen();
-                                                    return;
-                                                } else if (M5Cardputer.Keyboard.isKeyPressed('n') || M5Cardputer.Keyboard.isKeyPressed('N')) {
-                                                    // 下一个谜题
-                                                    currentPuzzleIndex = (currentPuzzleIndex + 1) % puzzles.size();
-                                                    currentPuzzle = puzzles[currentPuzzleIndex];
-                                                    chessBoard.fromFEN(currentPuzzle.getFEN());
-                                                    // 谜题模式下白棋永远在下方，所以isWhitePlayer始终为true
-                                                    isWhitePlayer = true;
-                                                    currentMoveIndex = 0;
-                                                    // 重置光标位置
-                                                    if (!isWhitePlayer) {
-                                                        cursorX = 0;
-                                                        cursorY = 7;
-                                                    } else {
-                                                        cursorX = 0;
-                                                        cursorY = 0;
-                                                    }
-                                                    drawGameScreen();
-                                                    return;
-                                                } else if (M5Cardputer.Keyboard.isKeyPressed('m') || M5Cardputer.Keyboard.isKeyPressed('M')) {
-                                                    // 回到主菜单
-                                                    isGameStarted = false;
-                                                    isPuzzleMode = false;
-                                                    currentMoveIndex = 0;
-                                                    showStartScreen();
-                                                    return;
-                                                }
-                                                delay(50);
-                                            }
-                                        }
-                                        
-                                        // 如果还有更多走法，检查是否轮到谜题的下一个走法
-                                        if (currentMoveIndex < mainLine.size()) {
-                                            // 自动执行对手的走法（如果有的话）
-                                            if (currentMoveIndex % 2 != 0) {
-                                                // 延迟一下，让玩家看清楚
-                                                delay(500);
-                                                
-                                                Move nextMove = mainLine[currentMoveIndex];
-                                                chessBoard.movePiece(nextMove.from, nextMove.to);
-                                                aiLastMoveFrom = nextMove.from;
-                                                aiLastMoveTo = nextMove.to;
-                                                currentMoveIndex++;
-                                            }
-                                        }
-                                    } else {
-                                    // 走法错误，撤销当前移动并恢复棋盘状态
-                                    chessBoard.undoMove();
-                                    
-                                    // 显示错误信息
-                                    canvas->setTextColor(COLOR_WHITE, COLOR_BLACK);
-                                    canvas->setTextSize(1);
-                                    const char* wrongMoveText = "Wrong Move!";
-                                    int textWidth = canvas->textWidth(wrongMoveText);
-                                    int textX = canvas->width() - textWidth - 10;
-                                    int textY = 1;
-                                    canvas->drawString(wrongMoveText, textX, textY);
-                                    canvas->pushSprite(0, 0);
-                                    
-                                    // 两阶段按键处理：
-                                    // 1. 首先等待所有按键释放，清除当前按键状态
-                                    bool anyKeyPressed = true;
-                                    while (anyKeyPressed) {
-                                        M5Cardputer.update();
-                                        anyKeyPressed = false;
-                                        
-                                        // 检查字母键
-                                        for (int i = 0; i < 26; i++) {
-                                            if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                                anyKeyPressed = true;
-                                                break;
-                                            }
-                                        }
-                                        if (anyKeyPressed) { delay(50); continue; }
-                                        
-                                        // 检查数字键
-                                        for (int i = 0; i < 10; i++) {
-                                            if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                                anyKeyPressed = true;
-                                                break;
-                                            }
-                                        }
-                                        if (anyKeyPressed) { delay(50); continue; }
-                                        
-                                        // 检查特殊键
-                                        if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                            M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                            M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                            M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                            M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                            anyKeyPressed = true;
-                                        }
-                                        
-                                        if (anyKeyPressed) delay(50);
-                                    }
-                                    
-                                    // 2. 然后等待用户按下新的按键
-                                    bool keyPressed = false;
-                                    while (!keyPressed) {
-                                        M5Cardputer.update(); // 更新输入状态
-                                        // 检查任意按键是否被按下
-                                        for (int i = 0; i < 26; i++) {
-                                            if (M5Cardputer.Keyboard.isKeyPressed('a' + i) || M5Cardputer.Keyboard.isKeyPressed('A' + i)) {
-                                                keyPressed = true;
-                                                break;
-                                            }
-                                        }
-                                        if (keyPressed) break;
-                                        
-                                        // 检查数字键
-                                        for (int i = 0; i < 10; i++) {
-                                            if (M5Cardputer.Keyboard.isKeyPressed('0' + i)) {
-                                                keyPressed = true;
-                                                break;
-                                            }
-                                        }
-                                        if (keyPressed) break;
-                                        
-                                        // 检查特殊键
-                                        if (M5Cardputer.Keyboard.isKeyPressed(' ') || 
-                                            M5Cardputer.Keyboard.isKeyPressed(KEY_BACKSPACE) ||
-                                            M5Cardputer.Keyboard.isKeyPressed(KEY_ENTER) ||
-                                            M5Cardputer.Keyboard.isKeyPressed(';') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('.') ||
-                                            M5Cardputer.Keyboard.isKeyPressed(',') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('/') ||
-                                            M5Cardputer.Keyboard.isKeyPressed('`')) {
-                                            keyPressed = true;
-                                        }
-                                        
-                                        delay(50);
-                                    }
-                                    
-                                    // 消除错误信息，重绘游戏界面
-                                    drawGameScreen();
-                                    }
-                                } else {
-                                    // 正常游戏模式
-                                    // 保存玩家移动后的棋盘状态
-                                    saveBoardState();
-                                      
-                                    // 立即重绘游戏界面，显示玩家的落子效果
-                                    drawGameScreen();
-                                    
-                                    // 检查是否轮到AI走棋
-                                    Color aiColor = isWhitePlayer ? Color::BLACK : Color::WHITE;
-                                    if (chessBoard.getCurrentPlayer() == aiColor) {
-                                        // AI走棋
-                                        Move aiMove = chooseAIMove(aiColor, chessBoard);
-                                        if (aiMove.from.isValid() && aiMove.to.isValid()) {
-                                            // 记录AI走棋的起始位置和目标位置
-                                            aiLastMoveFrom = aiMove.from;
-                                            aiLastMoveTo = aiMove.to;
-                                            chessBoard.movePiece(aiMove.from, aiMove.to);
-                                            // 保存AI移动后的棋盘状态
-                                            saveBoardState();
-                                            
-                                            // AI走棋后重绘游戏界面
-                                            drawGameScreen();
-                                        }
-                                    }
-                                }
-                            } else {
-                                    // 移动失败，尝试选择新的棋子
-                                    chessBoard.selectPiece(currentPos);
-                                }
-                            } else {
-                                // 选择棋子
-                                chessBoard.selectPiece(currentPos);
-                            }
-                        }
-                }
-            
-            // 重绘游戏界面
+            // 正常游戏模式：显示重置棋盘确认框，Y/N 由 handleConfirmResetKey() 处理
+            showConfirmDialog("Reset board?");
+            activeScreen = SCREEN_CONFIRM_RESET;
+            return;
+        }
+    } else if (!isPuzzleMode && (key == 'z' || key == 'Z')) {
+        // 悔棋
+        stepHistory(true);
+    } else if (!isPuzzleMode && (key == 'y' || key == 'Y')) {
+        // 重做
+        stepHistory(false);
+    } else if (!isPuzzleMode && (key == 'p' || key == 'P')) {
+        // 进入回放模式，还没走出的AI走法作废，回到对局时重新搜索
+        cancelPendingMoves();
+        isReplayMode = true;
+        replayReturnPly = gameRecord.getPly();
+        chessBoard.deselectPiece();
+    } else if (key == ';') {
+        // 上
+        cursorY = stepCursor(cursorY, forward, repeat);
+    } else if (key == '.') {
+        // 下
+        cursorY = stepCursor(cursorY, -forward, repeat);
+    } else if (key == ',') {
+        // 左
+        cursorX = stepCursor(cursorX, -forward, repeat);
+    } else if (key == '/') {
+        // 右
+        cursorX = stepCursor(cursorX, forward, repeat);
+    } else if (key == KEY_TAB) {
+        // TAB键 - 谜题模式显示提示
+        if (isPuzzleMode && currentMoveIndex < currentPuzzle.getMoveCount()) {
+            showPuzzleHint();
+            return;
+        }
+    } else if (key == ' ') {
+        // 选择/落子
+        selectOrMoveAtCursor();
+    }
+
+    // 重绘游戏界面（切换到了提示、完成等界面时它们已经画好）
+    if (activeScreen == SCREEN_GAME) {
+        drawGameScreen();
+    }
+}
+
+// “重置棋盘？”确认框的按键处理
+void handleConfirmResetKey(uint8_t key) {
+    if (key == 'y' || key == 'Y') {
+        // 重置棋盘
+        cancelPendingMoves();
+        chessBoard.initBoard();
+        gameRecord.reset(chessBoard);
+        startPgnGame();
+        enterGame();
+        // 保存重置后的棋盘状态
+        saveBoardState();
+        // 玩家执黑时AI先走
+        startAiTurn();
+    } else if (key != 'n' && key != 'N') {
+        return;
+    }
+    activeScreen = SCREEN_GAME;
+    drawGameScreen();
+}
+
+// 把一个按键事件交给当前界面
+void dispatchKey(const KeyEvent& event) {
+    uint8_t key = event.key;
+    switch (activeScreen) {
+        case SCREEN_START:
+            handleStartKey(key);
+            break;
+        case SCREEN_PGN_BROWSER:
+            handlePgnBrowserKey(key);
+            break;
+        case SCREEN_MESSAGE:
+            // 任意键回到开始菜单
+            showStartScreen();
+            break;
+        case SCREEN_GAME:
+            handleGameKey(key, event.repeat);
+            break;
+        case SCREEN_CONFIRM_RESET:
+            handleConfirmResetKey(key);
+            break;
+        case SCREEN_PUZZLE_HINT:
+            handlePuzzleHintKey(key);
+            break;
+        case SCREEN_WRONG_MOVE:
+            // 任意键消除错误信息，重绘游戏界面
+            activeScreen = SCREEN_GAME;
             drawGameScreen();
+            break;
+        case SCREEN_PUZZLE_DONE:
+            handlePuzzleDoneKey(key);
+            break;
+    }
+}
+
+// 熄屏：light sleep 期间 LEDC 停止，背光无法保持，干脆让屏幕睡眠、关背光
+void setScreenAsleep(bool asleep) {
+    if (asleep == screenAsleep) {
+        return;
+    }
+    screenAsleep = asleep;
+    if (asleep) {
+        M5Cardputer.Display.sleep();
+    } else {
+        M5Cardputer.Display.wakeup();
+    }
+    serialPrintf("[POWER] Screen %s\n", asleep ? "off" : "on");
+}
+
+// 处理按键输入：扫描键盘，把新按下的键逐个交给当前界面，处理完立即返回
+// 返回是否有键按着（包括修饰键）
+bool handleKeyInput() {
+    uint8_t keys[KEY_SCAN_MAX];
+    int count = 0;
+    for (const auto& point : M5Cardputer.Keyboard.keyList()) {
+        if (count < KEY_SCAN_MAX) {
+            keys[count++] = M5Cardputer.Keyboard.getKey(point);
+        }
+    }
+    keyEvents.scan(keys, count, millis());
+
+    KeyEvent event;
+    if (screenAsleep && count > 0) {
+        // 熄屏时按下的键只用来亮屏，不交给界面
+        setScreenAsleep(false);
+        while (keyEvents.pop(event)) {
+        }
+        return true;
+    }
+    while (keyEvents.pop(event)) {
+        uint32_t latency = millis() - event.time;
+        if (latency > maxKeyLatency) {
+            maxKeyLatency = latency;
+        }
+        // 提示框、确认框只认真正按下的键，按住的方向键不会把它们直接关掉
+        if (event.repeat && activeScreen != SCREEN_START && activeScreen != SCREEN_PGN_BROWSER &&
+            activeScreen != SCREEN_GAME) {
+            continue;
+        }
+        dispatchKey(event);
+    }
+    return count > 0;
+}
+
+// 串口命令缓冲区（UCI的position命令可能很长）
+char serialCommandBuffer[1024];
+int serialCommandLength = 0;
+
+// UCI模式：串口收到"uci"后，后续命令交给UCI会话处理，直到"quit"
+bool uciMode = false;
+UciSession uciSession;
+
+// 串口 bench/uci 的搜索交给AI搜索任务执行（loop 任务的栈放不下深层搜索）
+struct SerialSearchJob {
+    const char* command;
+    int depth;
+    bool keepGoing;
+};
+
+void runUciJob(void* arg) {
+    SerialSearchJob* job = (SerialSearchJob*)arg;
+    job->keepGoing = uciSession.handleLine(job->command);
+}
+
+void runBenchJob(void* arg) {
+    SerialSearchJob* job = (SerialSearchJob*)arg;
+    runBench(job->depth, true, nullptr);
+}
+
+// 执行一条串口命令
+void runSerialCommand(const char* command) {
+    SerialSearchJob job = {command, 0, true};
+    if (uciMode) {
+        aiWorker.run(runUciJob, &job);
+        if (!job.keepGoing) {
+            uciMode = false;
+            setSerialLogEnabled(true);
+        }
+        return;
+    }
+    
+    if (strcmp(command, "uci") == 0) {
+        // 进入UCI模式，关闭调试输出避免干扰协议
+        uciMode = true;
+        setSerialLogEnabled(false);
+        uciSession.handleLine(command);
+    } else if (strcmp(command, "prof") == 0) {
+        // 输出热点函数的调用次数和周期数
+        profilerDump();
+        serialPrintf("[DRAW] Display DMA: %lu transfers, %lu pixels, %lu stalls\n",
+                     (unsigned long)displayPipeline.getTransfers(), (unsigned long)displayPipeline.getPixels(),
+                     (unsigned long)displayPipeline.getStalls());
+        serialPrintf("[DRAW] Animation: %lu frames, %lu dropped; last AI search %lu ms\n",
+                     (unsigned long)animationFrames.getFrames(), (unsigned long)animationFrames.getDropped(),
+                     (unsigned long)aiWorker.getSearchMillis());
+        serialPrintf("[KEY] %lu presses, %lu repeats, %lu dropped, max latency %lu ms\n",
+                     (unsigned long)keyEvents.getPresses(), (unsigned long)keyEvents.getRepeats(),
+                     (unsigned long)keyEvents.getDropped(), (unsigned long)maxKeyLatency);
+        for (int i = 0; i < POWER_STATE_COUNT; i++) {
+            PowerState state = (PowerState)i;
+            const PowerStateStats& stats = idleGovernor.getStats(state);
+            uint32_t duty = idleGovernor.getDutyPermille(state);
+            serialPrintf("[POWER] %-6s %8lu loops, %8lu ms awake, %8lu ms resting, duty %lu.%lu%%\n",
+                         IdleGovernor::stateName(state), (unsigned long)stats.loops,
+                         (unsigned long)(stats.awakeMicros / 1000), (unsigned long)(stats.restMicros / 1000),
+                         (unsigned long)(duty / 10), (unsigned long)(duty % 10));
         }
+    } else if (strcmp(command, "prof reset") == 0) {
+        profilerReset();
+        idleGovernor.resetStats();
+        maxKeyLatency = 0;
+        serialPrintln("[PROF] counters reset");
+    } else if (strcmp(command, "bench") == 0 || strncmp(command, "bench ", 6) == 0) {
+        // 标准基准测试：bench [深度]，输出节点签名和 nps
+        int depth = command[5] == ' ' ? atoi(command + 6) : BENCH_DEFAULT_DEPTH;
+        if (depth > BENCH_MAX_DEPTH) depth = BENCH_MAX_DEPTH;
+        job.depth = depth > 0 ? depth : BENCH_DEFAULT_DEPTH;
+        aiWorker.run(runBenchJob, &job);
+    } else if (command[0] != '\0') {
+        serialPrintf("Unknown command: %s\n", command);
     }
 }
 
+// 非阻塞读取串口命令（以换行结束），返回是否收到了数据
+bool handleSerialCommands() {
+    bool received = false;
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+        if (c == '\r' || c == '\n') {
+            serialCommandBuffer[serialCommandLength] = '\0';
+            runSerialCommand(serialCommandBuffer);
+            serialCommandLength = 0;
+        } else if (serialCommandLength < (int)sizeof(serialCommandBuffer) - 1) {
+            serialCommandBuffer[serialCommandLength++] = c;
+        }
+        received = true;
+    }
+    return received;
+}
+
 void setup() {
     // 初始化M5Cardputer
     M5Cardputer.begin();
@@ -1245,11 +1697,40 @@ void setup() {
     M5Cardputer.Display.init();
     M5Cardputer.Display.setRotation(1);
     M5Cardputer.Keyboard.begin();
+    KeyRepeatConfig repeatConfig = KeyEventQueue::defaultConfig();
+    repeatConfig.keys = REPEAT_KEYS;
+    keyEvents.configure(repeatConfig);
     
     // 创建画布
     canvas = new M5Canvas(&M5Cardputer.Display);
+#if defined(CARDCHESS_PALETTE_CANVAS)
+    // 8位调色板画布：帧缓冲减半，推送时按调色板转换成RGB565，颜色不变
+    canvas->setColorDepth(8);
+#endif
     canvas->createSprite(M5Cardputer.Display.width(), M5Cardputer.Display.height());
     canvas->setTextDatum(TC_DATUM);
+    // 推屏走 DMA：发出传输后立即返回，下一帧的绘制与 SPI 传输并行
+    lcdLink.begin();
+    displayPipeline.begin(&lcdLink);
+    // 开机挂载SD卡，谜题包、对局日志和PGN记谱都要用；没插卡时照常启动
+    if (!mountSDCard(true)) {
+        serialPrintln("[SD] No SD card at startup, saving is disabled until one is inserted");
+    }
+    // AI在 core 0 的后台任务里搜索；随机选择使用硬件随机数做种子（没有RTC同步时 time(NULL) 总是0）
+    aiWorker.begin(esp_random());
+    {
+        // 图标只在建调色板和图块时整体解码一次，解码结果用完即释放
+        std::vector<uint16_t> iconPixels;
+        TileIcon icons[TILE_PIECES];
+        decodePieceIcons(iconPixels, icons);
+#if defined(CARDCHESS_PALETTE_CANVAS)
+        buildCanvasPalette(canvas, icons);
+#endif
+        buildPieceTiles(icons);
+    }
+    serialPrintf("[DRAW] Canvas %dx%d, %d bpp, %u bytes, free heap %u bytes\n",
+                 (int)canvas->width(), (int)canvas->height(), CANVAS_COLOR_BITS,
+                 (unsigned)(canvas->width() * canvas->height() * CANVAS_COLOR_BITS / 8), (unsigned)ESP.getFreeHeap());
     
     // 显示开始界面
     showStartScreen();
@@ -1258,10 +1739,46 @@ void setup() {
     Serial.println("Chess app started!");
 }
 
+// 两轮 loop() 之间休息：light sleep 由定时器唤醒，其余用 delay() 让出CPU（空闲任务执行 waiti）
+void restUntilNextLoop(PowerState state, uint32_t restMicros) {
+    // 进入 light sleep 前熄屏；离开时（按键、插上USB串口）亮屏
+    setScreenAsleep(state == POWER_SLEEP);
+    if (restMicros == 0) {
+        return;
+    }
+    if (state == POWER_SLEEP) {
+        esp_sleep_enable_timer_wakeup(restMicros);
+        esp_light_sleep_start();
+        return;
+    }
+    delay(restMicros / 1000);
+}
+
 void loop() {
+    idleGovernor.beginLoop(micros());
+    
     // 更新M5Cardputer
     M5Cardputer.update();
     
+    // 上一帧的传输结束后释放屏幕总线
+    displayPipeline.poll();
+    
     // 处理按键输入
-    handleKeyInput();
+    bool input = handleKeyInput();
+    
+    // 推进走子动画，走出后台AI算好的走法
+    updateGameActivity();
+    
+    // 处理串口命令
+    input = handleSerialCommands() || input;
+    
+    // 有活动时按帧率运行；light sleep 会暂停屏幕DMA、后台任务和USB串口，
+    // 只在这些都空闲且没有连着USB串口（电池供电）时使用
+    bool active = input || moveAnimation.isActive() || hasPuzzleReply || aiWorker.isBusy() ||
+                  displayPipeline.isBusy() || journalQueue.hasPending() || pgnQueue.hasPending() ||
+                  progressQueue.hasPending();
+    bool canSleep = !uciMode && !Serial;
+    uint32_t restMicros;
+    PowerState state = idleGovernor.endLoop(micros(), millis(), active, canSleep, restMicros);
+    restUntilNextLoop(state, restMicros);
 }
\ No newline at end of file
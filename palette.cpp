@@ -0,0 +1,51 @@
+#include "palette.h"
+
+int CanvasPalette::add(uint16_t color) {
+  for (int i = 0; i < count; i++) {
+    if (colors[i] == color) {
+      return i;
+    }
+  }
+  if (count >= CANVAS_PALETTE_SIZE) {
+    return -1;
+  }
+  colors[count] = color;
+  return count++;
+}
+
+void CanvasPalette::addImage(const uint16_t* pixels, int size, uint16_t transparent) {
+  for (int i = 0; i < size; i++) {
+    if (pixels[i] != transparent) {
+      add(pixels[i]);
+    }
+  }
+}
+
+uint8_t CanvasPalette::indexOf(uint16_t color) const {
+  int best = 0;
+  int32_t bestDistance = -1;
+  for (int i = 0; i < count; i++) {
+    if (colors[i] == color) {
+      return (uint8_t)i;
+    }
+    int dr = (int)(colors[i] >> 11) - (int)(color >> 11);
+    int dg = (int)((colors[i] >> 5) & 0x3F) - (int)((color >> 5) & 0x3F);
+    int db = (int)(colors[i] & 0x1F) - (int)(color & 0x1F);
+    // 绿色分量多一位，红蓝按2倍折算到同一刻度
+    int32_t distance = 4 * dr * dr + dg * dg + 4 * db * db;
+    if (bestDistance < 0 || distance < bestDistance) {
+      best = i;
+      bestDistance = distance;
+    }
+  }
+  return (uint8_t)best;
+}
+
+void CanvasPalette::toRGB888(uint16_t color, uint8_t& r, uint8_t& g, uint8_t& b) {
+  uint8_t r5 = color >> 11;
+  uint8_t g6 = (color >> 5) & 0x3F;
+  uint8_t b5 = color & 0x1F;
+  r = (uint8_t)((r5 << 3) | (r5 >> 2));
+  g = (uint8_t)((g6 << 2) | (g6 >> 4));
+  b = (uint8_t)((b5 << 3) | (b5 >> 2));
+}
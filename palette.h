@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+// 画布调色板：收集界面和棋子图标用到的全部 RGB565 颜色，8位调色板画布用下标作画，
+// 推送到屏幕时再查表还原，颜色与16位画布完全相同
+//   界面颜色按 add() 的顺序占据最前面的下标，绘制代码可以把它们当作常量使用
+//   图标颜色去重后依次追加；超过 CANVAS_PALETTE_SIZE 时 indexOf() 退回最接近的颜色
+const int CANVAS_PALETTE_SIZE = 256;
+
+class CanvasPalette {
+private:
+  uint16_t colors[CANVAS_PALETTE_SIZE];
+  int count;
+
+public:
+  CanvasPalette() : count(0) {}
+
+  // 加入一种颜色，返回它的下标（已有时返回原下标，调色板满时返回-1）
+  int add(uint16_t color);
+
+  // 加入图标中除透明色外的所有颜色
+  void addImage(const uint16_t* pixels, int size, uint16_t transparent);
+
+  // 颜色对应的下标，不在调色板中时取RGB距离最近的
+  uint8_t indexOf(uint16_t color) const;
+
+  int getCount() const { return count; }
+  uint16_t getColor(int index) const { return colors[index]; }
+
+  // RGB565 展开为 8位分量，低位用高位填充（再截回565时与原值相同）
+  static void toRGB888(uint16_t color, uint8_t& r, uint8_t& g, uint8_t& b);
+};
@@ -0,0 +1,456 @@
+#include "pgn.h"
+
+const char* const PGN_START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Result 标签值连同 "] 占用的固定宽度，最长的 1/2-1/2 正好放下
+static const size_t PGN_RESULT_FIELD = 9;
+
+// ==========================================
+// 导出
+// ==========================================
+
+bool PgnWriter::writeText(const char* text, size_t len) {
+  if (!file->writeAt(end, (const uint8_t*)text, len)) {
+    return false;
+  }
+  end += len;
+  return true;
+}
+
+// 写一个词，前面补空格，超出行宽时换行
+bool PgnWriter::writeToken(const char* token) {
+  size_t len = strlen(token);
+  if (column > 0) {
+    bool wrap = column + 1 + len > (size_t)PGN_LINE_WIDTH;
+    if (!writeText(wrap ? "\n" : " ", 1)) return false;
+    column = wrap ? 0 : column + 1;
+  }
+  if (!writeText(token, len)) return false;
+  column += len;
+  return true;
+}
+
+bool PgnWriter::writeResultTag(const char* result) {
+  char value[PGN_RESULT_FIELD + 1];
+  size_t len = snprintf(value, sizeof(value), "%s\"]", result);
+  memset(value + len, ' ', PGN_RESULT_FIELD - len);
+  return file->writeAt(resultOffset, (const uint8_t*)value, PGN_RESULT_FIELD);
+}
+
+bool PgnWriter::begin(BlockFile* blockFile, const ChessBoard& start, const char* white, const char* black) {
+  close();
+  file = blockFile;
+  end = blockFile->size();
+  ply = 0;
+  startPly = (start.getFullmoveNumber() - 1) * 2 + (start.getCurrentPlayer() == BLACK ? 1 : 0);
+  column = 0;
+  finished = false;
+
+  // 与上一局之间空一行
+  char line[FEN_BUFFER_SIZE + 16];
+  bool ok = end == 0 || writeText("\n", 1);
+  const char* tags[][2] = {
+    {"Event", "CardChess game"},
+    {"Site", "M5Stack Cardputer"},
+    {"Date", "????.??.??"},
+    {"Round", "-"},
+    {"White", white},
+    {"Black", black},
+  };
+  for (size_t i = 0; ok && i < sizeof(tags) / sizeof(tags[0]); i++) {
+    size_t len = snprintf(line, sizeof(line), "[%s \"%s\"]\n", tags[i][0], tags[i][1]);
+    ok = writeText(line, len < sizeof(line) ? len : sizeof(line) - 1);
+  }
+  ok = ok && writeText("[Result \"", 9);
+  resultOffset = end;
+  ok = ok && writeResultTag("*");
+  end += PGN_RESULT_FIELD;
+  ok = ok && writeText("\n", 1);
+
+  char fen[FEN_BUFFER_SIZE];
+  start.writeFEN(fen, sizeof(fen));
+  if (ok && strcmp(fen, PGN_START_FEN) != 0) {
+    size_t len = snprintf(line, sizeof(line), "[SetUp \"1\"]\n[FEN \"%s\"]\n", fen);
+    ok = writeText(line, len < sizeof(line) ? len : sizeof(line) - 1);
+  }
+  ok = ok && writeText("\n", 1);
+  movesStart = end;
+  plyOffset[0] = 0;
+  plyColumn[0] = 0;
+  file->flush();
+  if (!ok) {
+    serialPrintln("[SD] Failed to write PGN tags");
+    close();
+  }
+  return ok;
+}
+
+bool PgnWriter::appendMove(const Move& move, const ChessBoard& board) {
+  if (file == nullptr || finished || ply >= GAME_RECORD_MAX_PLIES) {
+    return false;
+  }
+  // SAN 的消歧义和将军标记都要以走子前的局面为准
+  ChessBoard before = board;
+  before.unmakeMove(move, board.getLastUndoInfo());
+  char san[SAN_BUFFER_SIZE];
+  if (before.formatSAN(move, san, sizeof(san)) == 0) {
+    return false;
+  }
+
+  int halfmove = startPly + ply;
+  char number[12];
+  bool ok = true;
+  if (halfmove % 2 == 0 || ply == 0) {
+    snprintf(number, sizeof(number), halfmove % 2 == 0 ? "%d." : "%d...", halfmove / 2 + 1);
+    ok = writeToken(number);
+  }
+  ok = ok && writeToken(san);
+  ply++;
+  plyOffset[ply] = (uint16_t)(end - movesStart);
+  plyColumn[ply] = column;
+
+  // 将死或逼和时直接结束（读棋盘的合法走法缓存，不展开走法列表）
+  if (ok && !board.hasValidMoves()) {
+    Color side = board.getCurrentPlayer();
+    return finish(board.isInCheck(side) ? (side == WHITE ? "0-1" : "1-0") : "1/2-1/2");
+  }
+  file->flush();
+  return ok;
+}
+
+bool PgnWriter::truncate(int toPly) {
+  if (file == nullptr || toPly < 0 || toPly > ply) {
+    return false;
+  }
+  uint32_t newEnd = movesStart + plyOffset[toPly];
+  char spaces[16];
+  memset(spaces, ' ', sizeof(spaces));
+  bool ok = true;
+  for (uint32_t pos = newEnd; ok && pos < end; pos += sizeof(spaces)) {
+    size_t n = end - pos < sizeof(spaces) ? end - pos : sizeof(spaces);
+    ok = file->writeAt(pos, (const uint8_t*)spaces, n);
+  }
+  if (finished) {
+    ok = ok && writeResultTag("*");
+    finished = false;
+  }
+  end = newEnd;
+  column = plyColumn[toPly];
+  ply = toPly;
+  file->flush();
+  return ok;
+}
+
+bool PgnWriter::finish(const char* result) {
+  if (file == nullptr || finished) {
+    return false;
+  }
+  bool ok = writeToken(result) && writeText("\n", 1) && writeResultTag(result);
+  finished = true;
+  file->flush();
+  return ok;
+}
+
+// ==========================================
+// 导入
+// ==========================================
+
+bool PgnReader::open(BlockFile* blockFile) {
+  file = blockFile;
+  total = -1;
+  anchorCount = 0;
+  rewind();
+  return true;
+}
+
+void PgnReader::seekTo(uint32_t offset) {
+  file->seek(offset);
+  bufferStart = offset;
+  bufferPos = 0;
+  bufferLen = 0;
+  atLineStart = true;
+}
+
+void PgnReader::rewind() {
+  nextIndex = 0;
+  if (file == nullptr) {
+    return;
+  }
+  seekTo(0);
+  // 跳过 UTF-8 BOM
+  if (peekChar() == 0xEF) {
+    readChar();
+    readChar();
+    readChar();
+    atLineStart = true;
+  }
+}
+
+int PgnReader::peekChar() {
+  if (bufferPos >= bufferLen) {
+    bufferStart += bufferLen;
+    bufferLen = (uint8_t)file->read(buffer, sizeof(buffer));
+    bufferPos = 0;
+    if (bufferLen == 0) {
+      return -1;
+    }
+  }
+  return buffer[bufferPos];
+}
+
+int PgnReader::readChar() {
+  int c = peekChar();
+  if (c >= 0) {
+    bufferPos++;
+    atLineStart = (c == '\n');
+  }
+  return c;
+}
+
+void PgnReader::skipLine() {
+  int c;
+  while ((c = readChar()) >= 0 && c != '\n') {}
+}
+
+void PgnReader::skipComment() {
+  int c;
+  while ((c = readChar()) >= 0 && c != '}') {}
+}
+
+// 变着可以嵌套，其中的注释里可能有括号
+void PgnReader::skipVariation() {
+  int depth = 0;
+  int c;
+  while ((c = readChar()) >= 0) {
+    if (c == '(') {
+      depth++;
+    } else if (c == ')') {
+      if (--depth == 0) return;
+    } else if (c == '{') {
+      skipComment();
+    } else if (c == ';') {
+      skipLine();
+    }
+  }
+}
+
+// 解析 [Name "Value"]，只保留摘要需要的几个标签，超长的值在UTF-8字符边界截断
+bool PgnReader::readTag(PgnGameInfo& info) {
+  readChar();
+  char name[16];
+  size_t nameLen = 0;
+  int c;
+  while ((c = peekChar()) >= 0 && !isspace(c) && c != ']' && c != '"') {
+    if (nameLen + 1 < sizeof(name)) name[nameLen++] = (char)c;
+    readChar();
+  }
+  name[nameLen] = '\0';
+
+  char* value = nullptr;
+  size_t size = 0;
+  if (strcmp(name, "White") == 0) { value = info.white; size = sizeof(info.white); }
+  else if (strcmp(name, "Black") == 0) { value = info.black; size = sizeof(info.black); }
+  else if (strcmp(name, "Event") == 0) { value = info.event; size = sizeof(info.event); }
+  else if (strcmp(name, "Date") == 0) { value = info.date; size = sizeof(info.date); }
+  else if (strcmp(name, "Result") == 0) { value = info.result; size = sizeof(info.result); }
+  else if (strcmp(name, "FEN") == 0) { value = info.fen; size = sizeof(info.fen); }
+
+  while ((c = readChar()) >= 0 && c != '"' && c != ']' && c != '\n') {}
+  if (c != '"') {
+    return false;
+  }
+  size_t len = 0;
+  bool truncated = false;
+  while ((c = readChar()) >= 0 && c != '"' && c != '\n') {
+    if (c == '\\') c = readChar();
+    if (value == nullptr || c < 0) continue;
+    if (len + 1 < size) {
+      value[len++] = (char)c;
+    } else {
+      truncated = true;
+    }
+  }
+  if (value != nullptr) {
+    if (truncated) {
+      while (len > 0 && ((uint8_t)value[len - 1] & 0xC0) == 0x80) len--;
+      if (len > 0 && ((uint8_t)value[len - 1] & 0x80)) len--;
+    }
+    value[len] = '\0';
+  }
+  while (c >= 0 && c != ']' && c != '\n') c = readChar();
+  return true;
+}
+
+bool PgnReader::next(PgnGameInfo& info) {
+  if (file == nullptr) {
+    return false;
+  }
+  memset(&info, 0, sizeof(info));
+
+  // 标签区：跳过空白、注释和 % 转义行
+  bool started = false;
+  while (true) {
+    int c = peekChar();
+    if (c < 0) {
+      return false;
+    }
+    if (isspace(c)) {
+      readChar();
+    } else if (c == '%' && atLineStart) {
+      skipLine();
+    } else if (c == '[') {
+      if (!started && nextIndex % PGN_ANCHOR_INTERVAL == 0 && nextIndex / PGN_ANCHOR_INTERVAL == anchorCount &&
+          anchorCount < PGN_ANCHOR_COUNT) {
+        anchors[anchorCount++] = bufferStart + bufferPos;
+      }
+      started = true;
+      readTag(info);
+    } else {
+      break;
+    }
+  }
+  info.movesOffset = bufferStart + bufferPos;
+
+  // 走法区：直到下一局行首的 [ 或文件结束
+  while (true) {
+    int c = peekChar();
+    if (c < 0 || (c == '[' && atLineStart)) {
+      break;
+    }
+    if (c == '{') {
+      skipComment();
+    } else if (c == ';' || (c == '%' && atLineStart)) {
+      skipLine();
+    } else {
+      readChar();
+    }
+  }
+  if (info.result[0] == '\0') {
+    strcpy(info.result, "*");
+  }
+  nextIndex++;
+  return true;
+}
+
+int PgnReader::count() {
+  if (total < 0 && file != nullptr) {
+    rewind();
+    PgnGameInfo info;
+    while (next(info)) {}
+    total = nextIndex;
+    rewind();
+  }
+  return total < 0 ? 0 : total;
+}
+
+bool PgnReader::load(int index, PgnGameInfo& info) {
+  if (file == nullptr || index < 0) {
+    return false;
+  }
+  if (index < nextIndex) {
+    int anchor = index / PGN_ANCHOR_INTERVAL;
+    if (anchor >= anchorCount) anchor = anchorCount - 1;
+    if (anchor > 0) {
+      seekTo(anchors[anchor]);
+      nextIndex = anchor * PGN_ANCHOR_INTERVAL;
+    } else {
+      rewind();
+    }
+  }
+  while (nextIndex < index) {
+    if (!next(info)) return false;
+  }
+  return next(info);
+}
+
+// 读取下一个SAN走法，跳过回合号、注释、变着和NAG；遇到结果、下一局或文件结束返回0
+int PgnReader::readMoveToken(char* out, size_t size) {
+  while (true) {
+    int c = peekChar();
+    if (c < 0 || (c == '[' && atLineStart)) {
+      return 0;
+    }
+    if (isspace(c) || c == ')') {
+      readChar();
+      continue;
+    }
+    if (c == '{') {
+      skipComment();
+      continue;
+    }
+    if (c == ';' || (c == '%' && atLineStart)) {
+      skipLine();
+      continue;
+    }
+    if (c == '(') {
+      skipVariation();
+      continue;
+    }
+
+    size_t len = 0;
+    bool tooLong = false;
+    while ((c = peekChar()) >= 0 && !isspace(c) && strchr("{}();[", c) == nullptr) {
+      if (len + 1 < size) {
+        out[len++] = (char)c;
+      } else {
+        tooLong = true;
+      }
+      readChar();
+    }
+    out[len] = '\0';
+    if (tooLong || out[0] == '$') {
+      continue;
+    }
+    if (strcmp(out, "1-0") == 0 || strcmp(out, "0-1") == 0 || strcmp(out, "1/2-1/2") == 0 || strcmp(out, "*") == 0) {
+      return 0;
+    }
+
+    // 去掉回合号（“12.”、“12...”，可能与走法连写成“12.e4”）
+    char* p = out;
+    while (isdigit((uint8_t)*p)) p++;
+    if (*p == '.') {
+      while (*p == '.') p++;
+    } else {
+      p = out;
+    }
+    if (*p == '\0') {
+      continue;
+    }
+    memmove(out, p, strlen(p) + 1);
+    // 有的文件用数字0写易位
+    for (char* q = out; *q == '0' || *q == '-'; q++) {
+      if (*q == '0') *q = 'O';
+    }
+    return (int)strlen(out);
+  }
+}
+
+bool PgnReader::readMoves(const PgnGameInfo& info, ChessBoard& board, GameRecord& record) {
+  if (file == nullptr) {
+    return false;
+  }
+  if (info.fen[0] != '\0') {
+    if (!board.readFEN(info.fen)) return false;
+  } else {
+    board.initBoard();
+  }
+  record.reset(board);
+
+  // 解析完回到原来的位置，不打断 next() 的顺序读取
+  uint32_t resume = bufferStart + bufferPos;
+  bool resumeAtLineStart = atLineStart;
+  seekTo(info.movesOffset);
+  bool ok = true;
+  char token[16];
+  while (readMoveToken(token, sizeof(token)) > 0) {
+    SerialLogMute mute;
+    Move move;
+    if (!board.parseSAN(token, move) || !board.makeMove(move) || !record.push(move, board)) {
+      ok = false;
+      break;
+    }
+  }
+  seekTo(resume);
+  atLineStart = resumeAtLineStart;
+  return ok;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "block_file.h"
+#include "game_record.h"
+
+// PGN 对局文件（可含多局），导出与导入都只用固定大小的缓冲区，不把整个文件读进内存
+const int PGN_TAG_VALUE_SIZE = 40;
+const int PGN_LINE_WIDTH = 79;  // 走法文本换行宽度（PGN导出格式要求不超过80）
+const int PGN_ANCHOR_INTERVAL = 32;  // 读取器每隔多少局记一次文件偏移，往回翻时从最近的记录处开始
+const int PGN_ANCHOR_COUNT = 64;
+
+// 标准开局的FEN，局面不同时导出 SetUp/FEN 标签
+extern const char* const PGN_START_FEN;
+
+// 边下边写：标签区在对局开始时写好，每步只追加一个SAN，结束时原地改写 Result 标签
+//   Result 标签值后预留了空格，写入 "1/2-1/2" 也不会改变文件长度
+//   悔棋时把撤回部分覆盖为空格并回退写入位置（当前对局总在文件末尾，多出的空白不影响解析）
+class PgnWriter {
+private:
+  BlockFile* file;
+  uint32_t resultOffset;  // Result 标签值的起点
+  uint32_t movesStart;    // 走法文本的起点
+  uint32_t end;           // 当前写入位置
+  uint16_t plyOffset[GAME_RECORD_MAX_PLIES + 1];  // 每步文本相对 movesStart 的起点
+  uint8_t plyColumn[GAME_RECORD_MAX_PLIES + 1];   // 每步开始时所在的列
+  int ply;
+  int startPly;           // 起始局面是第几个半回合（黑先时为1），决定回合号
+  uint8_t column;
+  bool finished;
+
+  bool writeText(const char* text, size_t len);
+  bool writeToken(const char* token);
+  bool writeResultTag(const char* result);
+
+public:
+  PgnWriter() : file(nullptr), resultOffset(0), movesStart(0), end(0), ply(0), startPly(0), column(0), finished(false) {}
+
+  // 在文件末尾开始新的一局，white/black 为对局双方名称
+  bool begin(BlockFile* blockFile, const ChessBoard& start, const char* white, const char* black);
+  void close() { file = nullptr; }
+  bool isOpen() const { return file != nullptr; }
+
+  // 追加刚在 board 上走完的一步（SAN由走子前的局面生成），无棋可走时自动写入结果
+  bool appendMove(const Move& move, const ChessBoard& board);
+
+  // 撤回到本局第 ply 步之后；已结束的对局恢复为进行中
+  bool truncate(int ply);
+
+  // 写入结果（"1-0"、"0-1"、"1/2-1/2" 或 "*"），之后不再追加
+  bool finish(const char* result);
+
+  int getPly() const { return ply; }
+  bool isFinished() const { return finished; }
+};
+
+// 一局的标签摘要和走法文本位置
+struct PgnGameInfo {
+  char white[PGN_TAG_VALUE_SIZE];
+  char black[PGN_TAG_VALUE_SIZE];
+  char event[PGN_TAG_VALUE_SIZE];
+  char date[12];
+  char result[8];
+  char fen[FEN_BUFFER_SIZE];  // 空表示标准开局
+  uint32_t movesOffset;
+};
+
+// 多局PGN的流式读取器：next() 只解析标签并跳过走法，readMoves() 再回到走法位置逐步解析
+// 注释 {…}、行注释 ;、变着 (…)、NAG $n 和 % 开头的行都被跳过
+class PgnReader {
+private:
+  BlockFile* file;
+  uint8_t buffer[64];
+  uint32_t bufferStart;  // 缓冲区第一个字节在文件中的偏移
+  uint8_t bufferPos;
+  uint8_t bufferLen;
+  bool atLineStart;
+  int nextIndex;
+  int total;
+  uint32_t anchors[PGN_ANCHOR_COUNT];  // 第 i*PGN_ANCHOR_INTERVAL 局的起点
+  int anchorCount;
+
+  void seekTo(uint32_t offset);
+  int peekChar();
+  int readChar();
+  void skipLine();
+  void skipComment();
+  void skipVariation();
+  bool readTag(PgnGameInfo& info);
+  int readMoveToken(char* out, size_t size);
+
+public:
+  PgnReader() : file(nullptr), bufferStart(0), bufferPos(0), bufferLen(0), atLineStart(true), nextIndex(0), total(-1), anchorCount(0) {}
+
+  bool open(BlockFile* blockFile);
+  void close() { file = nullptr; total = -1; anchorCount = 0; }
+  bool isOpen() const { return file != nullptr; }
+  void rewind();
+
+  // 顺序读取下一局的标签
+  bool next(PgnGameInfo& info);
+
+  // 对局总数，第一次调用时扫描整个文件
+  int count();
+
+  // 按序号读取标签：向后时从当前位置继续，向前时从最近的记录偏移开始
+  bool load(int index, PgnGameInfo& info);
+
+  // 把 info 对应的对局载入 board 和 record（board 停在最后一步之后）；
+  // 遇到非法走法时停在那里并返回false
+  bool readMoves(const PgnGameInfo& info, ChessBoard& board, GameRecord& record);
+};
@@ -0,0 +1,64 @@
+#include "power_governor.h"
+
+IdleGovernor::IdleGovernor(int activeHz, int idleHz, uint32_t sleepAfterMs)
+    : activePeriod(1000000 / activeHz), idlePeriod(1000000 / idleHz), sleepAfter(sleepAfterMs),
+      loopStart(0), restStart(0), restState(POWER_ACTIVE), resting(false), lastActive(0) {
+  resetStats();
+}
+
+void IdleGovernor::beginLoop(uint32_t nowMicros) {
+  if (resting) {
+    stats[restState].restMicros += (uint32_t)(nowMicros - restStart);
+    resting = false;
+  }
+  loopStart = nowMicros;
+}
+
+PowerState IdleGovernor::endLoop(uint32_t nowMicros, uint32_t nowMillis, bool active, bool canSleep,
+                                 uint32_t& restMicros) {
+  PowerState state = POWER_ACTIVE;
+  if (active) {
+    lastActive = nowMillis;
+  } else if (canSleep && (uint32_t)(nowMillis - lastActive) >= sleepAfter) {
+    state = POWER_SLEEP;
+  } else {
+    state = POWER_IDLE;
+  }
+
+  // 用差值计算，micros()/millis() 回绕时也成立
+  uint32_t worked = nowMicros - loopStart;
+  uint32_t period = state == POWER_ACTIVE ? activePeriod : idlePeriod;
+  restMicros = worked < period ? period - worked : 0;
+
+  stats[state].awakeMicros += worked;
+  stats[state].loops++;
+  restState = state;
+  restStart = nowMicros;
+  resting = true;
+  return state;
+}
+
+uint32_t IdleGovernor::getDutyPermille(PowerState state) const {
+  uint64_t total = stats[state].awakeMicros + stats[state].restMicros;
+  if (total == 0) {
+    return 0;
+  }
+  return (uint32_t)(stats[state].awakeMicros * 1000 / total);
+}
+
+void IdleGovernor::resetStats() {
+  for (int i = 0; i < POWER_STATE_COUNT; i++) {
+    stats[i].awakeMicros = 0;
+    stats[i].restMicros = 0;
+    stats[i].loops = 0;
+  }
+}
+
+const char* IdleGovernor::stateName(PowerState state) {
+  switch (state) {
+    case POWER_ACTIVE: return "active";
+    case POWER_IDLE: return "idle";
+    case POWER_SLEEP: return "sleep";
+    default: return "?";
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+
+// 空闲调速：限制 loop() 的频率，没事可做时在两次键盘扫描之间休息，省电池
+//   有动画、后台AI搜索、推屏传输或SD写入时按 ACTIVE_LOOP_HZ 运行，只用 delay() 让出CPU；
+//   空闲时降到 IDLE_LOOP_HZ；空闲超过 LIGHT_SLEEP_AFTER_MS 后在两次扫描之间进入 light sleep
+//   light sleep 时 LEDC 停止，背光会熄灭或闪烁，所以同时熄屏（按任意键亮屏）；时间取长一些，思考时不会黑屏
+//   每种状态分别累计工作时间和休息时间，占空比（工作时间占比）可以对照实测电流
+const int ACTIVE_LOOP_HZ = 100;
+// 空闲时 25ms 扫描一次键盘：要短于按键防抖时间（30ms），否则比扫描周期短的轻按会漏掉
+const int IDLE_LOOP_HZ = 40;
+const uint32_t LIGHT_SLEEP_AFTER_MS = 30000;
+
+enum PowerState {
+  POWER_ACTIVE,  // 有活动：按帧率运行
+  POWER_IDLE,    // 刚空闲：delay() 休息
+  POWER_SLEEP,   // 空闲已久：light sleep 休息
+  POWER_STATE_COUNT
+};
+
+struct PowerStateStats {
+  uint64_t awakeMicros;  // loop() 工作的时间
+  uint64_t restMicros;   // loop() 之间休息的时间
+  uint32_t loops;
+};
+
+class IdleGovernor {
+private:
+  uint32_t activePeriod;  // 每轮 loop() 的周期（微秒）
+  uint32_t idlePeriod;
+  uint32_t sleepAfter;    // 毫秒
+  uint32_t loopStart;     // 本轮开始的时刻（微秒）
+  uint32_t restStart;     // 上一轮结束、开始休息的时刻（微秒）
+  PowerState restState;   // 上一轮结束时选定的状态
+  bool resting;
+  uint32_t lastActive;    // 最后一次有活动的时刻（毫秒）
+  PowerStateStats stats[POWER_STATE_COUNT];
+
+public:
+  IdleGovernor(int activeHz = ACTIVE_LOOP_HZ, int idleHz = IDLE_LOOP_HZ, uint32_t sleepAfterMs = LIGHT_SLEEP_AFTER_MS);
+
+  // loop() 开头调用，把上一轮之后的休息时间记到上一轮的状态上
+  void beginLoop(uint32_t nowMicros);
+
+  // loop() 的工作做完后调用：active 表示这一轮有按键或仍有活动在进行，
+  // canSleep 表示此刻允许 light sleep（如没有连着USB串口）
+  // 返回这一轮之后的状态，restMicros 为距下一轮开始还要休息的时间（已超时则为0）
+  PowerState endLoop(uint32_t nowMicros, uint32_t nowMillis, bool active, bool canSleep, uint32_t& restMicros);
+
+  const PowerStateStats& getStats(PowerState state) const { return stats[state]; }
+  // 该状态下的工作时间占比（千分比），没有数据时为0
+  uint32_t getDutyPermille(PowerState state) const;
+  void resetStats();
+
+  static const char* stateName(PowerState state);
+};
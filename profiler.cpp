@@ -0,0 +1,80 @@
+#include "profiler.h"
+#include "common.h"
+
+#include <atomic>
+
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+ProfileZoneStats profilerZones[PROFILER_TASKS][PROF_ZONE_COUNT];
+
+ProfileZoneStats* profilerTaskZones() {
+  static std::atomic<int> nextTask(0);
+  static thread_local ProfileZoneStats* zones = nullptr;
+  if (zones == nullptr) {
+    int task = nextTask.fetch_add(1);
+    zones = profilerZones[task < PROFILER_TASKS ? task : PROFILER_TASKS - 1];
+  }
+  return zones;
+}
+
+// 区段名称，顺序与 ProfileZoneId 一致
+static const char* const ZONE_NAMES[PROF_ZONE_COUNT] = {
+  "isMoveValid",
+  "isKingInCheck",
+  "movePiece",
+  "evaluateBoard",
+  "drawBoard",
+  "pushSprite"
+};
+
+// 每微秒的计时单位数，用于把周期换算成时间
+static double ticksPerMicrosecond() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return getCpuFrequencyMhz();
+#elif defined(__x86_64__) || defined(__i386__)
+  // rdtsc频率未知，用steady_clock校准一次
+  static double cached = 0;
+  if (cached == 0) {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    profile_ticks_t c0 = profilerNow();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(10)) {
+    }
+    profile_ticks_t c1 = profilerNow();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    cached = (c1 - c0) / us;
+  }
+  return cached;
+#else
+  return 1000.0; // 纳秒
+#endif
+}
+
+void profilerReset() {
+  for (int task = 0; task < PROFILER_TASKS; task++) {
+    for (int i = 0; i < PROF_ZONE_COUNT; i++) {
+      profilerZones[task][i].calls = 0;
+      profilerZones[task][i].cycles = 0;
+      // depth 不清零：可能在区段内部被调用
+    }
+  }
+}
+
+void profilerDump() {
+  double tpu = ticksPerMicrosecond();
+  serialPrintf("[PROF] %-14s %10s %14s %10s %12s\n", "zone", "calls", "cycles", "cyc/call", "total_us");
+  for (int i = 0; i < PROF_ZONE_COUNT; i++) {
+    ProfileZoneStats z = {0, 0, 0};
+    for (int task = 0; task < PROFILER_TASKS; task++) {
+      z.calls += profilerZones[task][i].calls;
+      z.cycles += profilerZones[task][i].cycles;
+    }
+    unsigned long perCall = z.calls ? (unsigned long)(z.cycles / z.calls) : 0;
+    serialPrintf("[PROF] %-14s %10lu %14llu %10lu %12.0f\n", ZONE_NAMES[i],
+                 (unsigned long)z.calls, (unsigned long long)z.cycles, perCall, z.cycles / tpu);
+  }
+#if !ENABLE_PROFILER
+  serialPrintln("[PROF] profiler disabled at compile time (ENABLE_PROFILER=0)");
+#endif
+}
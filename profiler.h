@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+
+// 性能分析开关：编译时加 -DENABLE_PROFILER=0 可完全去除计时代码
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 1
+#endif
+
+#if !defined(ARDUINO_ARCH_ESP32) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+// 性能分析区段（固定表，新增区段时同步修改 profiler.cpp 中的名称表）
+enum ProfileZoneId {
+  PROF_IS_MOVE_VALID,
+  PROF_IS_KING_IN_CHECK,
+  PROF_MOVE_PIECE,
+  PROF_EVALUATE_BOARD,
+  PROF_DRAW_BOARD,
+  PROF_PUSH_SPRITE,
+  PROF_ZONE_COUNT
+};
+
+// 单个区段的累计数据
+struct ProfileZoneStats {
+  uint32_t calls;    // 调用次数
+  uint64_t cycles;   // 包含子调用的周期数（递归调用只计最外层）
+  uint32_t depth;    // 当前嵌套深度
+};
+
+// 计时单位：设备上是CPU周期计数器（32位，会回绕，只取差值），主机上是rdtsc或纳秒
+#if defined(ARDUINO_ARCH_ESP32)
+typedef uint32_t profile_ticks_t;
+inline profile_ticks_t profilerNow() { return ESP.getCycleCount(); }
+#elif defined(__x86_64__) || defined(__i386__)
+typedef uint64_t profile_ticks_t;
+inline profile_ticks_t profilerNow() { return __rdtsc(); }
+#else
+typedef uint64_t profile_ticks_t;
+inline profile_ticks_t profilerNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// 每个任务（UI循环、后台AI搜索……）各用一组区段，嵌套深度和累计值互不干扰；
+// 任务第一次计时时领取一组，超过 PROFILER_TASKS 个任务时共用最后一组
+const int PROFILER_TASKS = 4;
+extern ProfileZoneStats profilerZones[PROFILER_TASKS][PROF_ZONE_COUNT];
+
+// 当前任务的区段表
+ProfileZoneStats* profilerTaskZones();
+
+// 作用域计时器：构造时开始，析构时累加
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileZoneId id) : zone(profilerTaskZones()[id]), start(0) {
+    if (zone.depth++ == 0) {
+      start = profilerNow();
+    }
+  }
+  ~ProfileScope() {
+    zone.calls++;
+    if (--zone.depth == 0) {
+      zone.cycles += (profile_ticks_t)(profilerNow() - start);
+    }
+  }
+
+private:
+  ProfileZoneStats& zone;
+  profile_ticks_t start;
+};
+
+#if ENABLE_PROFILER
+#define PROFILE_ZONE(id) ProfileScope profileScope_##id(id)
+#else
+#define PROFILE_ZONE(id) do {} while (0)
+#endif
+
+// 清零所有任务的区段
+void profilerReset();
+
+// 通过串口输出统计表（各任务的计数相加）
+void profilerDump();
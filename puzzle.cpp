@@ -1,121 +1,59 @@
 #include "puzzle.h"
 #include "puzzle_data.h"
-#include "common.h"
 
-// PuzzleData 辅助函数：从FEN字符串中提取当前玩家
-Color PuzzleData::getSideToMoveFromFEN(const String& fen) {
-  int index = 0;
-  // 跳过棋盘布局部分
-  while (index < fen.length() && fen[index] != ' ') {
-    index++;
-  }
-  // 跳过空格
-  while (index < fen.length() && fen[index] == ' ') {
-    index++;
-  }
-  // 解析当前玩家
-  return (index < fen.length() && fen[index] == 'w') ? WHITE : BLACK;
+uint16_t packMove(const Move& move) {
+  return (uint16_t)((move.from.y * 8 + move.from.x) |
+                    ((move.to.y * 8 + move.to.x) << 6) |
+                    (move.promotion << 12));
 }
 
-// PuzzleData 构造函数：使用PGN字符串（自动从FEN中提取当前玩家）
-PuzzleData::PuzzleData(const String& fen, const String& pgnMoves) {
-  this->fen = fen;
-  this->sideToMove = getSideToMoveFromFEN(fen);
-  
-  // 创建临时棋盘来解析PGN移动
-  ChessBoard tempBoard;
-  tempBoard.fromFEN(fen);
-  
-  // 解析PGN移动
-  String cleanPGN = pgnMoves;
-  cleanPGN.trim();
-  
-  int currentIndex = 0;
-  while (currentIndex < cleanPGN.length()) {
-    // 跳过空格
-    while (currentIndex < cleanPGN.length() && (cleanPGN[currentIndex] == ' ' || cleanPGN[currentIndex] == '\t' || cleanPGN[currentIndex] == '\n')) {
-      currentIndex++;
-    }
-    
-    if (currentIndex >= cleanPGN.length()) break;
-    
-    // 解析单个移动
-    int moveStart = currentIndex;
-    while (currentIndex < cleanPGN.length() && cleanPGN[currentIndex] != ' ' && cleanPGN[currentIndex] != '\t' && cleanPGN[currentIndex] != '\n') {
-      currentIndex++;
-    }
-    
-    String pgnMove = cleanPGN.substring(moveStart, currentIndex);
-    Move move = tempBoard.parsePGN(pgnMove);
-    
-    if (move.from.isValid() && move.to.isValid()) {
-      mainLine.push_back(move);
-      // 执行移动以便下一个移动可以基于当前位置解析
-      tempBoard.movePiece(move.from, move.to);
-    }
-  }
+Move unpackMove(uint16_t packed) {
+  int from = packed & 0x3F;
+  int to = (packed >> 6) & 0x3F;
+  return Move(Position(from % 8, from / 8), Position(to % 8, to / 8), (PieceType)(packed >> 12));
 }
 
-// PuzzleData 构造函数：使用PGN字符串（兼容旧版，允许手动指定当前玩家）
-PuzzleData::PuzzleData(const String& fen, Color sideToMove, const String& pgnMoves) {
-  this->fen = fen;
-  this->sideToMove = sideToMove;
-  
-  // 创建临时棋盘来解析PGN移动
-  ChessBoard tempBoard;
-  tempBoard.fromFEN(fen);
-  
-  // 设置当前玩家
-  if (tempBoard.getCurrentPlayer() != sideToMove) {
-    tempBoard.switchPlayer();
+void packPosition(const ChessBoard& board, uint8_t* out) {
+  memset(out, 0, PUZZLE_POSITION_BYTES);
+  for (int sq = 0; sq < 64; sq++) {
+    const Piece& piece = board.getPiece(sq % 8, sq / 8);
+    uint8_t code = piece.isEmpty() ? 0 : (uint8_t)(piece.type | (piece.color == BLACK ? 8 : 0));
+    out[sq / 2] |= (sq & 1) ? (code << 4) : code;
   }
-  
-  // 解析PGN移动
-  String cleanPGN = pgnMoves;
-  cleanPGN.trim();
-  
-  int currentIndex = 0;
-  while (currentIndex < cleanPGN.length()) {
-    // 跳过空格
-    while (currentIndex < cleanPGN.length() && (cleanPGN[currentIndex] == ' ' || cleanPGN[currentIndex] == '\t' || cleanPGN[currentIndex] == '\n')) {
-      currentIndex++;
-    }
-    
-    if (currentIndex >= cleanPGN.length()) break;
-    
-    // 解析单个移动
-    int moveStart = currentIndex;
-    while (currentIndex < cleanPGN.length() && cleanPGN[currentIndex] != ' ' && cleanPGN[currentIndex] != '\t' && cleanPGN[currentIndex] != '\n') {
-      currentIndex++;
-    }
-    
-    String pgnMove = cleanPGN.substring(moveStart, currentIndex);
-    Move move = tempBoard.parsePGN(pgnMove);
-    
-    if (move.from.isValid() && move.to.isValid()) {
-      mainLine.push_back(move);
-      // 执行移动以便下一个移动可以基于当前位置解析
-      tempBoard.movePiece(move.from, move.to);
-    }
+  out[32] = (board.getCurrentPlayer() == BLACK ? 1 : 0) | (board.getCastlingRights() << 4);
+  Position ep = board.getEnPassantTarget();
+  out[33] = ep.isValid() ? (uint8_t)(ep.y * 8 + ep.x) : 0xFF;
+}
+
+bool unpackPosition(const uint8_t* packed, ChessBoard& board, uint16_t halfmove, uint16_t fullmove) {
+  Piece squares[8][8];
+  for (int sq = 0; sq < 64; sq++) {
+    uint8_t code = (sq & 1) ? (packed[sq / 2] >> 4) : (packed[sq / 2] & 0x0F);
+    PieceType type = (PieceType)(code & 7);
+    if (type > KING) return false;
+    squares[sq % 8][sq / 8] = Piece(type, (code & 8) ? BLACK : WHITE);
   }
+  Position ep = packed[33] < 64 ? Position(packed[33] % 8, packed[33] / 8) : Position(-1, -1);
+  board.setPosition(squares, (packed[32] & 1) ? BLACK : WHITE, packed[32] >> 4, ep, halfmove, fullmove);
+  return true;
 }
 
-// PuzzleData 构造函数：使用预定义的Move列表
-PuzzleData::PuzzleData(const String& fen, Color sideToMove, const std::vector<Move>& mainLine) {
-  this->fen = fen;
-  this->sideToMove = sideToMove;
-  this->mainLine = mainLine;
+int Puzzle::count() {
+  return BUILTIN_PUZZLE_COUNT;
 }
 
-// 从谜题数据加载谜题
-std::vector<Puzzle> Puzzle::loadPuzzles(const String& filePath) {
-  std::vector<Puzzle> puzzles;
-  
-  // 从puzzle_data.h加载所有谜题
-  for (const auto& puzzleData : PUZZLES_DATA) {
-    Puzzle puzzle(puzzleData.fen, puzzleData.sideToMove, puzzleData.mainLine);
-    puzzles.push_back(puzzle);
+bool Puzzle::load(int index, Puzzle& out) {
+  if (index < 0 || index >= BUILTIN_PUZZLE_COUNT) {
+    return false;
+  }
+  for (int i = 0; i < PUZZLE_POSITION_BYTES; i++) {
+    out.position[i] = pgm_read_byte(&BUILTIN_PUZZLE_POSITIONS[index][i]);
+  }
+  int start = pgm_read_word(&BUILTIN_PUZZLE_MOVE_START[index]);
+  int end = pgm_read_word(&BUILTIN_PUZZLE_MOVE_START[index + 1]);
+  out.moveCount = (uint8_t)(end - start);
+  for (int i = 0; i < out.moveCount; i++) {
+    out.moves[i] = pgm_read_word(&BUILTIN_PUZZLE_MOVES[start + i]);
   }
-  
-  return puzzles;
+  return true;
 }
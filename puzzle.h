@@ -1,41 +1,65 @@
 #pragma once
 #include "common.h"
-#include <vector>
-#include <String.h>
 
-// 谜题结构体
+// 打包局面：64格各4位（低位为偶数格，格序号 y*8+x），
+// 第32字节：bit0 走棋方（1=黑），bit4-7 易位权（CASTLE_*）；第33字节：吃过路兵格序号，无则0xFF
+const int PUZZLE_POSITION_BYTES = 34;
+
+// 单个谜题正解的最大步数
+const int PUZZLE_MAX_MOVES = 32;
+
+// 16位打包走法：bit0-5 起点格，bit6-11 终点格，bit12-15 升变棋子（PieceType，无则0）
+uint16_t packMove(const Move& move);
+Move unpackMove(uint16_t packed);
+
+void packPosition(const ChessBoard& board, uint8_t* out);
+bool unpackPosition(const uint8_t* packed, ChessBoard& board, uint16_t halfmove = 0, uint16_t fullmove = 1);
+
+// 谜题：固定大小，不占用堆内存；数据在编译期由 tools/puzzle_gen 生成到 puzzle_data.h
 class Puzzle {
 private:
-  String fen;              // 初始局面FEN
-  Color sideToMove;        // 轮到哪一方走棋
-  std::vector<Move> mainLine; // 正解走法序列
+  uint8_t position[PUZZLE_POSITION_BYTES]; // 初始局面
+  uint8_t moveCount;
+  uint16_t moves[PUZZLE_MAX_MOVES];        // 正解走法序列
+  uint16_t rating;                         // 难度等级分，内置谜题为0
+  
+  friend class PuzzlePack;
   
 public:
-  Puzzle() : sideToMove(Color::WHITE) {}
-  Puzzle(const String& fen, Color sideToMove, const std::vector<Move>& mainLine)
-    : fen(fen), sideToMove(sideToMove), mainLine(mainLine) {}
+  Puzzle() : moveCount(0), rating(0) { memset(position, 0, sizeof(position)); }
   
-  // 获取FEN字符串
-  String getFEN() const { return fen; }
+  // 把初始局面加载到棋盘
+  bool applyTo(ChessBoard& board) const { return unpackPosition(position, board); }
   
   // 获取走棋方
-  Color getSideToMove() const { return sideToMove; }
-  
-  // 获取正解走法序列
-  const std::vector<Move>& getMainLine() const { return mainLine; }
-  
-  // 从文件加载谜题
-  static std::vector<Puzzle> loadPuzzles(const String& filePath);
-  
-  // 复制赋值运算符
-  Puzzle& operator=(const Puzzle& other) {
-    if (this != &other) {
-      fen = other.fen;
-      sideToMove = other.sideToMove;
-      mainLine = other.mainLine;
-    }
-    return *this;
+  Color getSideToMove() const { return (position[32] & 1) ? BLACK : WHITE; }
+  
+  // 获取正解走法
+  int getMoveCount() const { return moveCount; }
+  Move getMove(int index) const { return unpackMove(moves[index]); }
+  
+  uint16_t getRating() const { return rating; }
+  
+  // 从棋盘局面开始构造谜题，再逐步追加正解
+  void reset(const ChessBoard& board) {
+    packPosition(board, position);
+    moveCount = 0;
+    rating = 0;
+  }
+  bool addMove(const Move& move) {
+    if (moveCount >= PUZZLE_MAX_MOVES) return false;
+    moves[moveCount++] = packMove(move);
+    return true;
   }
+  void truncateMoves(int count) {
+    if (count < moveCount) moveCount = (uint8_t)count;
+  }
+  
+  // 打包形式的数据，用于写入谜题包
+  const uint8_t* getPackedPosition() const { return position; }
+  uint16_t getPackedMove(int index) const { return moves[index]; }
+  
+  // 内置谜题数量，以及按序号从flash读取
+  static int count();
+  static bool load(int index, Puzzle& out);
 };
-
-
@@ -1,38 +1,29 @@
-#ifndef PUZZLE_DATA_H
-#define PUZZLE_DATA_H
+// 由 tools/puzzle_gen 根据 tools/puzzle_source.txt 生成，不要手工修改
+// 重新生成：构建 CMake 的 puzzle_data 目标
+#pragma once
+#include <Arduino.h>
 
-#include "common.h"
-#include <vector>
-#include <string>
+const int BUILTIN_PUZZLE_COUNT = 2;
 
-// 谜题数据结构体
-struct PuzzleData {
-  String fen;
-  Color sideToMove;
-  std::vector<Move> mainLine;
-  
-  // 构造函数声明
-  PuzzleData(const String& fen, const String& pgnMoves);
-  PuzzleData(const String& fen, Color sideToMove, const String& pgnMoves);
-  PuzzleData(const String& fen, Color sideToMove, const std::vector<Move>& mainLine);
-  
-  // 辅助函数声明
-  static Color getSideToMoveFromFEN(const String& fen);
+// 打包局面（格式见 puzzle.h）
+static const uint8_t BUILTIN_PUZZLE_POSITIONS[2][34] PROGMEM = {
+  // 谜题1：经典转向（黑先）
+  // 3r2k1/p4ppp/1q6/8/8/2R1P3/P3QPPP/6K1 b - - 0 1
+  {0x00, 0x00, 0x00, 0x06, 0x01, 0x00, 0x15, 0x11, 0x00, 0x04, 0x01, 0x00,
+   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD0, 0x00, 0x00, 0x00,
+   0x09, 0x00, 0x90, 0x99, 0x00, 0xC0, 0x00, 0x0E, 0x01, 0xFF},
+  // 谜题3：占线和刺入（白先）
+  // 1n1q1rk1/1Nb2ppb/pp4p1/3p4/3Pn3/BP1BPN2/P3QPPP/2R3K1 w - - 0 1
+  {0x00, 0x04, 0x00, 0x06, 0x01, 0x00, 0x15, 0x11, 0x13, 0x30, 0x21, 0x00,
+   0x00, 0x10, 0x0A, 0x00, 0x00, 0x90, 0x00, 0x00, 0x99, 0x00, 0x00, 0x09,
+   0x20, 0x0B, 0x90, 0xB9, 0xA0, 0xD0, 0xC0, 0x0E, 0x00, 0xFF},
 };
 
-// 所有谜题数据
-const std::vector<PuzzleData> PUZZLES_DATA = {
-  // 谜题1：经典转向（黑先）- 使用PGN格式
-  PuzzleData("3r2k1/p4ppp/1q6/8/8/2R1P3/P3QPPP/6K1 b - - 0 1", 
-             "Qb2 Rc8 Qb1+ Qf1 Qxf1+ Kxf1 Rxc8"),
-  
-  // 谜题2：进入兵残局（白先）- 使用PGN格式
-  PuzzleData("8/1p2kp1p/p3pn2/2r5/8/P1N5/1PP3PP/5RK1 w - - 0 1", 
-             "c4 bxc4 c3 a5 a4 Kd5 g5 hxg5 hxg5 e5 g6 Ke6 g7 Kf7 Ke4 Kxg7 Kxe5 Kf7 Kd5"),
-  
-  // 谜题3：占线和刺入（白先）- 使用PGN格式
-  PuzzleData("1n1q1rk1/1Nb2ppb1/pp4p1/3p4/3Pn3/BP1BPN2/P3QPPP/2R3K1 w - - 0 1", 
-             "Qc2 Qd7 Qc7 Ba8 Nc8 Bf6 Qxb8 Bc6 Bxa6")
+// 所有谜题的正解走法（16位打包，格式见 puzzle.h）
+static const uint16_t BUILTIN_PUZZLE_MOVES[] PROGMEM = {
+  0x0269, 0x0E92, 0x0049, 0x014C, 0x0141, 0x0146, 0x0EBB,
+  0x028C, 0x0CFB, 0x0C8A,
 };
 
-#endif // PUZZLE_DATA_H
\ No newline at end of file
+// 第i个谜题的走法为 BUILTIN_PUZZLE_MOVES[START[i], START[i+1])
+static const uint16_t BUILTIN_PUZZLE_MOVE_START[3] PROGMEM = {0, 7, 10};
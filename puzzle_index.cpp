@@ -0,0 +1,110 @@
+#include "puzzle_index.h"
+#include "common.h"
+
+static const char* const PUZZLE_THEME_NAMES[PUZZLE_THEME_COUNT] = {
+  "all", "mateIn1", "mateIn2", "mateIn3", "mate", "fork", "pin", "skewer",
+  "discoveredAttack", "hangingPiece", "sacrifice", "promotion", "backRankMate",
+  "endgame", "middlegame", "opening",
+};
+
+const char* puzzleThemeName(int theme) {
+  return (theme >= 0 && theme < PUZZLE_THEME_COUNT) ? PUZZLE_THEME_NAMES[theme] : nullptr;
+}
+
+int puzzleThemeFromName(const char* name) {
+  for (int i = 0; i < PUZZLE_THEME_COUNT; i++) {
+    if (strcmp(name, PUZZLE_THEME_NAMES[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+size_t encodePuzzleIndexHeader(uint32_t count, uint8_t* out) {
+  memset(out, 0, PUZZLE_INDEX_HEADER_SIZE);
+  memcpy(out, PUZZLE_INDEX_MAGIC, 4);
+  writeLE16(out + 4, PUZZLE_INDEX_VERSION);
+  writeLE32(out + 8, count);
+  return PUZZLE_INDEX_HEADER_SIZE;
+}
+
+size_t encodePuzzleIndexEntry(uint8_t theme, uint16_t rating, uint32_t puzzle, uint8_t* out) {
+  out[0] = theme;
+  out[1] = 0;
+  writeLE16(out + 2, rating);
+  writeLE32(out + 4, puzzle);
+  return PUZZLE_INDEX_ENTRY_SIZE;
+}
+
+bool PuzzleIndex::open(BlockFile* blockFile) {
+  close();
+  uint8_t header[PUZZLE_INDEX_HEADER_SIZE];
+  if (!blockFile->readAt(0, header, sizeof(header))) {
+    serialPrintln("[PUZZLE] Index header unreadable");
+    return false;
+  }
+  if (memcmp(header, PUZZLE_INDEX_MAGIC, 4) != 0 || readLE16(header + 4) != PUZZLE_INDEX_VERSION) {
+    serialPrintln("[PUZZLE] Not a puzzle index or unsupported version");
+    return false;
+  }
+  uint32_t entries = readLE32(header + 8);
+  if (entries > (blockFile->size() - PUZZLE_INDEX_HEADER_SIZE) / PUZZLE_INDEX_ENTRY_SIZE) {
+    serialPrintln("[PUZZLE] Index truncated");
+    return false;
+  }
+  file = blockFile;
+  count = entries;
+  serialPrintf("[PUZZLE] Index opened: %u entries\n", (unsigned)count);
+  return true;
+}
+
+bool PuzzleIndex::readEntry(uint32_t position, uint32_t& key, uint32_t& puzzle) {
+  uint8_t entry[PUZZLE_INDEX_ENTRY_SIZE];
+  if (!file->readAt(PUZZLE_INDEX_HEADER_SIZE + position * PUZZLE_INDEX_ENTRY_SIZE, entry, sizeof(entry))) {
+    return false;
+  }
+  key = puzzleIndexKey(entry[0], readLE16(entry + 2));
+  puzzle = readLE32(entry + 4);
+  return true;
+}
+
+uint32_t PuzzleIndex::lowerBound(uint32_t key) {
+  uint32_t low = 0;
+  uint32_t high = count;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    uint32_t midKey;
+    uint32_t puzzle;
+    if (!readEntry(mid, midKey, puzzle)) {
+      return count; // 读取失败按空范围处理
+    }
+    if (midKey < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+uint32_t PuzzleIndex::countInBand(uint8_t theme, uint16_t minRating, uint16_t maxRating) {
+  if (file == nullptr || minRating > maxRating) {
+    return 0;
+  }
+  uint32_t first = lowerBound(puzzleIndexKey(theme, minRating));
+  uint32_t last = lowerBound(puzzleIndexKey(theme, maxRating) + 1);
+  return last > first ? last - first : 0;
+}
+
+bool PuzzleIndex::pickRandom(uint8_t theme, uint16_t minRating, uint16_t maxRating, uint32_t& puzzle) {
+  if (file == nullptr || minRating > maxRating) {
+    return false;
+  }
+  uint32_t first = lowerBound(puzzleIndexKey(theme, minRating));
+  uint32_t last = lowerBound(puzzleIndexKey(theme, maxRating) + 1);
+  if (last <= first) {
+    return false;
+  }
+  uint32_t key;
+  return readEntry(first + (uint32_t)random(0, (long)(last - first)), key, puzzle);
+}
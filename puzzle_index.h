@@ -0,0 +1,71 @@
+#pragma once
+#include "block_file.h"
+
+// 谜题二级索引：按（主题, 等级分）排序的条目，指向谜题包中的谜题序号，
+// 与谜题包一起由 tools/lichess_pack 生成（所有整数均为小端）
+//   文件头（16字节）：魔数 "CCPI"，uint16 版本，uint16 保留，uint32 条目数，uint32 保留
+//   条目（8字节）：uint8 主题，uint8 保留，uint16 等级分，uint32 谜题序号
+// 每个谜题在 PUZZLE_THEME_ALL 下有一条，另外在它的每个已知主题下各有一条
+const uint8_t PUZZLE_INDEX_MAGIC[4] = {'C', 'C', 'P', 'I'};
+const uint16_t PUZZLE_INDEX_VERSION = 1;
+const int PUZZLE_INDEX_HEADER_SIZE = 16;
+const int PUZZLE_INDEX_ENTRY_SIZE = 8;
+
+// 主题编号，与 Lichess 主题名一一对应；编号写入索引文件，只能在末尾追加
+enum PuzzleTheme {
+  PUZZLE_THEME_ALL = 0,
+  PUZZLE_THEME_MATE_IN_1,
+  PUZZLE_THEME_MATE_IN_2,
+  PUZZLE_THEME_MATE_IN_3,
+  PUZZLE_THEME_MATE,
+  PUZZLE_THEME_FORK,
+  PUZZLE_THEME_PIN,
+  PUZZLE_THEME_SKEWER,
+  PUZZLE_THEME_DISCOVERED_ATTACK,
+  PUZZLE_THEME_HANGING_PIECE,
+  PUZZLE_THEME_SACRIFICE,
+  PUZZLE_THEME_PROMOTION,
+  PUZZLE_THEME_BACK_RANK_MATE,
+  PUZZLE_THEME_ENDGAME,
+  PUZZLE_THEME_MIDDLEGAME,
+  PUZZLE_THEME_OPENING,
+  PUZZLE_THEME_COUNT
+};
+
+// 主题编号 -> 主题名（Lichess 拼写），编号超出范围返回 nullptr
+const char* puzzleThemeName(int theme);
+// 主题名 -> 主题编号，未知主题返回 -1
+int puzzleThemeFromName(const char* name);
+
+// 索引条目的排序键：主题在高16位，等级分在低16位
+inline uint32_t puzzleIndexKey(uint8_t theme, uint16_t rating) {
+  return ((uint32_t)theme << 16) | rating;
+}
+
+// 写入文件头与单个条目，返回字节数（主机端生成索引用）
+size_t encodePuzzleIndexHeader(uint32_t count, uint8_t* out);
+size_t encodePuzzleIndexEntry(uint8_t theme, uint16_t rating, uint32_t puzzle, uint8_t* out);
+
+class PuzzleIndex {
+private:
+  BlockFile* file;
+  uint32_t count;
+
+  bool readEntry(uint32_t position, uint32_t& key, uint32_t& puzzle);
+
+  // 第一个排序键不小于 key 的条目位置，二分查找，O(log n) 次读取
+  uint32_t lowerBound(uint32_t key);
+
+public:
+  PuzzleIndex() : file(nullptr), count(0) {}
+
+  bool open(BlockFile* blockFile);
+  void close() { file = nullptr; count = 0; }
+  bool isOpen() const { return file != nullptr; }
+
+  // 指定主题、等级分在 [minRating, maxRating] 内的谜题数量
+  uint32_t countInBand(uint8_t theme, uint16_t minRating, uint16_t maxRating);
+
+  // 在范围内随机挑一个谜题，返回它在谜题包中的序号
+  bool pickRandom(uint8_t theme, uint16_t minRating, uint16_t maxRating, uint32_t& puzzle);
+};
@@ -0,0 +1,87 @@
+#include "puzzle_pack.h"
+
+size_t encodePuzzlePackHeader(uint32_t count, uint8_t* out) {
+  memset(out, 0, PUZZLE_PACK_HEADER_SIZE);
+  memcpy(out, PUZZLE_PACK_MAGIC, 4);
+  writeLE16(out + 4, PUZZLE_PACK_VERSION);
+  writeLE32(out + 8, count);
+  return PUZZLE_PACK_HEADER_SIZE;
+}
+
+size_t encodePuzzleRecord(const uint8_t* position, uint16_t rating,
+                          const uint16_t* moves, int moveCount, uint8_t* out) {
+  if (moveCount <= 0 || moveCount > PUZZLE_MAX_MOVES) {
+    return 0;
+  }
+  memcpy(out, position, PUZZLE_POSITION_BYTES);
+  uint8_t* p = out + PUZZLE_POSITION_BYTES;
+  writeLE16(p, rating);
+  p[2] = (uint8_t)moveCount;
+  p += 3;
+  for (int i = 0; i < moveCount; i++) {
+    writeLE16(p, moves[i]);
+    p += 2;
+  }
+  return p - out;
+}
+
+bool PuzzlePack::open(BlockFile* blockFile) {
+  close();
+  uint8_t header[PUZZLE_PACK_HEADER_SIZE];
+  if (!blockFile->readAt(0, header, sizeof(header))) {
+    serialPrintln("[PUZZLE] Pack header unreadable");
+    return false;
+  }
+  if (memcmp(header, PUZZLE_PACK_MAGIC, 4) != 0 || readLE16(header + 4) != PUZZLE_PACK_VERSION) {
+    serialPrintln("[PUZZLE] Not a puzzle pack or unsupported version");
+    return false;
+  }
+  uint32_t packCount = readLE32(header + 8);
+  uint32_t indexEnd = PUZZLE_PACK_HEADER_SIZE + 4 * (packCount + 1);
+  if (packCount == 0 || packCount > (blockFile->size() - PUZZLE_PACK_HEADER_SIZE) / 4 ||
+      indexEnd > blockFile->size()) {
+    serialPrintln("[PUZZLE] Pack index truncated");
+    return false;
+  }
+  file = blockFile;
+  count = packCount;
+  serialPrintf("[PUZZLE] Pack opened: %u puzzles\n", (unsigned)count);
+  return true;
+}
+
+bool PuzzlePack::load(uint32_t index, Puzzle& out) {
+  if (file == nullptr || index >= count) {
+    return false;
+  }
+
+  // 相邻两个索引项同时给出记录的起点与长度
+  uint8_t entry[8];
+  if (!file->readAt(PUZZLE_PACK_HEADER_SIZE + 4 * index, entry, sizeof(entry))) {
+    return false;
+  }
+  uint32_t start = readLE32(entry);
+  uint32_t length = readLE32(entry + 4) - start;
+  if (length < (uint32_t)PUZZLE_POSITION_BYTES + 5 || length > (uint32_t)PUZZLE_RECORD_MAX_SIZE) {
+    return false;
+  }
+
+  uint8_t record[PUZZLE_RECORD_MAX_SIZE];
+  if (!file->readAt(start, record, length)) {
+    return false;
+  }
+  const uint8_t* p = record + PUZZLE_POSITION_BYTES;
+  int moveCount = p[2];
+  if (moveCount == 0 || moveCount > PUZZLE_MAX_MOVES ||
+      length != (uint32_t)PUZZLE_POSITION_BYTES + 3 + 2 * moveCount) {
+    return false;
+  }
+
+  memcpy(out.position, record, PUZZLE_POSITION_BYTES);
+  out.rating = readLE16(p);
+  out.moveCount = (uint8_t)moveCount;
+  p += 3;
+  for (int i = 0; i < moveCount; i++) {
+    out.moves[i] = readLE16(p + 2 * i);
+  }
+  return true;
+}
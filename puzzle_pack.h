@@ -0,0 +1,39 @@
+#pragma once
+#include "block_file.h"
+#include "puzzle.h"
+
+// 谜题包：SD卡上的二进制谜题集合，可容纳十万级谜题，按序号随机读取（所有整数均为小端）
+//   文件头（16字节）：魔数 "CCPK"，uint16 版本，uint16 保留，uint32 谜题数量，uint32 保留
+//   偏移索引：(数量+1) 个 uint32，第i个谜题的记录位于 [index[i], index[i+1])
+//   记录：打包局面（PUZZLE_POSITION_BYTES），uint16 等级分，uint8 步数，步数个 uint16 打包走法
+// 主机端由 tools/lichess_pack 从 Lichess 谜题CSV生成
+const uint8_t PUZZLE_PACK_MAGIC[4] = {'C', 'C', 'P', 'K'};
+const uint16_t PUZZLE_PACK_VERSION = 1;
+const int PUZZLE_PACK_HEADER_SIZE = 16;
+const int PUZZLE_RECORD_MAX_SIZE = PUZZLE_POSITION_BYTES + 3 + 2 * PUZZLE_MAX_MOVES;
+
+// 写入文件头，返回字节数
+size_t encodePuzzlePackHeader(uint32_t count, uint8_t* out);
+
+// 写入一条记录，out 至少 PUZZLE_RECORD_MAX_SIZE 字节，返回字节数；步数超出上限时返回0
+size_t encodePuzzleRecord(const uint8_t* position, uint16_t rating,
+                          const uint16_t* moves, int moveCount, uint8_t* out);
+
+class PuzzlePack {
+private:
+  BlockFile* file;
+  uint32_t count;
+
+public:
+  PuzzlePack() : file(nullptr), count(0) {}
+
+  // 校验文件头与索引长度，文件由调用者持有并保持打开
+  bool open(BlockFile* blockFile);
+  void close() { file = nullptr; count = 0; }
+  bool isOpen() const { return file != nullptr; }
+
+  uint32_t size() const { return count; }
+
+  // 读取第 index 个谜题：一次读索引项，一次读记录
+  bool load(uint32_t index, Puzzle& out);
+};
@@ -0,0 +1,157 @@
+#include "puzzle_progress.h"
+#include "common.h"
+
+bool PuzzleProgress::open(BlockFile* blockFile, uint32_t puzzleCount) {
+  close();
+  file = blockFile;
+  count = puzzleCount;
+
+  uint8_t header[PUZZLE_PROGRESS_HEADER_SIZE];
+  uint32_t expectedSize = attemptsOffset() + count;
+  if (file->size() >= expectedSize && file->readAt(0, header, sizeof(header)) &&
+      memcmp(header, PUZZLE_PROGRESS_MAGIC, 4) == 0 &&
+      readLE16(header + 4) == PUZZLE_PROGRESS_VERSION && readLE32(header + 8) == count) {
+    lastIndex = readLE32(header + 12);
+    if (lastIndex >= count) lastIndex = 0;
+    return true;
+  }
+
+  serialPrintf("[PUZZLE] Progress reset for %u puzzles\n", (unsigned)count);
+  if (!initialize()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+// 写入文件头并把位图与计数全部清零
+bool PuzzleProgress::initialize() {
+  uint8_t header[PUZZLE_PROGRESS_HEADER_SIZE];
+  memset(header, 0, sizeof(header));
+  memcpy(header, PUZZLE_PROGRESS_MAGIC, 4);
+  writeLE16(header + 4, PUZZLE_PROGRESS_VERSION);
+  writeLE32(header + 8, count);
+  lastIndex = 0;
+  if (!file->writeAt(0, header, sizeof(header))) {
+    return false;
+  }
+
+  uint8_t zeros[64];
+  memset(zeros, 0, sizeof(zeros));
+  uint32_t remaining = bitsetBytes() + count;
+  while (remaining > 0) {
+    size_t n = remaining < sizeof(zeros) ? remaining : sizeof(zeros);
+    if (file->write(zeros, n) != n) {
+      return false;
+    }
+    remaining -= n;
+  }
+  file->flush();
+  chunkLen = 0;
+  return true;
+}
+
+bool PuzzleProgress::readBitsetByte(uint32_t byteIndex, uint8_t& value) {
+  if (chunkLen == 0 || byteIndex < chunkStart || byteIndex >= chunkStart + chunkLen) {
+    uint32_t len = bitsetBytes() - byteIndex;
+    if (len > sizeof(chunk)) len = sizeof(chunk);
+    if (!file->readAt(PUZZLE_PROGRESS_HEADER_SIZE + byteIndex, chunk, len)) {
+      chunkLen = 0;
+      return false;
+    }
+    chunkStart = byteIndex;
+    chunkLen = (uint8_t)len;
+  }
+  value = chunk[byteIndex - chunkStart];
+  return true;
+}
+
+bool PuzzleProgress::isSolved(uint32_t index) {
+  uint8_t value;
+  return file != nullptr && index < count && readBitsetByte(index / 8, value) && (value & (1 << (index % 8)));
+}
+
+bool PuzzleProgress::markSolved(uint32_t index) {
+  uint8_t value;
+  if (file == nullptr || index >= count || !readBitsetByte(index / 8, value)) {
+    return false;
+  }
+  uint8_t bit = 1 << (index % 8);
+  if (value & bit) {
+    return true;
+  }
+  value |= bit;
+  if (!file->writeAt(PUZZLE_PROGRESS_HEADER_SIZE + index / 8, &value, 1)) {
+    chunkLen = 0;
+    return false;
+  }
+  file->flush();
+  chunk[index / 8 - chunkStart] = value;
+  return true;
+}
+
+uint8_t PuzzleProgress::getAttempts(uint32_t index) {
+  uint8_t value = 0;
+  if (file == nullptr || index >= count || !file->readAt(attemptsOffset() + index, &value, 1)) {
+    return 0;
+  }
+  return value;
+}
+
+bool PuzzleProgress::addAttempt(uint32_t index) {
+  if (file == nullptr || index >= count) {
+    return false;
+  }
+  uint8_t value = getAttempts(index);
+  if (value == 0xFF) {
+    return true;
+  }
+  value++;
+  bool ok = file->writeAt(attemptsOffset() + index, &value, 1);
+  file->flush();
+  return ok;
+}
+
+bool PuzzleProgress::setLastIndex(uint32_t index) {
+  if (file == nullptr || index >= count) {
+    return false;
+  }
+  if (index == lastIndex) {
+    return true;
+  }
+  uint8_t value[4];
+  writeLE32(value, index);
+  bool ok = file->writeAt(12, value, sizeof(value));
+  file->flush();
+  if (ok) lastIndex = index;
+  return ok;
+}
+
+bool PuzzleProgress::findUnsolved(uint32_t from, uint32_t& index) {
+  if (file == nullptr || count == 0) {
+    return false;
+  }
+  if (from >= count) {
+    from = 0;
+  }
+  // 第一轮从 from 扫到末尾，第二轮从开头扫到 from 之前；整字节已解决时一次跳过8个谜题
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t end = pass == 0 ? count : from;
+    uint32_t i = pass == 0 ? from : 0;
+    while (i < end) {
+      uint8_t value;
+      if (!readBitsetByte(i / 8, value)) {
+        return false;
+      }
+      uint8_t unsolved = (uint8_t)(~value & (0xFF << (i % 8)));
+      if (unsolved != 0) {
+        uint32_t candidate = (i & ~7u) + __builtin_ctz(unsolved);
+        if (candidate >= end) break;
+        index = candidate;
+        return true;
+      }
+      i = (i & ~7u) + 8;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "block_file.h"
+
+// 谜题进度文件：每个谜题来源一个，所有更新都在受影响的字节处原地写入，不重写整个文件（整数均为小端）
+//   文件头（16字节）：魔数 "CCPG"，uint16 版本，uint16 保留，uint32 谜题数量，uint32 上次的谜题序号
+//   已解决位图：(数量+7)/8 字节，第i个谜题对应第 i/8 字节的第 i%8 位
+//   失败次数：每个谜题1字节，到255为止
+const uint8_t PUZZLE_PROGRESS_MAGIC[4] = {'C', 'C', 'P', 'G'};
+const uint16_t PUZZLE_PROGRESS_VERSION = 1;
+const int PUZZLE_PROGRESS_HEADER_SIZE = 16;
+
+class PuzzleProgress {
+private:
+  BlockFile* file;
+  uint32_t count;
+  uint32_t lastIndex;
+
+  // 位图的读缓存，查找未解决谜题时按块扫描
+  uint8_t chunk[32];
+  uint32_t chunkStart; // 缓存对应的位图字节偏移
+  uint8_t chunkLen;    // 0 表示缓存无效
+
+  uint32_t bitsetBytes() const { return (count + 7) / 8; }
+  uint32_t attemptsOffset() const { return PUZZLE_PROGRESS_HEADER_SIZE + bitsetBytes(); }
+  bool readBitsetByte(uint32_t byteIndex, uint8_t& value);
+  bool initialize();
+
+public:
+  PuzzleProgress() : file(nullptr), count(0), lastIndex(0), chunkStart(0), chunkLen(0) {}
+
+  // 文件需以可写方式打开；为空、格式不对或谜题数量变化时重新初始化
+  bool open(BlockFile* blockFile, uint32_t puzzleCount);
+  void close() { file = nullptr; count = 0; chunkLen = 0; }
+  bool isOpen() const { return file != nullptr; }
+
+  bool isSolved(uint32_t index);
+  bool markSolved(uint32_t index);
+
+  uint8_t getAttempts(uint32_t index);
+  bool addAttempt(uint32_t index);
+
+  uint32_t getLastIndex() const { return lastIndex; }
+  bool setLastIndex(uint32_t index);
+
+  // 从 from 开始（到末尾后回到开头）找第一个未解决的谜题，全部解决时返回false
+  bool findUnsolved(uint32_t from, uint32_t& index);
+};
@@ -0,0 +1,185 @@
+#include "puzzle_text.h"
+
+bool PuzzleTextReader::open(BlockFile* blockFile) {
+  file = blockFile;
+  total = -1;
+  rewind();
+  return true;
+}
+
+void PuzzleTextReader::rewind() {
+  bufferPos = 0;
+  bufferLen = 0;
+  pushedBack = -1;
+  nextIndex = 0;
+  if (file != nullptr) {
+    file->seek(0);
+    // 跳过 UTF-8 BOM
+    uint8_t bom[3];
+    if (file->read(bom, 3) != 3 || bom[0] != 0xEF || bom[1] != 0xBB || bom[2] != 0xBF) {
+      file->seek(0);
+    }
+  }
+}
+
+int PuzzleTextReader::readChar() {
+  if (pushedBack >= 0) {
+    int c = pushedBack;
+    pushedBack = -1;
+    return c;
+  }
+  if (bufferPos >= bufferLen) {
+    bufferLen = (uint8_t)file->read(buffer, sizeof(buffer));
+    bufferPos = 0;
+    if (bufferLen == 0) {
+      return -1;
+    }
+  }
+  return buffer[bufferPos++];
+}
+
+// 读一行并去掉首尾空白，超长部分丢弃（在UTF-8字符边界截断）；文件结束且没有内容时返回false
+bool PuzzleTextReader::readLine(char* out, size_t size) {
+  size_t len = 0;
+  bool any = false;
+  int c;
+  while ((c = readChar()) >= 0) {
+    any = true;
+    if (c == '\n') break;
+    if (len + 1 < size) {
+      out[len++] = (char)c;
+    }
+  }
+  if (len + 1 >= size) {
+    while (len > 0 && ((uint8_t)out[len - 1] & 0xC0) == 0x80) len--;
+    if (len > 0 && ((uint8_t)out[len - 1] & 0x80)) len--;
+  }
+  while (len > 0 && isspace((uint8_t)out[len - 1])) len--;
+  out[len] = '\0';
+  size_t start = 0;
+  while (out[start] == ' ' || out[start] == '\t') start++;
+  if (start > 0) memmove(out, out + start, len - start + 1);
+  return any;
+}
+
+// 跳过任意长度的文字直到 marker 之后；marker 的首字符不在其余部分出现，逐字节匹配即可
+bool PuzzleTextReader::skipTo(const char* marker) {
+  size_t matched = 0;
+  int c;
+  while ((c = readChar()) >= 0) {
+    if (c == marker[matched]) {
+      if (marker[++matched] == '\0') return true;
+    } else {
+      matched = (c == marker[0]) ? 1 : 0;
+    }
+  }
+  return false;
+}
+
+// 读取下一个SAN走法，跳过回合号（“1.”、“2…”）；遇到 </MOVES> 或文件结束返回0
+int PuzzleTextReader::readMoveToken(char* out, size_t size) {
+  while (true) {
+    int c = readChar();
+    while (c >= 0 && isspace(c)) c = readChar();
+    if (c < 0) return 0;
+    if (c == '<') {
+      skipTo(">");
+      return 0;
+    }
+
+    size_t len = 0;
+    bool tooLong = false; // 超长的词不可能是走法
+    while (c >= 0 && !isspace(c) && c != '<') {
+      if (len + 1 < size) {
+        out[len++] = (char)c;
+      } else {
+        tooLong = true;
+      }
+      c = readChar();
+    }
+    if (c == '<') pushedBack = c;
+    out[len] = '\0';
+
+    // 去掉 !? 注释，跳过回合号与省略号
+    while (len > 0 && (out[len - 1] == '!' || out[len - 1] == '?')) out[--len] = '\0';
+    if (tooLong || len == 0 || isdigit((uint8_t)out[0]) || out[0] == '.' || ((uint8_t)out[0] & 0x80)) {
+      continue;
+    }
+    return (int)len;
+  }
+}
+
+bool PuzzleTextReader::readMoves(const char* fen, Puzzle& out) {
+  ChessBoard board;
+  Puzzle line;
+  bool legal = board.readFEN(fen);
+  if (legal) {
+    line.reset(board);
+  }
+
+  // 出现非法走法后继续读到 </MOVES>，保证下一个谜题从正确的位置开始
+  char token[16];
+  while (readMoveToken(token, sizeof(token)) > 0) {
+    Move move;
+    if (legal) {
+      legal = board.parseSAN(token, move) && board.makeMove(move) && line.addMove(move);
+    }
+  }
+  out = line;
+  return out.getMoveCount() > 0;
+}
+
+bool PuzzleTextReader::next(Puzzle& out, char* title) {
+  if (file == nullptr) {
+    return false;
+  }
+  char titleLine[PUZZLE_TITLE_SIZE];
+  char fen[FEN_BUFFER_SIZE];
+  while (true) {
+    do {
+      if (!readLine(titleLine, sizeof(titleLine))) return false;
+    } while (titleLine[0] == '\0');
+    do {
+      if (!readLine(fen, sizeof(fen))) return false;
+    } while (fen[0] == '\0');
+    if (!skipTo("<MOVES>")) {
+      return false;
+    }
+
+    if (readMoves(fen, out)) {
+      // 谜题必须以玩家的走法结束
+      int moves = out.getMoveCount();
+      out.truncateMoves(moves % 2 == 0 ? moves - 1 : moves);
+      if (title != nullptr) {
+        strcpy(title, titleLine);
+      }
+      nextIndex++;
+      return true;
+    }
+    serialPrintf("[PUZZLE] Skipped puzzle with illegal moves: %s\n", titleLine);
+  }
+}
+
+int PuzzleTextReader::count() {
+  if (total < 0 && file != nullptr) {
+    rewind();
+    Puzzle puzzle;
+    while (next(puzzle, nullptr)) {}
+    total = nextIndex;
+    rewind();
+  }
+  return total < 0 ? 0 : total;
+}
+
+bool PuzzleTextReader::load(int index, Puzzle& out, char* title) {
+  if (file == nullptr || index < 0) {
+    return false;
+  }
+  if (index < nextIndex) {
+    rewind();
+  }
+  while (nextIndex < index) {
+    if (!next(out, nullptr)) return false;
+  }
+  return next(out, title);
+}
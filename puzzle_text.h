@@ -0,0 +1,48 @@
+#pragma once
+#include "block_file.h"
+#include "puzzle.h"
+
+// 带注释的谜题文本（puzzle.txt 格式）流式读取器，每个谜题：
+//   标题行（如“1.经典转向（黑先）”）
+//   FEN行：标准顺序（第8横线在前）；按第1横线在前书写的旧文件先用 tools/puzzle_text_fix 改写
+//   任意长度的解说文字
+//   <MOVES>SAN正解（可含回合号与 !? 注释）</MOVES>
+// 只用固定大小的缓冲区逐字节读取，不会把整个文件读进内存；
+// 走法与局面不符的谜题被跳过，正解在第一步非法走法处截断并保证以玩家走法结束
+const int PUZZLE_TITLE_SIZE = 64;
+
+class PuzzleTextReader {
+private:
+  BlockFile* file;
+  uint8_t buffer[64];
+  uint8_t bufferPos;
+  uint8_t bufferLen;
+  int pushedBack;  // 退回的一个字符，-1 表示没有
+  int nextIndex;   // 下一次 next() 返回的谜题序号
+  int total;       // 有效谜题总数，-1 表示尚未统计
+
+  int readChar();
+  bool readLine(char* out, size_t size);
+  bool skipTo(const char* marker);
+  int readMoveToken(char* out, size_t size);
+  bool readMoves(const char* fen, Puzzle& out);
+
+public:
+  PuzzleTextReader() : file(nullptr), bufferPos(0), bufferLen(0), pushedBack(-1), nextIndex(0), total(-1) {}
+
+  bool open(BlockFile* blockFile);
+  void close() { file = nullptr; total = -1; }
+  bool isOpen() const { return file != nullptr; }
+
+  // 回到文件开头
+  void rewind();
+
+  // 顺序读取下一个有效谜题，title 可为 nullptr（至少 PUZZLE_TITLE_SIZE 字节）
+  bool next(Puzzle& out, char* title);
+
+  // 有效谜题总数，第一次调用时扫描整个文件
+  int count();
+
+  // 按序号读取：向后读取时从当前位置继续，向前时从头开始
+  bool load(int index, Puzzle& out, char* title);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "block_file.h"
+#include <FS.h>
+#include <SD.h>
+
+// SD卡上的块文件，打开后一直保持文件句柄，避免每次读写都重新打开
+class SdBlockFile : public BlockFile {
+private:
+  File file;
+
+public:
+  // writable 时以读写方式打开（不截断），文件不存在则创建
+  bool open(const char* path, bool writable = false) {
+    close();
+    if (writable) {
+      file = SD.open(path, SD.exists(path) ? "r+" : "w+");
+    } else {
+      file = SD.open(path, FILE_READ);
+    }
+    return (bool)file;
+  }
+
+  // 以读写方式新建文件，已存在时清空
+  bool create(const char* path) {
+    close();
+    file = SD.open(path, "w+");
+    return (bool)file;
+  }
+
+  void close() {
+    if (file) {
+      file.close();
+    }
+  }
+
+  bool isOpen() { return (bool)file; }
+
+  bool seek(uint32_t offset) { return file && file.seek(offset); }
+  size_t read(uint8_t* buffer, size_t size) { return file ? file.read(buffer, size) : 0; }
+  size_t write(const uint8_t* data, size_t size) { return file ? file.write(data, size) : 0; }
+  void flush() { if (file) file.flush(); }
+  uint32_t size() { return file ? (uint32_t)file.size() : 0; }
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+// 后台任务与 loop() 共用数据时的互斥锁（write_queue、ai_worker 共用）
+//   设备端（ESP32）是 FreeRTOS 互斥量；主机端单线程，不需要锁，全部为空操作
+//   锁句柄为 nullptr（创建失败或主机端）时 take/give 什么也不做
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static inline void* createLock() { return xSemaphoreCreateMutex(); }
+static inline void takeLock(void* lock) { if (lock != nullptr) xSemaphoreTake((SemaphoreHandle_t)lock, portMAX_DELAY); }
+static inline void giveLock(void* lock) { if (lock != nullptr) xSemaphoreGive((SemaphoreHandle_t)lock); }
+#else
+static inline void* createLock() { return nullptr; }
+static inline void takeLock(void*) {}
+static inline void giveLock(void*) {}
+#endif
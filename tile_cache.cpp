@@ -0,0 +1,46 @@
+#include "tile_cache.h"
+#include <string.h>
+
+void TileCache::build(const TileIcon icons[TILE_PIECES], int iconWidth, int iconHeight,
+                      const uint16_t backgrounds[TILE_BACKGROUND_COUNT], const CanvasPalette* palette) {
+  unsigned long start = micros();
+  int offsetX = (TILE_SIZE - iconWidth) / 2;
+  int offsetY = (TILE_SIZE - iconHeight) / 2;
+  for (int piece = 0; piece < TILE_PIECES; piece++) {
+    const TileIcon& icon = icons[piece];
+    for (int background = 0; background < TILE_BACKGROUND_COUNT; background++) {
+      TilePixel* tile = tiles[piece * TILE_BACKGROUND_COUNT + background];
+      uint16_t color = backgrounds[background];
+      TilePixel fill = palette != nullptr ? palette->indexOf(color) : color;
+      for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++) {
+        tile[i] = fill;
+      }
+      for (int y = 0; y < iconHeight; y++) {
+        for (int x = 0; x < iconWidth; x++) {
+          uint16_t pixel = icon.pixels[y * iconWidth + x];
+          if (pixel != icon.transparent) {
+            tile[(y + offsetY) * TILE_SIZE + x + offsetX] = palette != nullptr ? palette->indexOf(pixel) : pixel;
+          }
+        }
+      }
+    }
+  }
+  buildMicros = micros() - start;
+  built = true;
+  serialPrintf("[DRAW] Tile cache: %d tiles, %u bytes, built in %lu us\n",
+               TILE_PIECES * TILE_BACKGROUND_COUNT, (unsigned)sizeof(tiles), (unsigned long)buildMicros);
+}
+
+void blitTileClipped(TilePixel* buffer, int stride, const TilePixel* tile, int x, int y,
+                     int clipX, int clipY, int clipW, int clipH) {
+  int left = x > clipX ? x : clipX;
+  int top = y > clipY ? y : clipY;
+  int right = x + TILE_SIZE < clipX + clipW ? x + TILE_SIZE : clipX + clipW;
+  int bottom = y + TILE_SIZE < clipY + clipH ? y + TILE_SIZE : clipY + clipH;
+  if (left >= right || top >= bottom) {
+    return;
+  }
+  for (int row = top; row < bottom; row++) {
+    memcpy(buffer + row * stride + left, tile + (row - y) * TILE_SIZE + (left - x), (right - left) * sizeof(TilePixel));
+  }
+}
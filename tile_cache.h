@@ -0,0 +1,70 @@
+#pragma once
+#include "common.h"
+#include "palette.h"
+
+// 预合成的“棋子+格子底色”图块：启动时把每种棋子按每种底色合成一次，
+// 画有子的格子只需一次不透明的整块复制，不再每帧逐像素判断透明色
+//   12 种棋子 × TILE_BACKGROUND_COUNT 种底色，每块 TILE_SIZE×TILE_SIZE 个像素
+//   固定大小的静态数组，不占用堆内存
+//   8位调色板画布（CARDCHESS_PALETTE_CANVAS）时像素是调色板下标，否则是 RGB565
+const int TILE_SIZE = 16;  // 与棋盘格大小相同
+const int TILE_PIECES = 12;
+
+#if defined(CARDCHESS_PALETTE_CANVAS)
+typedef uint8_t TilePixel;
+#else
+typedef uint16_t TilePixel;
+#endif
+
+// 有子格子可能出现的底色
+enum TileBackground {
+  TILE_LIGHT,       // 浅色格
+  TILE_DARK,        // 深色格
+  TILE_SELECTED,    // AI上一步、升变选择框的高亮
+  TILE_VALID_MOVE,  // 谜题提示的高亮
+  TILE_BACKGROUND_COUNT
+};
+
+// 棋子在图标表和图块缓存中的序号：兵马象车后王，先白后黑
+inline int pieceIconIndex(const Piece& piece) {
+  return (piece.type - PAWN) + (piece.color == BLACK ? 6 : 0);
+}
+
+// 一种棋子的图标：透明色处露出底色
+struct TileIcon {
+  const uint16_t* pixels;
+  uint16_t transparent;
+};
+
+// 把图块复制到每行 stride 个像素的缓冲区 (x, y) 处，只写裁剪矩形内的部分；
+// 图块在任一方向上完全落在裁剪矩形外时什么也不写（脏矩形重画时大部分格子都是这样）
+void blitTileClipped(TilePixel* buffer, int stride, const TilePixel* tile, int x, int y,
+                     int clipX, int clipY, int clipW, int clipH);
+
+class TileCache {
+private:
+  TilePixel tiles[TILE_PIECES * TILE_BACKGROUND_COUNT][TILE_SIZE * TILE_SIZE];
+  uint32_t buildMicros;
+  bool built;
+
+public:
+  TileCache() : buildMicros(0), built(false) {}
+
+  // icons 按 兵马象车后王 的顺序先白后黑，图标小于图块时居中；
+  // 给出 palette 时按调色板下标保存（颜色都是 RGB565）
+  void build(const TileIcon icons[TILE_PIECES], int iconWidth, int iconHeight,
+             const uint16_t backgrounds[TILE_BACKGROUND_COUNT], const CanvasPalette* palette = nullptr);
+
+  bool isBuilt() const { return built; }
+
+  // 棋子在该底色上的图块，空格子返回 nullptr
+  const TilePixel* get(const Piece& piece, TileBackground background) const {
+    if (!built || piece.isEmpty()) {
+      return nullptr;
+    }
+    return tiles[pieceIconIndex(piece) * TILE_BACKGROUND_COUNT + background];
+  }
+
+  size_t getBytes() const { return sizeof(tiles); }
+  uint32_t getBuildMicros() const { return buildMicros; }
+};
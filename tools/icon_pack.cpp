@@ -0,0 +1,125 @@
+// 棋子图标压缩器：把 tools/icon_source.h 中的原始 RGB565 图标编码成 icon_data.h（格式见 icon_codec.h）
+// 用法：cardchess_icon_pack <输出头文件> [--check]
+//   --check  只检查输出文件是否与图标源一致（用于测试，防止忘记重新生成）
+// 每个图标编码后立即解码比对，保证与原图逐像素相同。
+#include "icon_codec.h"
+#include "icon_source.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct SourceIcon {
+  const char* name;     // 生成的数组名前缀
+  const uint16_t* pixels;
+  uint16_t transparent;
+};
+
+// 顺序同源文件
+static const SourceIcon ICONS[] = {
+  {"WHITE_KING", whiteKingData, 0x0000},
+  {"WHITE_QUEEN", whiteQueenData, 0x0000},
+  {"WHITE_ROOK", whiteRookData, 0x0000},
+  {"WHITE_BISHOP", whiteBishopData, 0x0000},
+  {"WHITE_KNIGHT", whiteKnightData, 0x0000},
+  {"WHITE_PAWN", whitePawnData, 0x0000},
+  {"BLACK_KING", blackKingData, 0xFFFF},
+  {"BLACK_QUEEN", blackQueenData, 0xFFFF},
+  {"BLACK_ROOK", blackRookData, 0xFFFF},
+  {"BLACK_BISHOP", blackBishopData, 0xFFFF},
+  {"BLACK_KNIGHT", blackKnightData, 0xFFFF},
+  {"BLACK_PAWN", blackPawnData, 0xFFFF},
+};
+static const int ICON_COUNT = sizeof(ICONS) / sizeof(ICONS[0]);
+static const int ICON_SIZE = 14;
+
+static bool generateHeader(std::string& header, size_t& rawBytes, size_t& packedBytes) {
+  std::ostringstream body;
+  char buf[64];
+  rawBytes = 0;
+  packedBytes = 0;
+  for (int i = 0; i < ICON_COUNT; i++) {
+    const SourceIcon& icon = ICONS[i];
+    std::vector<uint16_t> palette;
+    std::vector<uint8_t> data;
+    uint8_t bits;
+    encodeIcon(icon.pixels, ICON_SIZE, ICON_SIZE, icon.transparent, palette, bits, data);
+
+    // 解码回来必须与原图相同
+    IconBitmap bitmap = {ICON_SIZE, ICON_SIZE, bits, icon.transparent, palette.data(), data.data(), (uint16_t)data.size()};
+    uint16_t decoded[ICON_SIZE * ICON_SIZE];
+    if (!decodeIcon(bitmap, decoded) || memcmp(decoded, icon.pixels, sizeof(decoded)) != 0) {
+      fprintf(stderr, "%s: decoded icon does not match the source\n", icon.name);
+      return false;
+    }
+    rawBytes += ICON_SIZE * ICON_SIZE * sizeof(uint16_t);
+    packedBytes += palette.size() * sizeof(uint16_t) + data.size();
+
+    body << "// " << palette.size() << " colors, " << (int)bits << " bpp, " << data.size() << " bytes\n";
+    body << "static const uint16_t " << icon.name << "_PALETTE[" << palette.size() << "] PROGMEM = {";
+    for (size_t k = 0; k < palette.size(); k++) {
+      snprintf(buf, sizeof(buf), "%s0x%04X", k ? (k % 8 == 0 ? ",\n  " : ", ") : "", palette[k]);
+      body << buf;
+    }
+    body << "};\n";
+    body << "static const uint8_t " << icon.name << "_DATA[" << data.size() << "] PROGMEM = {\n  ";
+    for (size_t k = 0; k < data.size(); k++) {
+      snprintf(buf, sizeof(buf), "%s0x%02X", k ? (k % 12 == 0 ? ",\n  " : ", ") : "", data[k]);
+      body << buf;
+    }
+    body << "\n};\n";
+    snprintf(buf, sizeof(buf), "0x%04X", icon.transparent);
+    body << "static const IconBitmap " << icon.name << "_ICON = {" << ICON_SIZE << ", " << ICON_SIZE << ", "
+         << (int)bits << ", " << buf << ", " << icon.name << "_PALETTE, " << icon.name << "_DATA, "
+         << data.size() << "};\n\n";
+  }
+
+  std::ostringstream out;
+  out << "// 由 tools/icon_pack 根据 tools/icon_source.h 生成，不要手工修改\n";
+  out << "// 重新生成：构建 CMake 的 icon_data 目标\n";
+  out << "// " << ICON_COUNT << " 个图标：原始 RGB565 " << rawBytes << " 字节，压缩后 " << packedBytes << " 字节\n";
+  out << "#pragma once\n";
+  out << "#include \"icon_codec.h\"\n\n";
+  out << body.str();
+  header = out.str();
+  // 去掉最后一个多余的空行
+  header.erase(header.size() - 1);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <icon_data.h> [--check]\n", argv[0]);
+    return 2;
+  }
+  bool check = argc > 2 && strcmp(argv[2], "--check") == 0;
+
+  std::string header;
+  size_t rawBytes, packedBytes;
+  if (!generateHeader(header, rawBytes, packedBytes)) {
+    return 1;
+  }
+
+  if (check) {
+    std::ifstream in(argv[1], std::ios::binary);
+    std::stringstream existing;
+    existing << in.rdbuf();
+    if (existing.str() != header) {
+      fprintf(stderr, "%s is out of date, rebuild the icon_data target\n", argv[1]);
+      return 1;
+    }
+    return 0;
+  }
+
+  std::ofstream out(argv[1], std::ios::binary);
+  out << header;
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", argv[1]);
+    return 1;
+  }
+  printf("%d icons written to %s: %u bytes raw, %u bytes packed\n", ICON_COUNT, argv[1],
+         (unsigned)rawBytes, (unsigned)packedBytes);
+  return 0;
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <stdint.h>
+
+// 棋子图标的原始 RGB565 数据（只在主机上使用）：cardchess_icon_pack 把它压缩成 icon_data.h，
+// 修改图标后运行 cmake --build build --target icon_data 重新生成
+// 白棋的透明色是 0x0000，黑棋的是 0xFFFF
+
+//image2cpp在线工具
+//http://jlamch.net/MXChipWelcome/
+// 白王图标 (14x14 pixels)
+const unsigned short whiteKingData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xb5b6, 0xb5b6, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0xb5b6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000
+};
+
+// 白后图标 (14x14 pixels)
+const unsigned short whiteQueenData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 
+	0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x9AD6, 0xce59, 0x0000, 
+	0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x8410, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000
+};
+
+// 白车图标 (14x14 pixels)
+const unsigned short whiteRookData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0xf79e, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xbdd7, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000
+};
+
+// 白象图标 (14x14 pixels)
+const unsigned short whiteBishopData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x3186, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 
+	0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000
+};
+
+// 白马图标 (14x14 pixels)
+const unsigned short whiteKnightData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000
+};
+
+// 白兵图标 (14x14 pixels)
+const unsigned short whitePawnData[196] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0xb5b6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x4a49, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x0000, 0x0000, 0x0000, 0x0000, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 0x9AD6, 
+	0x9AD6, 0x9AD6, 0x0000, 0x0000
+};
+
+// 黑王图标 (14x14 pixels)
+const unsigned short blackKingData[196] = {
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xdedb, 0x0861, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0x4208, 0x6b6d, 0x0000, 0x6b6d, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0x4208, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x5acb, 0xffff, 0x5acb, 
+	0x0000, 0x0000, 0xffff, 0x5acb, 0x5acb, 0xffff, 0xffff, 0xffff, 0xffff, 0x94b2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0xef5d, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0x0000, 0x0000, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0xf79e, 0xffff, 0x0000, 0x0000, 
+	0x0000, 0xe71c, 0x2124, 0x0000, 0x0000, 0xe73c, 0xffff, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0xe71c, 
+	0xe73c, 0x0000, 0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 0x0000, 0x4228, 0xffff, 0xffff, 0x4a69, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x1082, 0xffff, 0xffff, 0xffff, 0xffff, 0x5acb, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x4a49, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x8c51, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x18c3, 0xffff, 0xffff
+};
+
+// 黑后图标 (14x14 pixels)
+const unsigned short blackQueenData[196] = {
+	0xffff, 0xffff, 0xffff, 0xffff, 0x1082, 0x0000, 0xffff, 0xffff, 0x0861, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x2104, 0x0000, 0x0000, 0x52aa, 0x0000, 0x0000, 0x0000, 0x528a, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xce59, 
+	0x0000, 0x0000, 0xffdf, 0x9492, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0x2945, 0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 
+	0xffdf, 0x52aa, 0x0000, 0x2104, 0xffff, 0x528a, 0x0000, 0x6b6d, 0x0000, 0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 0x2124, 0xd69a, 0x0000, 0x0000, 0xbdf7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x31a6, 0x0000, 0x0000, 0xffff, 0xffff, 0x5acb, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0x39c7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x738e, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2965, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x10a2, 0xffff, 0xffff, 0xffff, 
+	0xf79e, 0xf79e, 0xffff, 0xffff, 0xffff, 0x4228, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xffff, 0xffff
+};
+
+// 黑车图标 (14x14 pixels)
+const unsigned short blackRookData[196] = {
+	0xffff, 0xffff, 0xc618, 0x1082, 0xffff, 0x0000, 0x0000, 0x0000, 0xffff, 0x1082, 0x7bcf, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x0000, 0xd6ba, 0x0000, 0x0000, 0x0000, 0xffff, 0x0020, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x73ae, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xd69a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x8410, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xbdf7, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xb596, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x31a6, 0xffff, 0xffff, 0xffff, 0xffff, 0x5aeb, 0xffff, 0x18c3, 0x18c3, 0x18c3, 
+	0x0000, 0x1082, 0x18c3, 0x18c3, 0xffff, 0x0000, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0xef5d, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xef5d, 0xffff
+};
+
+// 黑象图标 (14x14 pixels)
+const unsigned short blackBishopData[196] = {
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x18e3, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xd6ba, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x6b4d, 0x632c, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xdedb, 0x8c71, 
+	0x0000, 0xffff, 0x0000, 0xad75, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xf7be, 0x0000, 0x0000, 0xffff, 
+	0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x2945, 0x0000, 0x0000, 0x0000, 0xffff, 0x0000, 0x0000, 
+	0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x8c51, 0x0000, 0x0000, 0x1082, 0x630c, 0x0000, 0x0000, 0x0000, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x39e7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xd69a, 0xffff, 0xffff, 0xffff, 
+	0xf7be, 0xffff, 0xffff, 0xffff, 0xffff, 0x52aa, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0xf7be, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xf7be, 0xffff
+};
+
+// 黑马图标 (14x14 pixels)
+const unsigned short blackKnightData[196] = {
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0x4228, 0x9cd3, 0x0000, 0x528a, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x52aa, 
+	0x9cf3, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xef7d, 0xd69a, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0xad75, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x39e7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x3186, 0xffff, 0xdefb, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0x52aa, 0x6b6d, 0xffff, 0x8430, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xd6ba, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4208, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x31a6, 0xffff, 0xffff, 0xffff, 0xffff, 0xef7d, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x4a49, 0xffff, 0xffff, 0xffff, 0x528a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x4208, 0xffff
+};
+
+// 黑兵图标 (14x14 pixels)
+const unsigned short blackPawnData[196] = {
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x10a2, 0x0000, 0x10a2, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0x4208, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0x4208, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x10a2, 0x0000, 0x0000, 
+	0x0000, 0x10a2, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xd6ba, 0x8410, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0xd6ba, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x10a2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x2965, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x8410, 0x0000, 0x0000, 0x0000, 0x8410, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 
+	0xffff, 0xffff, 0xffff, 0xbdf7, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x8410, 
+	0xbdf7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xad75, 0xffff, 0xffff, 0xffff, 0xffff, 0xd6ba, 0xffff, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xd6ba, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0x0000, 0x10a2, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 
+	0x0000, 0x0000, 0x0000, 0xffff
+};
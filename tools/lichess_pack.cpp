@@ -0,0 +1,231 @@
+// Lichess 谜题CSV转谜题包：把 lichess_db_puzzle.csv 转成可放到SD卡 /chess/puzzles.pak 的二进制谜题包
+// 用法：cardchess_lichess_pack <lichess_db_puzzle.csv> <puzzles.pak> [--index puzzles.idx] [--limit N]
+//   --index  同时生成按（主题, 等级分）排序的二级索引，格式见 puzzle_index.h
+// Lichess 的 FEN 是对手走出第一步之前的局面，Moves 为UCI走法且第一步由对手走出，
+// 因此转换时先在棋盘上走出第一步，再打包局面，其余走法作为正解（玩家先走）。
+#include "common.h"
+#include "puzzle.h"
+#include "puzzle_index.h"
+#include "puzzle_pack.h"
+#include "uci.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct CsvColumns {
+  int fen;
+  int moves;
+  int rating;
+  int themes;
+};
+
+struct IndexEntry {
+  uint32_t key;
+  uint32_t puzzle;
+  bool operator<(const IndexEntry& other) const {
+    return key != other.key ? key < other.key : puzzle < other.puzzle;
+  }
+};
+
+static uint16_t clampRating(int rating) {
+  return rating < 0 ? 0 : (rating > 0xFFFF ? 0xFFFF : (uint16_t)rating);
+}
+
+// 每个谜题在“全部”下一条，另外在每个已知主题下各一条
+static void addIndexEntries(const std::string& themes, uint16_t rating, uint32_t puzzle,
+                            std::vector<IndexEntry>& entries) {
+  IndexEntry entry = {puzzleIndexKey(PUZZLE_THEME_ALL, rating), puzzle};
+  entries.push_back(entry);
+  std::istringstream names(themes);
+  std::string name;
+  while (names >> name) {
+    int theme = puzzleThemeFromName(name.c_str());
+    if (theme > PUZZLE_THEME_ALL) {
+      entry.key = puzzleIndexKey(theme, rating);
+      entries.push_back(entry);
+    }
+  }
+}
+
+static bool writeIndex(const char* path, std::vector<IndexEntry>& entries) {
+  std::sort(entries.begin(), entries.end());
+  FILE* out = fopen(path, "wb");
+  if (out == nullptr) {
+    return false;
+  }
+  uint8_t buffer[PUZZLE_INDEX_HEADER_SIZE];
+  encodePuzzleIndexHeader(entries.size(), buffer);
+  bool ok = fwrite(buffer, 1, PUZZLE_INDEX_HEADER_SIZE, out) == PUZZLE_INDEX_HEADER_SIZE;
+  for (size_t i = 0; ok && i < entries.size(); i++) {
+    encodePuzzleIndexEntry(entries[i].key >> 16, entries[i].key & 0xFFFF, entries[i].puzzle, buffer);
+    ok = fwrite(buffer, 1, PUZZLE_INDEX_ENTRY_SIZE, out) == PUZZLE_INDEX_ENTRY_SIZE;
+  }
+  return fclose(out) == 0 && ok;
+}
+
+static void splitCsv(const std::string& line, std::vector<std::string>& fields) {
+  fields.clear();
+  size_t start = 0;
+  while (true) {
+    size_t comma = line.find(',', start);
+    if (comma == std::string::npos) {
+      fields.push_back(line.substr(start));
+      return;
+    }
+    fields.push_back(line.substr(start, comma - start));
+    start = comma + 1;
+  }
+}
+
+// 转换一行谜题，成功时把记录追加到 data
+static bool convertPuzzle(const std::string& fen, const std::string& uciMoves, uint16_t rating,
+                          std::vector<uint8_t>& data) {
+  ChessBoard board;
+  if (!board.readFEN(fen.c_str())) {
+    return false;
+  }
+
+  std::istringstream tokens(uciMoves);
+  std::string token;
+  uint8_t position[PUZZLE_POSITION_BYTES];
+  uint16_t moves[PUZZLE_MAX_MOVES];
+  int moveCount = -1; // -1 表示还没走出对手的第一步
+  while (tokens >> token) {
+    Move move;
+    if (!UciSession::parseMove(board, token.c_str(), move) || !board.makeMove(move)) {
+      return false;
+    }
+    if (moveCount < 0) {
+      packPosition(board, position);
+      moveCount = 0;
+      continue;
+    }
+    if (moveCount >= PUZZLE_MAX_MOVES) {
+      return false;
+    }
+    moves[moveCount++] = packMove(move);
+  }
+
+  uint8_t record[PUZZLE_RECORD_MAX_SIZE];
+  size_t length = encodePuzzleRecord(position, rating, moves, moveCount, record);
+  if (length == 0) {
+    return false;
+  }
+  data.insert(data.end(), record, record + length);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <lichess_db_puzzle.csv> <puzzles.pak> [--index puzzles.idx] [--limit N]\n", argv[0]);
+    return 2;
+  }
+  setSerialLogEnabled(false);
+  unsigned long limit = 0;
+  const char* indexPath = nullptr;
+  for (int i = 3; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--limit") == 0) {
+      limit = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--index") == 0) {
+      indexPath = argv[++i];
+    }
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  // 有表头时按列名定位，否则使用 Lichess 的默认列顺序
+  CsvColumns columns = {1, 2, 3, 7};
+  std::vector<std::string> fields;
+  std::vector<uint8_t> records;
+  std::vector<uint32_t> offsets;
+  std::vector<IndexEntry> indexEntries;
+  std::string line;
+  unsigned long skipped = 0;
+  bool firstLine = true;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+      line.erase(line.size() - 1);
+    }
+    splitCsv(line, fields);
+    if (firstLine) {
+      firstLine = false;
+      if (fields[0] == "PuzzleId") {
+        for (size_t i = 0; i < fields.size(); i++) {
+          if (fields[i] == "FEN") columns.fen = i;
+          if (fields[i] == "Moves") columns.moves = i;
+          if (fields[i] == "Rating") columns.rating = i;
+          if (fields[i] == "Themes") columns.themes = i;
+        }
+        continue;
+      }
+    }
+    if (line.empty()) continue;
+
+    size_t needed = (size_t)std::max(columns.fen, std::max(columns.moves, columns.rating)) + 1;
+    size_t before = records.size();
+    uint16_t rating = fields.size() < needed ? 0 : clampRating(atoi(fields[columns.rating].c_str()));
+    if (fields.size() < needed ||
+        !convertPuzzle(fields[columns.fen], fields[columns.moves], rating, records)) {
+      records.resize(before);
+      skipped++;
+      continue;
+    }
+    std::string themes = (size_t)columns.themes < fields.size() ? fields[columns.themes] : "";
+    addIndexEntries(themes, rating, offsets.size(), indexEntries);
+    offsets.push_back((uint32_t)before);
+    if (limit > 0 && offsets.size() >= limit) break;
+  }
+
+  if (offsets.empty()) {
+    fprintf(stderr, "no puzzles converted\n");
+    return 1;
+  }
+
+  // 文件头 + 偏移索引（记录偏移加上索引之前的长度）+ 记录
+  uint32_t count = offsets.size();
+  uint32_t dataStart = PUZZLE_PACK_HEADER_SIZE + 4 * (count + 1);
+  offsets.push_back((uint32_t)records.size());
+  std::vector<uint8_t> index(4 * offsets.size());
+  for (size_t i = 0; i < offsets.size(); i++) {
+    uint32_t offset = dataStart + offsets[i];
+    for (int b = 0; b < 4; b++) {
+      index[4 * i + b] = (uint8_t)(offset >> (8 * b));
+    }
+  }
+  uint8_t header[PUZZLE_PACK_HEADER_SIZE];
+  encodePuzzlePackHeader(count, header);
+
+  FILE* out = fopen(argv[2], "wb");
+  if (out == nullptr) {
+    fprintf(stderr, "cannot write %s\n", argv[2]);
+    return 1;
+  }
+  bool ok = fwrite(header, 1, sizeof(header), out) == sizeof(header) &&
+            fwrite(index.data(), 1, index.size(), out) == index.size() &&
+            fwrite(records.data(), 1, records.size(), out) == records.size();
+  ok = fclose(out) == 0 && ok;
+  if (!ok) {
+    fprintf(stderr, "write failed: %s\n", argv[2]);
+    return 1;
+  }
+  printf("%u puzzles written to %s (%lu skipped, %u bytes)\n",
+         (unsigned)count, argv[2], skipped, (unsigned)(dataStart + records.size()));
+
+  if (indexPath != nullptr) {
+    if (!writeIndex(indexPath, indexEntries)) {
+      fprintf(stderr, "write failed: %s\n", indexPath);
+      return 1;
+    }
+    printf("%u index entries written to %s\n", (unsigned)indexEntries.size(), indexPath);
+  }
+  return 0;
+}
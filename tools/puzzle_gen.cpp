@@ -0,0 +1,189 @@
+// 谜题数据生成器：把 puzzle_source.txt（FEN + SAN）编译成 puzzle_data.h 中的 PROGMEM 数组
+// 用法：cardchess_puzzle_gen <源文件> <输出头文件> [--check]
+//   --check  只检查输出文件是否与源文件一致（用于测试，防止忘记重新生成）
+// 每步走法都在棋盘上验证，FEN或走法有误时报告行号并失败，设备启动时不再做任何解析。
+#include "common.h"
+#include "puzzle.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct CompiledPuzzle {
+  std::string title;
+  std::string fen;
+  uint8_t position[PUZZLE_POSITION_BYTES];
+  std::vector<uint16_t> moves;
+};
+
+static std::string trim(const std::string& s) {
+  size_t b = s.find_first_not_of(" \t\r\n");
+  if (b == std::string::npos) return "";
+  size_t e = s.find_last_not_of(" \t\r\n");
+  return s.substr(b, e - b + 1);
+}
+
+// 编译一个谜题，失败时打印原因并返回false
+static bool compilePuzzle(const std::string& source, int line, const std::string& fen,
+                          const std::string& sanLine, CompiledPuzzle& out) {
+  ChessBoard board;
+  if (!board.readFEN(fen.c_str())) {
+    fprintf(stderr, "%s:%d: invalid FEN: %s\n", source.c_str(), line, fen.c_str());
+    return false;
+  }
+  out.fen = fen;
+  packPosition(board, out.position);
+
+  std::istringstream tokens(sanLine);
+  std::string token;
+  while (tokens >> token) {
+    if (token[token.size() - 1] == '.') continue; // 回合号
+    Move move;
+    if (!board.parseSAN(token.c_str(), move)) {
+      fprintf(stderr, "%s:%d: move %d '%s' is not legal in this position\n",
+              source.c_str(), line + 1, (int)out.moves.size() + 1, token.c_str());
+      return false;
+    }
+    out.moves.push_back(packMove(move));
+    board.makeMove(move);
+  }
+  if (out.moves.empty() || out.moves.size() > (size_t)PUZZLE_MAX_MOVES) {
+    fprintf(stderr, "%s:%d: a puzzle needs 1-%d moves\n", source.c_str(), line + 1, PUZZLE_MAX_MOVES);
+    return false;
+  }
+  return true;
+}
+
+static bool readSource(const std::string& path, std::vector<CompiledPuzzle>& puzzles) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", path.c_str());
+    return false;
+  }
+
+  std::string line;
+  std::string title;
+  std::string fen;
+  int fenLine = 0;
+  int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    line = trim(line);
+    if (line.empty()) {
+      if (!fen.empty()) {
+        fprintf(stderr, "%s:%d: FEN without a move line\n", path.c_str(), fenLine);
+        return false;
+      }
+      title.clear();
+      continue;
+    }
+    if (line[0] == '#') {
+      // 谜题的第一行注释作为标题
+      if (title.empty() && fen.empty()) title = trim(line.substr(1));
+      continue;
+    }
+    if (fen.empty()) {
+      fen = line;
+      fenLine = lineNumber;
+      continue;
+    }
+
+    CompiledPuzzle puzzle;
+    puzzle.title = title;
+    if (!compilePuzzle(path, fenLine, fen, line, puzzle)) {
+      return false;
+    }
+    puzzles.push_back(puzzle);
+    fen.clear();
+    title.clear();
+  }
+  if (!fen.empty()) {
+    fprintf(stderr, "%s:%d: FEN without a move line\n", path.c_str(), fenLine);
+    return false;
+  }
+  return true;
+}
+
+static std::string generateHeader(const std::vector<CompiledPuzzle>& puzzles) {
+  std::ostringstream out;
+  char buf[64];
+
+  out << "// 由 tools/puzzle_gen 根据 tools/puzzle_source.txt 生成，不要手工修改\n";
+  out << "// 重新生成：构建 CMake 的 puzzle_data 目标\n";
+  out << "#pragma once\n";
+  out << "#include <Arduino.h>\n\n";
+  out << "const int BUILTIN_PUZZLE_COUNT = " << puzzles.size() << ";\n\n";
+
+  out << "// 打包局面（格式见 puzzle.h）\n";
+  out << "static const uint8_t BUILTIN_PUZZLE_POSITIONS[" << puzzles.size() << "][" << PUZZLE_POSITION_BYTES << "] PROGMEM = {\n";
+  for (size_t i = 0; i < puzzles.size(); i++) {
+    out << "  // " << (puzzles[i].title.empty() ? "Puzzle" : puzzles[i].title) << "\n";
+    out << "  // " << puzzles[i].fen << "\n";
+    out << "  {";
+    for (int k = 0; k < PUZZLE_POSITION_BYTES; k++) {
+      snprintf(buf, sizeof(buf), "%s0x%02X", k ? (k % 12 == 0 ? ",\n   " : ", ") : "", puzzles[i].position[k]);
+      out << buf;
+    }
+    out << "},\n";
+  }
+  out << "};\n\n";
+
+  out << "// 所有谜题的正解走法（16位打包，格式见 puzzle.h）\n";
+  out << "static const uint16_t BUILTIN_PUZZLE_MOVES[] PROGMEM = {\n";
+  for (size_t i = 0; i < puzzles.size(); i++) {
+    out << "  ";
+    for (size_t k = 0; k < puzzles[i].moves.size(); k++) {
+      snprintf(buf, sizeof(buf), "0x%04X,%s", puzzles[i].moves[k], k + 1 < puzzles[i].moves.size() ? " " : "");
+      out << buf;
+    }
+    out << "\n";
+  }
+  out << "};\n\n";
+
+  out << "// 第i个谜题的走法为 BUILTIN_PUZZLE_MOVES[START[i], START[i+1])\n";
+  out << "static const uint16_t BUILTIN_PUZZLE_MOVE_START[" << puzzles.size() + 1 << "] PROGMEM = {";
+  size_t offset = 0;
+  for (size_t i = 0; i <= puzzles.size(); i++) {
+    out << (i ? ", " : "") << offset;
+    if (i < puzzles.size()) offset += puzzles[i].moves.size();
+  }
+  out << "};\n";
+  return out.str();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <puzzle_source.txt> <puzzle_data.h> [--check]\n", argv[0]);
+    return 2;
+  }
+  setSerialLogEnabled(false);
+  bool check = argc > 3 && strcmp(argv[3], "--check") == 0;
+
+  std::vector<CompiledPuzzle> puzzles;
+  if (!readSource(argv[1], puzzles)) {
+    return 1;
+  }
+  std::string header = generateHeader(puzzles);
+
+  if (check) {
+    std::ifstream in(argv[2], std::ios::binary);
+    std::stringstream existing;
+    existing << in.rdbuf();
+    if (existing.str() != header) {
+      fprintf(stderr, "%s is out of date, rebuild the puzzle_data target\n", argv[2]);
+      return 1;
+    }
+    return 0;
+  }
+
+  std::ofstream out(argv[2], std::ios::binary);
+  out << header;
+  if (!out) {
+    fprintf(stderr, "cannot write %s\n", argv[2]);
+    return 1;
+  }
+  printf("%d puzzles written to %s\n", (int)puzzles.size(), argv[2]);
+  return 0;
+}
@@ -0,0 +1,151 @@
+// 谜题文本整理：把 puzzle.txt 格式文件里按第1横线在前书写的FEN改写成标准顺序（第8横线在前）
+// 用法：cardchess_puzzle_text_fix <puzzle.txt> [--check]
+//   --check  只检查文件是否已是标准顺序（用于测试）
+// 每个谜题的正解分别在两种顺序下走一遍，能走通更多步的一种就是书写时的顺序；
+// 两种顺序走得一样远时无法判断，保留原样并给出警告，需要手工确认。
+// 设备端的 PuzzleTextReader 只按标准顺序解析。
+#include "common.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// 把FEN棋盘部分的横线顺序倒过来，其余字段原样保留
+static std::string flipFENRanks(const std::string& fen) {
+  size_t boardLen = fen.find(' ');
+  if (boardLen == std::string::npos) boardLen = fen.size();
+  std::string board = fen.substr(0, boardLen);
+  std::string flipped;
+  size_t end = board.size();
+  while (true) {
+    size_t slash = board.rfind('/', end == 0 ? 0 : end - 1);
+    size_t start = (slash == std::string::npos || slash >= end) ? 0 : slash + 1;
+    flipped += board.substr(start, end - start);
+    if (start == 0) break;
+    flipped += '/';
+    end = start - 1;
+  }
+  return flipped + fen.substr(boardLen);
+}
+
+// 在 fen 局面上依次走 moves 中的SAN（跳过回合号和 !? 注释），返回走通的步数，FEN非法返回-1
+static int replayMoves(const std::string& fen, const std::string& moves) {
+  ChessBoard board;
+  if (!board.readFEN(fen.c_str())) {
+    return -1;
+  }
+  std::istringstream tokens(moves);
+  std::string token;
+  int played = 0;
+  while (tokens >> token) {
+    while (!token.empty() && (token[token.size() - 1] == '!' || token[token.size() - 1] == '?')) {
+      token.erase(token.size() - 1);
+    }
+    if (token.empty() || isdigit((uint8_t)token[0]) || token[0] == '.' || ((uint8_t)token[0] & 0x80)) {
+      continue;
+    }
+    Move move;
+    if (!board.parseSAN(token.c_str(), move) || !board.makeMove(move)) {
+      break;
+    }
+    played++;
+  }
+  return played;
+}
+
+static std::string trim(const std::string& s) {
+  size_t b = s.find_first_not_of(" \t\r\n");
+  if (b == std::string::npos) return "";
+  size_t e = s.find_last_not_of(" \t\r\n");
+  return s.substr(b, e - b + 1);
+}
+
+// 从 pos 开始找下一个非空行，给出去掉首尾空白后的内容和在文本中的位置；没有时返回false
+static bool nextLine(const std::string& text, size_t& pos, std::string& line, size_t& start, size_t& length) {
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) end = text.size();
+    std::string raw = text.substr(pos, end - pos);
+    line = trim(raw);
+    size_t lineStart = pos;
+    pos = end < text.size() ? end + 1 : end;
+    if (!line.empty()) {
+      start = lineStart + raw.find(line);
+      length = line.size();
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <puzzle.txt> [--check]\n", argv[0]);
+    return 2;
+  }
+  setSerialLogEnabled(false);
+  bool check = argc > 2 && strcmp(argv[2], "--check") == 0;
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  std::stringstream content;
+  content << in.rdbuf();
+  std::string text = content.str();
+  in.close();
+
+  // 每个谜题：标题行、FEN行、解说，直到 </MOVES>
+  size_t pos = 0;
+  if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) pos = 3;
+  int puzzles = 0;
+  int flipped = 0;
+  std::string title, fen;
+  size_t start, length;
+  while (nextLine(text, pos, title, start, length) && nextLine(text, pos, fen, start, length)) {
+    size_t movesStart = text.find("<MOVES>", pos);
+    size_t movesEnd = movesStart == std::string::npos ? std::string::npos : text.find("</MOVES>", movesStart);
+    if (movesEnd == std::string::npos) {
+      break;
+    }
+    std::string moves = text.substr(movesStart + 7, movesEnd - movesStart - 7);
+    pos = text.find('\n', movesEnd);
+    pos = pos == std::string::npos ? text.size() : pos + 1;
+    puzzles++;
+
+    std::string other = flipFENRanks(fen);
+    int asWritten = replayMoves(fen, moves);
+    int asFlipped = replayMoves(other, moves);
+    if (asFlipped > asWritten) {
+      flipped++;
+      if (check) {
+        fprintf(stderr, "%s: \"%s\" has its FEN ranks in reverse order, run %s %s\n",
+                argv[1], title.c_str(), argv[0], argv[1]);
+        continue;
+      }
+      printf("%s: %s\n  %s\n", title.c_str(), fen.c_str(), other.c_str());
+      text.replace(start, length, other);
+      pos += other.size() - length;
+    } else if (asFlipped == asWritten && asWritten >= 0) {
+      fprintf(stderr, "warning: \"%s\": both rank orders play %d moves, kept as written\n",
+              title.c_str(), asWritten);
+    }
+  }
+
+  if (check) {
+    return flipped == 0 ? 0 : 1;
+  }
+  if (flipped > 0) {
+    std::ofstream out(argv[1], std::ios::binary);
+    out << text;
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", argv[1]);
+      return 1;
+    }
+  }
+  printf("%d puzzles, %d FEN lines rewritten in standard order\n", puzzles, flipped);
+  return 0;
+}
@@ -0,0 +1,226 @@
+#include "uci.h"
+#include "engine.h"
+#include <string.h>
+#include <stdlib.h>
+
+// 默认搜索深度，与游戏AI一致
+static const int UCI_DEFAULT_DEPTH = 3;
+static const int UCI_MAX_DEPTH = 6;
+
+// 读取下一个以空白分隔的词，返回词长度（0表示已到行尾）
+static int nextToken(const char*& p, char* out, int outSize) {
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  int len = 0;
+  while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+    if (len < outSize - 1) {
+      out[len++] = *p;
+    }
+    p++;
+  }
+  out[len] = '\0';
+  return len;
+}
+
+static void uciPrint(const char* line) {
+  Serial.println(line);
+}
+
+UciSession::UciSession() : searchDepth(UCI_DEFAULT_DEPTH) {
+}
+
+bool UciSession::handleLine(const char* line) {
+  const char* p = line;
+  char command[16];
+  if (nextToken(p, command, sizeof(command)) == 0) {
+    return true;
+  }
+
+  if (strcmp(command, "uci") == 0) {
+    uciPrint("id name CardChess");
+    uciPrint("id author nongxl");
+    uciPrint("option name Depth type spin default 3 min 1 max 6");
+    uciPrint("uciok");
+  } else if (strcmp(command, "isready") == 0) {
+    uciPrint("readyok");
+  } else if (strcmp(command, "ucinewgame") == 0) {
+    board.initBoard();
+  } else if (strcmp(command, "position") == 0) {
+    handlePosition(p);
+  } else if (strcmp(command, "go") == 0) {
+    handleGo(p);
+  } else if (strcmp(command, "setoption") == 0) {
+    handleSetOption(p);
+  } else if (strcmp(command, "d") == 0) {
+    // 调试：输出当前局面
+    char fen[FEN_BUFFER_SIZE];
+    board.writeFEN(fen, sizeof(fen));
+    uciPrint(fen);
+  } else if (strcmp(command, "quit") == 0) {
+    return false;
+  } else if (strcmp(command, "stop") == 0 || strcmp(command, "ponderhit") == 0) {
+    // 搜索是同步执行的，无需处理
+  } else {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "info string unknown command: %s", command);
+    uciPrint(buffer);
+  }
+  return true;
+}
+
+void UciSession::handlePosition(const char* args) {
+  const char* p = args;
+  char token[96];
+  nextToken(p, token, sizeof(token));
+
+  board.initBoard();
+  if (strcmp(token, "fen") == 0) {
+    // 最多6个字段，遇到 moves 结束
+    char fen[FEN_BUFFER_SIZE];
+    int fenLen = 0;
+    fen[0] = '\0';
+    while (nextToken(p, token, sizeof(token)) > 0 && strcmp(token, "moves") != 0) {
+      fenLen += snprintf(fen + fenLen, sizeof(fen) - fenLen, fenLen ? " %s" : "%s", token);
+      if (fenLen >= (int)sizeof(fen)) {
+        uciPrint("info string fen too long");
+        return;
+      }
+    }
+    if (!board.readFEN(fen)) {
+      uciPrint("info string invalid fen");
+      return;
+    }
+  } else if (strcmp(token, "startpos") == 0) {
+    if (nextToken(p, token, sizeof(token)) > 0 && strcmp(token, "moves") != 0) {
+      return;
+    }
+  } else {
+    return;
+  }
+
+  // 依次执行 moves 后的走法
+  while (nextToken(p, token, sizeof(token)) > 0) {
+    Move move;
+    if (!parseMove(board, token, move) || !board.makeMove(move)) {
+      char buffer[sizeof(token) + 32];
+      snprintf(buffer, sizeof(buffer), "info string illegal move: %s", token);
+      uciPrint(buffer);
+      return;
+    }
+  }
+}
+
+void UciSession::handleGo(const char* args) {
+  const char* p = args;
+  char token[16];
+  int depth = searchDepth;
+
+  while (nextToken(p, token, sizeof(token)) > 0) {
+    if (strcmp(token, "depth") == 0 && nextToken(p, token, sizeof(token)) > 0) {
+      depth = atoi(token);
+    } else if (strcmp(token, "perft") == 0 && nextToken(p, token, sizeof(token)) > 0) {
+      // 走法生成校验：输出指定深度的叶子节点数
+      unsigned long startTime = millis();
+      unsigned long nodes = perft(board, atoi(token));
+      char buffer[80];
+      snprintf(buffer, sizeof(buffer), "info string perft %s nodes %lu time %lu",
+               token, nodes, (unsigned long)(millis() - startTime));
+      uciPrint(buffer);
+      return;
+    }
+    // wtime/btime/movetime/infinite 等参数暂不支持，按固定深度搜索
+  }
+  if (depth < 1) depth = 1;
+  if (depth > UCI_MAX_DEPTH) depth = UCI_MAX_DEPTH;
+
+  SearchContext context;
+  SearchInfo info;
+  Move best = searchBestMove(board, board.getCurrentPlayer(), depth, context, &info);
+
+  char buffer[128];
+  unsigned long nps = info.timeMs ? info.nodes * 1000UL / info.timeMs : info.nodes * 1000UL;
+  snprintf(buffer, sizeof(buffer), "info depth %d score cp %d nodes %lu time %lu nps %lu",
+           depth, info.score, info.nodes, info.timeMs, nps);
+  uciPrint(buffer);
+
+  char moveText[6];
+  if (best.isValid()) {
+    formatMove(board, best, moveText);
+  } else {
+    strcpy(moveText, "0000");
+  }
+  snprintf(buffer, sizeof(buffer), "bestmove %s", moveText);
+  uciPrint(buffer);
+}
+
+void UciSession::handleSetOption(const char* args) {
+  // setoption name Depth value N
+  const char* p = args;
+  char token[16];
+  char name[16] = "";
+  while (nextToken(p, token, sizeof(token)) > 0) {
+    if (strcmp(token, "name") == 0) {
+      nextToken(p, name, sizeof(name));
+    } else if (strcmp(token, "value") == 0 && nextToken(p, token, sizeof(token)) > 0) {
+      if (strcmp(name, "Depth") == 0) {
+        int depth = atoi(token);
+        if (depth >= 1 && depth <= UCI_MAX_DEPTH) {
+          searchDepth = depth;
+        }
+      }
+    }
+  }
+}
+
+bool UciSession::parseMove(const ChessBoard& board, const char* text, Move& move) {
+  int len = strlen(text);
+  if (len < 4 || len > 5) {
+    return false;
+  }
+  Position from(text[0] - 'a', text[1] - '1');
+  Position to(text[2] - 'a', text[3] - '1');
+  if (!from.isValid() || !to.isValid()) {
+    return false;
+  }
+
+  PieceType promotion = NONE;
+  if (len == 5) {
+    switch (text[4]) {
+      case 'q': promotion = QUEEN; break;
+      case 'r': promotion = ROOK; break;
+      case 'b': promotion = BISHOP; break;
+      case 'n': promotion = KNIGHT; break;
+      default: return false;
+    }
+  }
+
+  const Piece& piece = board.getPiece(from);
+  if (piece.isEmpty() || piece.color != board.getCurrentPlayer() || !board.validateMove(from, to)) {
+    return false;
+  }
+  move = Move(from, to, promotion);
+  return true;
+}
+
+void UciSession::formatMove(const ChessBoard& board, const Move& move, char* out) {
+  out[0] = 'a' + move.from.x;
+  out[1] = '1' + move.from.y;
+  out[2] = 'a' + move.to.x;
+  out[3] = '1' + move.to.y;
+  out[4] = '\0';
+
+  // 兵到底线时补上升变棋子（引擎搜索默认升后）
+  const Piece& piece = board.getPiece(move.from);
+  if (piece.type == PAWN && (move.to.y == 0 || move.to.y == 7)) {
+    char c = 'q';
+    switch (move.promotion) {
+      case ROOK: c = 'r'; break;
+      case BISHOP: c = 'b'; break;
+      case KNIGHT: c = 'n'; break;
+      default: break;
+    }
+    out[4] = c;
+    out[5] = '\0';
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "common.h"
+
+// UCI协议会话：逐行接收命令，应答通过Serial输出
+// 设备端在串口收到"uci"后进入此模式，主机端由 cardchess_uci 可执行文件驱动
+class UciSession {
+private:
+  ChessBoard board;
+  int searchDepth; // go 未指定 depth 时使用的搜索深度
+
+  void handlePosition(const char* args);
+  void handleGo(const char* args);
+  void handleSetOption(const char* args);
+
+public:
+  UciSession();
+
+  // 处理一行命令，收到 quit 时返回 false
+  bool handleLine(const char* line);
+
+  // 解析长代数记法（如 e2e4、e7e8q），只接受当前局面的合法走法
+  static bool parseMove(const ChessBoard& board, const char* text, Move& move);
+
+  // 生成长代数记法，out 至少6字节
+  static void formatMove(const ChessBoard& board, const Move& move, char* out);
+};
@@ -0,0 +1,181 @@
+#include "write_queue.h"
+#include "common.h"
+#include "task_lock.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/task.h>
+#endif
+
+QueuedBlockFile::QueuedBlockFile()
+    : target(nullptr), active(0), position(0), failed(false),
+      bufferLock(nullptr), ioLock(nullptr), writerTask(nullptr) {
+  for (int i = 0; i < 2; i++) {
+    batches[i].used = 0;
+    batches[i].spanCount = 0;
+  }
+}
+
+bool QueuedBlockFile::begin() {
+#if defined(ARDUINO_ARCH_ESP32)
+  if (writerTask != nullptr) {
+    return true;
+  }
+  bufferLock = createLock();
+  ioLock = createLock();
+  TaskHandle_t handle = nullptr;
+  // 放在 core 0，loop() 所在的 core 1 只负责界面和AI
+  if (bufferLock == nullptr || ioLock == nullptr ||
+      xTaskCreatePinnedToCore(writerLoop, "sdWriter", 4096, this, 1, &handle, 0) != pdPASS) {
+    serialPrintln("[SD] Failed to start writer task, saves are synchronous");
+    return false;
+  }
+  writerTask = handle;
+#endif
+  return true;
+}
+
+void QueuedBlockFile::writerLoop(void* arg) {
+#if defined(ARDUINO_ARCH_ESP32)
+  QueuedBlockFile* queue = (QueuedBlockFile*)arg;
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    vTaskDelay(pdMS_TO_TICKS(WRITE_QUEUE_BATCH_MS));
+    queue->drain();
+  }
+#else
+  (void)arg;
+#endif
+}
+
+void QueuedBlockFile::drain() {
+  takeLock(ioLock);
+  while (true) {
+    takeLock(bufferLock);
+    Batch& batch = batches[active];
+    active ^= 1;
+    giveLock(bufferLock);
+    if (batch.used == 0) {
+      break;
+    }
+
+    // 锁外写出，前台可以继续往另一块缓冲区追加
+    bool ok = target != nullptr;
+    for (int i = 0; ok && i < batch.spanCount; i++) {
+      const Span& span = batch.spans[i];
+      ok = target->writeAt(span.offset, batch.data + span.start, span.size);
+    }
+    if (ok) {
+      target->flush();
+    } else {
+      failed = true;
+    }
+
+    takeLock(bufferLock);
+    batch.used = 0;
+    batch.spanCount = 0;
+    giveLock(bufferLock);
+  }
+  giveLock(ioLock);
+}
+
+bool QueuedBlockFile::sync() {
+  drain();
+  bool ok = !failed;
+  failed = false;
+  if (!ok) {
+    serialPrintln("[SD] Queued write failed");
+  }
+  return ok;
+}
+
+bool QueuedBlockFile::hasPending() {
+  takeLock(bufferLock);
+  bool pending = batches[0].used != 0 || batches[1].used != 0;
+  giveLock(bufferLock);
+  return pending;
+}
+
+bool QueuedBlockFile::attach(BlockFile* blockFile) {
+  bool ok = sync();
+  takeLock(ioLock);
+  target = blockFile;
+  position = 0;
+  giveLock(ioLock);
+  return ok;
+}
+
+size_t QueuedBlockFile::write(const uint8_t* data, size_t size) {
+  if (target == nullptr) {
+    return 0;
+  }
+  if (size > (size_t)WRITE_QUEUE_BYTES) {
+    // 超过缓冲区的大块数据直接写
+    sync();
+    takeLock(ioLock);
+    size_t written = target->seek(position) ? target->write(data, size) : 0;
+    giveLock(ioLock);
+    position += written;
+    return written;
+  }
+
+  takeLock(bufferLock);
+  Batch* batch = &batches[active];
+  Span* last = batch->spanCount > 0 ? &batch->spans[batch->spanCount - 1] : nullptr;
+  bool contiguous = last != nullptr && last->offset + last->size == position && last->start + last->size == batch->used;
+  if (batch->used + size > (size_t)WRITE_QUEUE_BYTES || (!contiguous && batch->spanCount == WRITE_QUEUE_SPANS)) {
+    // 缓冲区满：退回同步写出，之后两块缓冲区都是空的
+    giveLock(bufferLock);
+    sync();
+    takeLock(bufferLock);
+    batch = &batches[active];
+    last = nullptr;
+    contiguous = false;
+  }
+  memcpy(batch->data + batch->used, data, size);
+  if (contiguous) {
+    last->size += size;
+  } else {
+    Span& span = batch->spans[batch->spanCount++];
+    span.offset = position;
+    span.start = batch->used;
+    span.size = (uint16_t)size;
+  }
+  batch->used += size;
+  giveLock(bufferLock);
+  position += size;
+  return size;
+}
+
+void QueuedBlockFile::flush() {
+#if defined(ARDUINO_ARCH_ESP32)
+  if (writerTask != nullptr) {
+    xTaskNotifyGive((TaskHandle_t)writerTask);
+    return;
+  }
+#endif
+  // 没有后台任务时同步写出
+  sync();
+}
+
+size_t QueuedBlockFile::read(uint8_t* buffer, size_t size) {
+  if (target == nullptr) {
+    return 0;
+  }
+  sync();
+  takeLock(ioLock);
+  size_t n = target->seek(position) ? target->read(buffer, size) : 0;
+  giveLock(ioLock);
+  position += n;
+  return n;
+}
+
+uint32_t QueuedBlockFile::size() {
+  if (target == nullptr) {
+    return 0;
+  }
+  sync();
+  takeLock(ioLock);
+  uint32_t result = target->size();
+  giveLock(ioLock);
+  return result;
+}
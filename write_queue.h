@@ -0,0 +1,63 @@
+#pragma once
+#include "block_file.h"
+
+// 异步写入队列：包装一个块文件，write() 只把数据复制进内存缓冲区就返回，
+// 由后台写入任务把攒下的写入批量写到目标文件并落盘，UI 不再等待 SD 卡延迟
+//   双缓冲：前台往活动缓冲区追加，写入任务交换缓冲区后在锁外写出另一块；
+//   偏移首尾相接的写入合并成一段，对局日志每批通常只有一次写入
+//   缓冲区满时前台退回同步写出；read()/size() 之前也先同步写出，保证读到的是最新数据
+// 设备端（ESP32）由 FreeRTOS 任务写出，flush() 只唤醒任务；主机端没有后台任务，
+// 数据在 sync() 或缓冲区满时写出
+const int WRITE_QUEUE_BYTES = 256;   // 每块缓冲区的字节数
+const int WRITE_QUEUE_SPANS = 8;     // 每块缓冲区最多的不连续写入段数
+const int WRITE_QUEUE_BATCH_MS = 20; // 写入任务被唤醒后再等一会，把紧接着的写入（如AI的回应）攒成一批
+
+class QueuedBlockFile : public BlockFile {
+private:
+  struct Span {
+    uint32_t offset;  // 在目标文件中的偏移
+    uint16_t start;   // 在缓冲区中的起点
+    uint16_t size;
+  };
+  struct Batch {
+    uint8_t data[WRITE_QUEUE_BYTES];
+    Span spans[WRITE_QUEUE_SPANS];
+    uint16_t used;
+    uint8_t spanCount;
+  };
+
+  BlockFile* target;
+  Batch batches[2];
+  uint8_t active;       // 前台正在追加的缓冲区
+  uint32_t position;    // 前台的当前位置
+  bool failed;          // 后台写入失败过，下一次 sync() 返回false
+  void* bufferLock;     // 保护 batches/active（设备端为 FreeRTOS 互斥量）
+  void* ioLock;         // 同一时间只有一方写目标文件
+  void* writerTask;
+
+  // 交换缓冲区并写出，直到没有待写数据（调用者不持有任何锁）
+  void drain();
+  static void writerLoop(void* arg);
+
+public:
+  QueuedBlockFile();
+
+  // 设备端创建后台写入任务，只需调用一次
+  bool begin();
+
+  // 切换目标文件，先把旧目标的待写数据全部写出；传 nullptr 表示断开
+  bool attach(BlockFile* blockFile);
+  bool isAttached() const { return target != nullptr; }
+
+  // 把所有待写数据同步写出并落盘（退出对局前的收尾），有写入失败时返回false
+  bool sync();
+
+  // 还有尚未写出的数据
+  bool hasPending();
+
+  bool seek(uint32_t offset) { position = offset; return target != nullptr; }
+  size_t read(uint8_t* buffer, size_t size);
+  size_t write(const uint8_t* data, size_t size);
+  void flush();
+  uint32_t size();
+};